@@ -0,0 +1,50 @@
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * Minimal helpers for the host benchmarks
+ *
+ * Each benchmark runs a body `BENCH_ITERATIONS` times and reports the time per iteration,
+ * `bench_sink` keeps the compiler from dropping the measured work.
+*/
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    (10000000u)
+#endif
+
+static volatile uint32_t bench_sink;
+
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Print the result of a benchmark, `units` is the number of items processed in `ns`
+*/
+static inline void bench_report(const char* name, uint64_t ns, uint64_t units)
+{
+    printf("%-40s %10.2f ns/op %12.1f Mop/s\n", name, (double)ns / (double)units,
+        (double)units * 1000.0 / (double)ns);
+}
+
+/**
+ * Time `iterations` runs of the statement `body` and report them under `name`
+*/
+#define BENCH_RUN(name, iterations, body)                                       \
+    do {                                                                        \
+        uint64_t bench_start_ = bench_now_ns();                                 \
+        for (uint32_t bench_i_ = 0; bench_i_ < (iterations); bench_i_++) {     \
+            body;                                                               \
+        }                                                                       \
+        bench_report((name), bench_now_ns() - bench_start_, (iterations));      \
+    } while (0)
+
+#endif
@@ -0,0 +1,217 @@
+#include <string.h>
+#include "drivers/adc_proc.h"
+#include "bench.h"
+
+/**
+ * ADC processing kernels (adc_proc.c) against plain scalar loops
+ *
+ * Each kernel processes a block of `BLOCK_LEN` samples, the result is checked against the
+ * scalar loop before timing. The scalar loops are built without auto-vectorisation so they
+ * show what the SIMD paths and the restrict loops gain.
+*/
+
+#define BLOCK_LEN       (1024)
+#define BLOCKS          (20000u)
+#define FIR_TAPS        (32)
+#define FIR_DECIMATION  (4)
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define BENCH_SCALAR    __attribute__((noinline, optimize("no-tree-vectorize")))
+#else
+#define BENCH_SCALAR    __attribute__((noinline))
+#endif
+
+/**
+ * Time `BLOCKS` runs of `body` over a block, reported per sample
+*/
+#define BENCH_BLOCK(name, body)                                                 \
+    do {                                                                        \
+        uint64_t bench_start_ = bench_now_ns();                                 \
+        for (uint32_t bench_i_ = 0; bench_i_ < BLOCKS; bench_i_++) {            \
+            body;                                                               \
+        }                                                                       \
+        bench_report((name), bench_now_ns() - bench_start_, (uint64_t)BLOCKS * BLOCK_LEN); \
+    } while (0)
+
+static uint16_t samples[BLOCK_LEN];
+static int16_t signed_samples[BLOCK_LEN];
+static int16_t coefficients[BLOCK_LEN];
+static uint16_t channel_a[BLOCK_LEN / 2];
+static uint16_t channel_b[BLOCK_LEN / 2];
+static uint16_t scalar_a[BLOCK_LEN / 2];
+static uint16_t scalar_b[BLOCK_LEN / 2];
+
+BENCH_SCALAR static void scalar_deinterleave(const uint16_t* in, size_t frames, uint16_t* a, uint16_t* b)
+{
+    for (size_t f = 0; f < frames; f++) {
+        a[f] = in[2 * f];
+        b[f] = in[2 * f + 1];
+    }
+}
+
+BENCH_SCALAR static void scalar_stats(const uint16_t* in, size_t n, adc_proc_stats_t* stats)
+{
+    uint16_t min = UINT16_MAX;
+    uint16_t max = 0;
+    uint64_t sum = 0;
+    uint64_t sum_sq = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        min = in[i] < min ? in[i] : min;
+        max = in[i] > max ? in[i] : max;
+        sum += in[i];
+        sum_sq += (uint32_t)in[i] * in[i];
+    }
+
+    stats->min = min;
+    stats->max = max;
+    stats->mean = (uint16_t)((sum + n / 2) / n);
+    /* Square root is shared code and once per block, the sum is only kept alive */
+    stats->rms = (uint16_t)sum_sq;
+}
+
+BENCH_SCALAR static int32_t scalar_dot_q15(const int16_t* a, const int16_t* b, size_t n)
+{
+    int32_t acc = 0;
+
+    for (size_t i = 0; i < n; i++)
+        acc += (int32_t)a[i] * b[i];
+
+    return acc;
+}
+
+BENCH_SCALAR static void scalar_oversample(const uint16_t* in, size_t n, uint16_t factor, uint8_t shift, uint16_t* out)
+{
+    for (size_t o = 0; o < n / factor; o++) {
+        uint32_t sum = 0;
+
+        for (uint16_t k = 0; k < factor; k++)
+            sum += in[o * factor + k];
+        out[o] = (uint16_t)(sum >> shift);
+    }
+}
+
+/**
+ * FIR with a circular delay line, indexing wraps for every tap
+*/
+BENCH_SCALAR static size_t scalar_fir(const int16_t* taps, int16_t* delay, uint16_t* pos,
+    const int16_t* in, size_t n, int16_t* out)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        *pos = (uint16_t)((*pos + 1) % FIR_TAPS);
+        delay[*pos] = in[i];
+
+        if ((i + 1) % FIR_DECIMATION != 0)
+            continue;
+
+        int32_t acc = 0;
+        for (uint16_t k = 0; k < FIR_TAPS; k++)
+            acc += (int32_t)taps[k] * delay[(*pos + FIR_TAPS - k) % FIR_TAPS];
+        acc = (acc + (1 << 14)) >> 15;
+        out[count++] = acc > INT16_MAX ? INT16_MAX : acc < INT16_MIN ? INT16_MIN : (int16_t)acc;
+    }
+
+    return count;
+}
+
+int main(void)
+{
+    uint32_t seed = 1;
+
+    for (size_t i = 0; i < BLOCK_LEN; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        samples[i] = (uint16_t)(seed >> 20);
+        coefficients[i] = (int16_t)(seed >> 16);
+    }
+    adc_proc_to_signed(samples, BLOCK_LEN, 0x800, signed_samples);
+
+    /* Kernels must match the scalar loops before they are compared */
+    uint16_t* channels[2] = { channel_a, channel_b };
+    adc_proc_deinterleave(samples, BLOCK_LEN / 2, 2, channels);
+    scalar_deinterleave(samples, BLOCK_LEN / 2, scalar_a, scalar_b);
+    if (memcmp(channel_a, scalar_a, sizeof(scalar_a)) != 0 || memcmp(channel_b, scalar_b, sizeof(scalar_b)) != 0)
+        return 1;
+
+    adc_proc_stats_t stats, expected;
+    adc_proc_get_stats(samples, BLOCK_LEN, &stats);
+    scalar_stats(samples, BLOCK_LEN, &expected);
+    if (stats.min != expected.min || stats.max != expected.max || stats.mean != expected.mean)
+        return 1;
+
+    if (adc_proc_dot_q15(signed_samples, coefficients, BLOCK_LEN)
+        != scalar_dot_q15(signed_samples, coefficients, BLOCK_LEN))
+        return 1;
+
+    adc_proc_oversample(samples, BLOCK_LEN, 4, 2, channel_a);
+    scalar_oversample(samples, BLOCK_LEN, 4, 2, scalar_a);
+    if (memcmp(channel_a, scalar_a, BLOCK_LEN / 4 * sizeof(uint16_t)) != 0)
+        return 1;
+
+    static int16_t fir_state[2 * FIR_TAPS];
+    static int16_t scalar_delay[FIR_TAPS];
+    static int16_t fir_out[BLOCK_LEN / FIR_DECIMATION];
+    static int16_t scalar_out[BLOCK_LEN / FIR_DECIMATION];
+    adc_proc_fir_t fir;
+    uint16_t scalar_pos = 0;
+    adc_proc_fir_init(&fir, coefficients, FIR_TAPS, FIR_DECIMATION, fir_state);
+    adc_proc_fir_run(&fir, signed_samples, BLOCK_LEN, fir_out);
+    scalar_fir(coefficients, scalar_delay, &scalar_pos, signed_samples, BLOCK_LEN, scalar_out);
+    if (memcmp(fir_out, scalar_out, sizeof(fir_out)) != 0)
+        return 1;
+
+    BENCH_BLOCK("deinterleave 2 ch (adc_proc)", {
+        adc_proc_deinterleave(samples, BLOCK_LEN / 2, 2, channels);
+        bench_sink += channel_b[bench_i_ % (BLOCK_LEN / 2)];
+    });
+    BENCH_BLOCK("deinterleave 2 ch (scalar)", {
+        scalar_deinterleave(samples, BLOCK_LEN / 2, scalar_a, scalar_b);
+        bench_sink += scalar_b[bench_i_ % (BLOCK_LEN / 2)];
+    });
+
+    BENCH_BLOCK("stats (adc_proc)", {
+        adc_proc_get_stats(samples, BLOCK_LEN, &stats);
+        bench_sink += stats.rms;
+    });
+    BENCH_BLOCK("stats (scalar)", {
+        scalar_stats(samples, BLOCK_LEN, &expected);
+        bench_sink += expected.rms;
+    });
+
+    BENCH_BLOCK("dot q15 (adc_proc)", {
+        bench_sink += (uint32_t)adc_proc_dot_q15(signed_samples, coefficients, BLOCK_LEN);
+    });
+    BENCH_BLOCK("dot q15 (scalar)", {
+        bench_sink += (uint32_t)scalar_dot_q15(signed_samples, coefficients, BLOCK_LEN);
+    });
+
+    BENCH_BLOCK("oversample x4 (adc_proc)", {
+        adc_proc_oversample(samples, BLOCK_LEN, 4, 2, channel_a);
+        bench_sink += channel_a[bench_i_ % (BLOCK_LEN / 4)];
+    });
+    BENCH_BLOCK("oversample x4 (scalar)", {
+        scalar_oversample(samples, BLOCK_LEN, 4, 2, scalar_a);
+        bench_sink += scalar_a[bench_i_ % (BLOCK_LEN / 4)];
+    });
+
+    BENCH_BLOCK("oversample x64 (adc_proc)", {
+        adc_proc_oversample(samples, BLOCK_LEN, 64, 6, channel_a);
+        bench_sink += channel_a[bench_i_ % (BLOCK_LEN / 64)];
+    });
+    BENCH_BLOCK("oversample x64 (scalar)", {
+        scalar_oversample(samples, BLOCK_LEN, 64, 6, scalar_a);
+        bench_sink += scalar_a[bench_i_ % (BLOCK_LEN / 64)];
+    });
+
+    BENCH_BLOCK("fir 32 taps /4 (adc_proc)", {
+        adc_proc_fir_run(&fir, signed_samples, BLOCK_LEN, fir_out);
+        bench_sink += (uint16_t)fir_out[0];
+    });
+    BENCH_BLOCK("fir 32 taps /4 (scalar)", {
+        scalar_fir(coefficients, scalar_delay, &scalar_pos, signed_samples, BLOCK_LEN, scalar_out);
+        bench_sink += (uint16_t)scalar_out[0];
+    });
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "drivers/sdev.h"
+#include "drivers/i2c.h"
+#include "bench.h"
+#include "bench_bind_board.h"
+
+/**
+ * Call overhead of the ops tables against static binding (`DRIVERS_BINDING_HEADER`)
+ *
+ * Built twice: `bench_bind` goes through the sdev and i2c ops tables, every source of
+ * `bench_bind_static` is built with the binding header. Both read 2 bytes from the same
+ * in-memory bus through `sdev_read` with the retry and health bookkeeping of
+ * `i2c_sdev_transfer`, so only the indirect calls differ.
+*/
+
+#ifdef BENCH_BIND_STATIC
+#define BENCH_NAME  "sdev_read (static binding)"
+#else
+#define BENCH_NAME  "sdev_read (ops tables)"
+#endif
+
+int main(void)
+{
+    static i2c_ops_t ops = {
+        .write = &bench_bus_write,
+        .read = &bench_bus_read,
+        .dev_probe = &bench_bus_dev_probe
+    };
+    static volatile uint8_t reg = 0x5a;
+    static i2c_t bus;
+    static sdev_t device;
+    static i2c_sdev_context_t context;
+    uint8_t buf[2];
+
+    if (i2c_open(&bus, &ops, (void*)&reg) != STATUS_OK
+        || i2c_sdev_open(&bus, &device, &context, 0x76) != STATUS_OK)
+        return 1;
+
+    BENCH_RUN(BENCH_NAME, BENCH_ITERATIONS, {
+        sdev_read(&device, buf, sizeof(buf));
+        bench_sink += buf[0];
+    });
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef BENCH_BENCH_BIND_BOARD_H
+#define BENCH_BENCH_BIND_BOARD_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "common/types.h"
+
+/**
+ * Board I2C handlers of the binding benchmark, a bus whose data register is a byte in memory
+ *
+ * Used as `DRIVERS_BINDING_HEADER` by every source of `bench_bind_static`,
+ * `bench_bind` puts the same handlers in an ops table.
+*/
+
+static inline status_t bench_bus_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    volatile uint8_t* reg = (volatile uint8_t*)context;
+
+    UNUSED(addr);
+    for (size_t i = 0; i < nbyte; i++)
+        *reg = data[i];
+
+    return STATUS_OK;
+}
+
+static inline status_t bench_bus_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    volatile uint8_t* reg = (volatile uint8_t*)context;
+
+    UNUSED(addr);
+    for (size_t i = 0; i < nbyte; i++)
+        data[i] = *reg;
+
+    return STATUS_OK;
+}
+
+static inline status_t bench_bus_dev_probe(void* context, uint8_t addr)
+{
+    UNUSED(context);
+    UNUSED(addr);
+
+    return STATUS_OK;
+}
+
+#ifdef BENCH_BIND_STATIC
+#define SDEV_BIND_WRITE     i2c_sdev_write
+#define SDEV_BIND_READ      i2c_sdev_read
+#define SDEV_BIND_TEST      i2c_sdev_test
+#define I2C_BIND_WRITE      bench_bus_write
+#define I2C_BIND_READ       bench_bus_read
+#define I2C_BIND_DEV_PROBE  bench_bus_dev_probe
+
+/* Bound sdev handlers, also for drivers/sdev.c */
+#include "drivers/i2c.h"
+#endif
+
+#endif
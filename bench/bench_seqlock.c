@@ -0,0 +1,167 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "common/seqlock.h"
+#include "bench.h"
+
+/**
+ * Snapshot publication (common/seqlock.h) without and with contention
+ *
+ * The uncontended part times single calls. The contended part runs writer and reader
+ * threads over a 64 byte value for `BENCH_DURATION_NS` and reports the time per read and
+ * per publication. Every read is checked for tearing, a torn read fails the benchmark.
+*/
+
+#define BENCH_DURATION_NS   (300000000ull)
+#define VALUE_WORDS         (16)
+
+typedef struct {
+    uint32_t words[VALUE_WORDS];
+} value_t;
+
+typedef enum {
+    PUBLISH_SINGLE,
+    PUBLISH_LOCKED,
+    PUBLISH_TRY
+} publish_t;
+
+static snapshot_t snap;
+static value_t storage;
+static publish_t publish;
+static atomic_bool stop;
+static atomic_ulong reads;
+static atomic_ulong writes;
+static atomic_ulong dropped;
+static atomic_ulong torn;
+
+static void* writer(void* arg)
+{
+    value_t value;
+    uint32_t n = (uint32_t)(uintptr_t)arg << 24;
+    unsigned long count = 0;
+    unsigned long drops = 0;
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        n++;
+        for (size_t i = 0; i < VALUE_WORDS; i++)
+            value.words[i] = n;
+
+        if (publish == PUBLISH_SINGLE)
+            snapshot_publish(&snap, &value);
+        else if (publish == PUBLISH_LOCKED)
+            snapshot_publish_locked(&snap, &value);
+        else if (snapshot_try_publish(&snap, &value) != STATUS_OK)
+            drops++;
+        count++;
+
+        /* Let the readers run on hosts with fewer cores than threads */
+        if ((n & 0xff) == 0)
+            sched_yield();
+    }
+
+    atomic_fetch_add(&writes, count);
+    atomic_fetch_add(&dropped, drops);
+    return NULL;
+}
+
+static void* reader(void* arg)
+{
+    value_t value;
+    unsigned long count = 0;
+    unsigned long torn_count = 0;
+
+    UNUSED(arg);
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        snapshot_read(&snap, &value);
+        count++;
+
+        for (size_t i = 1; i < VALUE_WORDS; i++) {
+            if (value.words[i] != value.words[0]) {
+                torn_count++;
+                break;
+            }
+        }
+
+        if ((count & 0x3ff) == 0)
+            sched_yield();
+    }
+
+    atomic_fetch_add(&reads, count);
+    atomic_fetch_add(&torn, torn_count);
+    return NULL;
+}
+
+/**
+ * Run `n_writers` and `n_readers` threads and report them under `name`
+ *
+ * @return Nonzero if a read was torn
+*/
+static int bench_contention(const char* name, publish_t mode, uint32_t n_writers, uint32_t n_readers)
+{
+    pthread_t threads[8];
+    char label[64];
+
+    snapshot_init(&snap, &storage, sizeof(storage));
+    publish = mode;
+    atomic_store(&stop, 0);
+    atomic_store(&reads, 0);
+    atomic_store(&writes, 0);
+    atomic_store(&dropped, 0);
+    atomic_store(&torn, 0);
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < n_writers; i++)
+        pthread_create(&threads[i], NULL, writer, (void*)(uintptr_t)i);
+    for (uint32_t i = 0; i < n_readers; i++)
+        pthread_create(&threads[n_writers + i], NULL, reader, NULL);
+
+    while (bench_now_ns() - start < BENCH_DURATION_NS)
+        sched_yield();
+    atomic_store(&stop, 1);
+
+    for (uint32_t i = 0; i < n_writers + n_readers; i++)
+        pthread_join(threads[i], NULL);
+    uint64_t elapsed = bench_now_ns() - start;
+
+    snprintf(label, sizeof(label), "%s read", name);
+    bench_report(label, elapsed * n_readers, atomic_load(&reads));
+    snprintf(label, sizeof(label), "%s publish", name);
+    bench_report(label, elapsed * n_writers, atomic_load(&writes));
+    if (mode == PUBLISH_TRY)
+        printf("%-40s %10lu of %lu\n", "  dropped", atomic_load(&dropped), atomic_load(&writes));
+
+    return atomic_load(&torn) != 0;
+}
+
+int main(void)
+{
+    value_t value = { { 0 } };
+
+    snapshot_init(&snap, &storage, sizeof(storage));
+
+    BENCH_RUN("snapshot_publish", BENCH_ITERATIONS, {
+        value.words[0] = bench_i_;
+        snapshot_publish(&snap, &value);
+    });
+    BENCH_RUN("snapshot_publish_locked", BENCH_ITERATIONS, {
+        value.words[0] = bench_i_;
+        snapshot_publish_locked(&snap, &value);
+    });
+    BENCH_RUN("snapshot_try_publish", BENCH_ITERATIONS, {
+        value.words[0] = bench_i_;
+        snapshot_try_publish(&snap, &value);
+    });
+    BENCH_RUN("snapshot_read", BENCH_ITERATIONS, {
+        snapshot_read(&snap, &value);
+        bench_sink += value.words[0];
+    });
+
+    if (bench_contention("1 writer 1 reader", PUBLISH_SINGLE, 1, 1)
+        || bench_contention("1 writer 3 readers", PUBLISH_SINGLE, 1, 3)
+        || bench_contention("2 writers 2 readers (locked)", PUBLISH_LOCKED, 2, 2)
+        || bench_contention("2 writers 2 readers (try)", PUBLISH_TRY, 2, 2))
+        return 1;
+
+    return 0;
+}
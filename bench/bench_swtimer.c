@@ -0,0 +1,112 @@
+#include "drivers/swtimer.h"
+#include "bench.h"
+
+/**
+ * Software timer wheel (swtimer.c) with 10 and with 10000 running timers
+ *
+ * The wheel runs on a fake hardware timer and the benchmark calls `swtimer_wheel_isr` itself.
+ * Timers are periodic with periods spread over all levels. Start and stop, a tick and a
+ * tickless ISR should cost about the same for both counts, only the expirations add work.
+*/
+
+#define TIMERS_MAX      (10000u)
+#define TICKS           (2000000u)
+#define PERIOD_MIN      (16u)
+#define PERIOD_SPREAD   (200000u)
+
+static hal_target_pc_timer_t hw_timer;
+static swtimer_wheel_t wheel;
+static swtimer_t timers[TIMERS_MAX];
+static swtimer_t probe;
+static uint32_t expirations;
+
+/* Required by the PC target header */
+int socket_write(socket_periph_t periph, uint8_t id, const void* data, size_t len)
+{
+    UNUSED(periph);
+    UNUSED(id);
+    UNUSED(data);
+
+    return (int)len;
+}
+
+/* Fake hardware timer, the count stays at 0 */
+hal_status_t timer_set_period(hal_timer_t timer, timer_count_t period)
+{
+    timer->period = period;
+    return HAL_STATUS_OK;
+}
+
+hal_status_t timer_start(hal_timer_t timer)
+{
+    timer->running = 1;
+    return HAL_STATUS_OK;
+}
+
+hal_status_t timer_clear(hal_timer_t timer)
+{
+    UNUSED(timer);
+    return HAL_STATUS_OK;
+}
+
+timer_count_t timer_get_count(hal_timer_t timer)
+{
+    UNUSED(timer);
+    return 0;
+}
+
+static void expired(void* arg)
+{
+    UNUSED(arg);
+    expirations++;
+}
+
+/**
+ * Open the wheel with `count` periodic timers
+*/
+static void wheel_fill(uint32_t count, uint8_t tickless)
+{
+    uint32_t seed = 12345;
+
+    swtimer_wheel_open(&wheel, &hw_timer, 1, tickless);
+    for (uint32_t i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t period = PERIOD_MIN + (seed >> 8) % PERIOD_SPREAD;
+
+        swtimer_init(&timers[i], expired, NULL);
+        swtimer_start(&wheel, &timers[i], period, period);
+    }
+    swtimer_init(&probe, expired, NULL);
+}
+
+static void bench_timers(uint32_t count)
+{
+    char label[64];
+
+    wheel_fill(count, 0);
+    snprintf(label, sizeof(label), "%u timers: start and stop", (unsigned)count);
+    BENCH_RUN(label, BENCH_ITERATIONS, {
+        swtimer_start(&wheel, &probe, 1 + (bench_i_ & 0xffff), 0);
+        swtimer_stop(&wheel, &probe);
+    });
+
+    expirations = 0;
+    snprintf(label, sizeof(label), "%u timers: tick", (unsigned)count);
+    BENCH_RUN(label, TICKS, swtimer_wheel_isr(&wheel));
+    printf("%-40s %10.3f per tick\n", "  expirations", (double)expirations / TICKS);
+
+    /* Each ISR jumps to the next expiry, reported per ISR */
+    wheel_fill(count, 1);
+    expirations = 0;
+    snprintf(label, sizeof(label), "%u timers: tickless ISR", (unsigned)count);
+    BENCH_RUN(label, TICKS / 10, swtimer_wheel_isr(&wheel));
+    printf("%-40s %10.3f per ISR\n", "  expirations", (double)expirations / (TICKS / 10));
+}
+
+int main(void)
+{
+    bench_timers(10);
+    bench_timers(TIMERS_MAX);
+
+    return 0;
+}
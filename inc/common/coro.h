@@ -0,0 +1,99 @@
+#ifndef _COMMON_CORO_H
+#define _COMMON_CORO_H
+
+#include <stdint.h>
+
+/**
+ * Stackless coroutines (protothreads)
+ *
+ * A coroutine is a function which returns whenever it has to wait and continues from the
+ * same place when it is called again. The resume point is a `switch` case label
+ * saved in `coro_t`, so a coroutine needs two bytes of state and no stack of its own.
+ *
+ * @example
+ * coro_status_t blink(coro_t* c)
+ * {
+ *     CORO_BEGIN(c);
+ *     for (;;) {
+ *         gpio_port_toggle(LED_PORT, LED_PIN);
+ *         CORO_AWAIT(c, led_timer_expired());
+ *     }
+ *     CORO_END(c);
+ * }
+ *
+ * @note Local variables are not kept between calls, state has to be stored in a structure
+ * @note `switch` statements can not be used between `CORO_BEGIN` and `CORO_END`
+ * @note Only one wait per source line
+*/
+
+typedef enum {
+    /* Waiting for a condition, should be called again once it can be true */
+    CORO_WAITING,
+    /* Gave up the processor, should be called again as soon as possible */
+    CORO_YIELDED,
+    CORO_DONE
+} coro_status_t;
+
+typedef struct coro {
+    uint16_t line;
+} coro_t;
+
+#define CORO_LINE_DONE          (UINT16_MAX)
+
+/**
+ * Start the coroutine from the beginning on the next call
+*/
+#define CORO_INIT(c)            ((c)->line = 0)
+
+#define CORO_BEGIN(c)           switch ((c)->line) { case 0:
+
+/**
+ * Finish the coroutine, later calls return `CORO_DONE` until `CORO_INIT`
+*/
+#define CORO_END(c)             } (c)->line = CORO_LINE_DONE; return CORO_DONE
+
+/**
+ * Return `CORO_WAITING` until `cond` is true
+*/
+#define CORO_AWAIT(c, cond)                                                         \
+    do {                                                                            \
+        (c)->line = __LINE__;                                                       \
+        case __LINE__:                                                              \
+        if (!(cond))                                                                \
+            return CORO_WAITING;                                                    \
+    } while (0)
+
+/**
+ * Return `CORO_YIELDED` once and continue after it on the next call
+*/
+#define CORO_YIELD(c)                                                               \
+    do {                                                                            \
+        (c)->line = __LINE__;                                                       \
+        return CORO_YIELDED;                                                        \
+        case __LINE__:;                                                             \
+    } while (0)
+
+/**
+ * Run a child coroutine `call` (using state `child`) until it is done
+*/
+#define CORO_CALL(c, child, call)                                                   \
+    do {                                                                            \
+        CORO_INIT(child);                                                           \
+        (c)->line = __LINE__;                                                       \
+        case __LINE__: {                                                            \
+            coro_status_t coro_child_status_ = (call);                              \
+            if (coro_child_status_ != CORO_DONE)                                    \
+                return coro_child_status_;                                          \
+        }                                                                           \
+    } while (0)
+
+/**
+ * Finish the coroutine from any place
+*/
+#define CORO_EXIT(c)                                                                \
+    do {                                                                            \
+        (c)->line = CORO_LINE_DONE;                                                 \
+        return CORO_DONE;                                                           \
+    } while (0)
+
+#endif
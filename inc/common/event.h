@@ -0,0 +1,153 @@
+#ifndef _COMMON_EVENT_H
+#define _COMMON_EVENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common/types.h"
+
+/**
+ * Run-to-completion event loop for deferring work out of interrupts
+ *
+ * ISRs post small events (handler, argument and a 32-bit value) into lock-free queues,
+ * one per priority. The main context dispatches them, always from the highest priority
+ * queue which has events, taking up to `EVENT_BATCH` events from a queue before the
+ * higher priorities are checked again. Handlers run to completion and never preempt each other.
+ *
+ * @example
+ * void button_handler(void* arg, uint32_t pins) { ... }
+ *
+ * void gpio_exti_isr(gpio_port_t port, gpio_pin_t pin)
+ * {
+ *     event_post(&loop, 0, button_handler, port, pin);
+ * }
+ *
+ * @note `event_post` is safe to call from any context including ISRs
+*/
+
+/**
+ * Number of priorities, 0 is the highest
+*/
+#ifndef EVENT_PRIORITIES
+#define EVENT_PRIORITIES        (4)
+#endif
+
+/**
+ * Number of events each priority queue can hold, must be a power of two
+*/
+#ifndef EVENT_QUEUE_LEN
+#define EVENT_QUEUE_LEN         (32)
+#endif
+
+/**
+ * Events dispatched from one queue before higher priorities are checked again
+*/
+#ifndef EVENT_BATCH
+#define EVENT_BATCH             (8)
+#endif
+
+/**
+ * Timestamp stored when an event is posted, dispatch latency is measured in its units,
+ * for example a free running timer count
+*/
+#ifndef EVENT_TIMESTAMP
+#define EVENT_TIMESTAMP()       (0u)
+#endif
+
+/**
+ * Called by `event_loop_run` when there are no events, for example `__WFI()`
+*/
+#ifndef EVENT_IDLE
+#define EVENT_IDLE()
+#endif
+
+typedef void (*event_handler_t)(void* arg, uint32_t data);
+
+/**
+ * Queue cell, `seq` tells whose turn it is: equal to the position when free for the
+ * producer, position + 1 when filled for the consumer
+*/
+typedef struct event_cell {
+    atomic_uint seq;
+    event_handler_t handler;
+    void* arg;
+    uint32_t data;
+    uint32_t timestamp;
+} event_cell_t;
+
+/**
+ * Events of one priority
+*/
+typedef struct event_queue {
+    event_cell_t cells[EVENT_QUEUE_LEN];
+    atomic_uint enqueue_pos;
+    atomic_uint dequeue_pos;
+    /* Instrumentation */
+    atomic_uint max_depth;
+    atomic_uint dropped;
+    uint32_t dispatched;
+    uint32_t max_latency;
+} event_queue_t;
+
+/**
+ * @note Members should only be used through API functions starting with event_*
+*/
+typedef struct event_loop {
+    event_queue_t queues[EVENT_PRIORITIES];
+    /* Bit per priority which may have events */
+    atomic_uint pending;
+} event_loop_t;
+
+/**
+ * Statistics of one priority
+*/
+typedef struct event_stats {
+    /* Events waiting now and the most which were ever waiting */
+    uint32_t depth;
+    uint32_t max_depth;
+    /* Events not posted because the queue was full */
+    uint32_t dropped;
+    uint32_t dispatched;
+    /* Longest time from posting to dispatch, in `EVENT_TIMESTAMP` units */
+    uint32_t max_latency;
+} event_stats_t;
+
+/**
+ * Initialize an empty event loop
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t event_loop_init(event_loop_t* loop);
+
+/**
+ * Post an event to be dispatched from the main context
+ *
+ * @return `STATUS_ERROR` if the queue of the priority is full, the event is dropped
+*/
+status_t event_post(event_loop_t* loop, uint8_t priority, event_handler_t handler, void* arg, uint32_t data);
+
+/**
+ * Dispatch events until all queues are empty
+ *
+ * @note Only one context may dispatch at a time
+ *
+ * @return Number of dispatched events
+*/
+size_t event_loop_poll(event_loop_t* loop);
+
+/**
+ * Dispatch events forever, calling `EVENT_IDLE` whenever there are none
+*/
+void event_loop_run(event_loop_t* loop);
+
+/**
+ * Get the statistics of a priority
+*/
+status_t event_loop_get_stats(event_loop_t* loop, uint8_t priority, event_stats_t* stats);
+
+/**
+ * Clear the maximum depth, maximum latency, dropped and dispatched counters
+*/
+void event_loop_reset_stats(event_loop_t* loop);
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef _COMMON_LOG_H
+#define _COMMON_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "common/types.h"
+
+/**
+ * Deferred binary logging
+ *
+ * `LOG` stores only the id of the format string and the raw arguments into a lock-free
+ * ring, `log_drain` sends the records over `io_putdata` in a compact binary form and
+ * tools/log_decode.py rebuilds the text on the host using the format strings from the ELF file.
+ *
+ * Format strings are placed in the `log_fmt` section, the id of a format is its offset
+ * in that section. The strings are only read by the decoder, so the section does not have
+ * to be flashed, but it must keep its contents in the ELF file: it can not be NOLOAD (NOBITS).
+ * For example give it its own region in the linker script and leave it out of the flashed
+ * image with `objcopy -R log_fmt` when creating the .bin or .hex file.
+ *
+ * @note Arguments are stored as 32-bit integers, so only integer, character and pointer
+ * conversions are supported (no `%s` or floating point)
+ * @note Safe to call from any context including ISRs
+ *
+ * @example LOG("adc overrun on channel %u, count %d\n", ch, count);
+*/
+
+/**
+ * Number of records the ring can hold, must be a power of two
+*/
+#ifndef LOG_RING_LEN
+#define LOG_RING_LEN            (64)
+#endif
+
+/**
+ * Maximum number of arguments of a single log call
+*/
+#define LOG_MAX_ARGS            (6)
+
+/**
+ * Size of the buffer encoded records are collected into before `io_putdata` is called
+*/
+#ifndef LOG_DRAIN_BUFFER_LEN
+#define LOG_DRAIN_BUFFER_LEN    (256)
+#endif
+
+/**
+ * Timestamp stored with every record, for example a timer count
+*/
+#ifndef LOG_TIMESTAMP
+#define LOG_TIMESTAMP()         (0u)
+#endif
+
+#define LOG_FMT_SECTION         __attribute__((section("log_fmt"), used))
+
+#define LOG_CAT_(a, b)          a##b
+#define LOG_CAT(a, b)           LOG_CAT_(a, b)
+
+#define LOG_FIRST_(f, ...)      f
+#define LOG_FIRST(...)          LOG_FIRST_(__VA_ARGS__, _)
+
+#define LOG_COUNT_(f, a1, a2, a3, a4, a5, a6, n, ...)   n
+#define LOG_COUNT(...)          LOG_COUNT_(__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0, _)
+
+#define LOG_ARG(a)              ((uint32_t)(uintptr_t)(a))
+#define LOG_ARGS_0(f)                               NULL
+#define LOG_ARGS_1(f, a)                            (const uint32_t[]){LOG_ARG(a)}
+#define LOG_ARGS_2(f, a, b)                         (const uint32_t[]){LOG_ARG(a), LOG_ARG(b)}
+#define LOG_ARGS_3(f, a, b, c)                      (const uint32_t[]){LOG_ARG(a), LOG_ARG(b), LOG_ARG(c)}
+#define LOG_ARGS_4(f, a, b, c, d)                   (const uint32_t[]){LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d)}
+#define LOG_ARGS_5(f, a, b, c, d, e)                (const uint32_t[]){LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e)}
+#define LOG_ARGS_6(f, a, b, c, d, e, g)             (const uint32_t[]){LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e), LOG_ARG(g)}
+
+/**
+ * Log a message with up to `LOG_MAX_ARGS` arguments, first argument must be a string literal
+*/
+#define LOG(...)                                                                    \
+    do {                                                                            \
+        static const char LOG_FMT_SECTION log_fmt_[] = LOG_FIRST(__VA_ARGS__);     \
+        log_record(log_fmt_, LOG_COUNT(__VA_ARGS__),                                \
+            LOG_CAT(LOG_ARGS_, LOG_COUNT(__VA_ARGS__))(__VA_ARGS__));               \
+    } while (0)
+
+/**
+ * Store a record into the ring
+ *
+ * @note Use through `LOG`, `fmt` must be in the `log_fmt` section
+ *
+ * @return `STATUS_ERROR` if the ring is full, the record is dropped and counted
+*/
+status_t log_record(const char* fmt, uint8_t nargs, const uint32_t* args);
+
+/**
+ * Encode and send all stored records over `io_putdata`
+ *
+ * @note Should be called from a single background context (main loop or low priority task)
+ * @note Records of a buffer which could not be sent are counted as dropped
+ *
+ * @return Return value indicates if sending was successful.
+*/
+status_t log_drain(void);
+
+/**
+ * Number of records dropped because the ring was full, since the last drain
+*/
+uint32_t log_get_dropped(void);
+
+#endif
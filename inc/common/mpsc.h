@@ -0,0 +1,94 @@
+#ifndef _COMMON_MPSC_H
+#define _COMMON_MPSC_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+ * Intrusive lock-free multi-producer single-consumer queue
+ *
+ * Any number of threads (or ISRs) can push, only one context at a time can pop.
+ * Nodes are embedded in the user structures, so the queue never allocates.
+ *
+ * @note Popped nodes are no longer referenced by the queue and can be freed right away
+*/
+typedef struct mpsc_node {
+    _Atomic(struct mpsc_node*) next;
+} mpsc_node_t;
+
+typedef struct mpsc {
+    _Atomic(mpsc_node_t*) head;
+    mpsc_node_t* tail;
+    mpsc_node_t stub;
+} mpsc_t;
+
+/**
+ * Get the structure containing the node
+*/
+#define MPSC_ENTRY(node, type, member)  ((type*)((char*)(node) - offsetof(type, member)))
+
+/**
+ * Initialize an empty queue
+*/
+static inline void mpsc_init(mpsc_t* q)
+{
+    atomic_init(&q->stub.next, NULL);
+    atomic_init(&q->head, &q->stub);
+    q->tail = &q->stub;
+}
+
+/**
+ * Add a node to the queue
+ *
+ * @note Wait-free, safe to call from any context
+*/
+static inline void mpsc_push(mpsc_t* q, mpsc_node_t* node)
+{
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    mpsc_node_t* prev = atomic_exchange_explicit(&q->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+/**
+ * Remove the oldest node from the queue
+ *
+ * @note Only one context may pop at a time
+ *
+ * @return NULL if the queue is empty or a producer is in the middle of a push
+*/
+static inline mpsc_node_t* mpsc_pop(mpsc_t* q)
+{
+    mpsc_node_t* tail = q->tail;
+    mpsc_node_t* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    /* Skip the stub node, it is only used to keep the list non-empty */
+    if (tail == &q->stub) {
+        if (next == NULL)
+            return NULL;
+        q->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+
+    if (next != NULL) {
+        q->tail = next;
+        return tail;
+    }
+
+    /* Producer swapped the head but did not link the node yet */
+    if (tail != atomic_load_explicit(&q->head, memory_order_acquire))
+        return NULL;
+
+    /* Tail is the last node, put the stub behind it so it can be detached */
+    mpsc_push(q, &q->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (next != NULL) {
+        q->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef _COMMON_POOL_H
+#define _COMMON_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "common/types.h"
+
+/**
+ * Critical section around pool operations
+ *
+ * @note Pools are not thread safe by default, define these (for example as
+ * interrupt disable/enable) if objects are opened or closed from multiple contexts
+*/
+#ifndef POOL_LOCK
+#define POOL_LOCK()     ((void)0)
+#endif
+
+#ifndef POOL_UNLOCK
+#define POOL_UNLOCK()   ((void)0)
+#endif
+
+/**
+ * Fixed-block allocator over statically allocated storage
+ *
+ * Blocks are handed out from the never used part of the storage first,
+ * freed blocks are kept in a free list, so both alloc and free are O(1)
+ * and the pool does not need to be initialized at runtime.
+ *
+ * @note Should only be used through API functions starting with pool_*
+*/
+typedef struct pool {
+    uint8_t* storage;
+    size_t block_size;
+    size_t capacity;
+    /* Number of blocks ever handed out from storage */
+    size_t reserved;
+    void* free_list;
+    size_t used;
+    size_t high_water;
+    size_t failed;
+} pool_t;
+
+/**
+ * Pool usage statistics
+*/
+typedef struct pool_stats {
+    size_t capacity;
+    size_t used;
+    size_t high_water;
+    size_t failed;
+} pool_stats_t;
+
+/**
+ * Define a pool with storage for `count` objects of `type`
+ *
+ * @example POOL_DEFINE(static, i2c_pool, i2c_t, 4);
+*/
+#define POOL_DEFINE(storage_class, name, type, count)                       \
+    static union { type object; void* next; } name##_storage[count];        \
+    storage_class pool_t name = {                                           \
+        .storage = (uint8_t*)name##_storage,                                \
+        .block_size = sizeof(name##_storage[0]),                            \
+        .capacity = (count)                                                 \
+    }
+
+/**
+ * Allocate one block
+ *
+ * @return NULL if the pool is exhausted
+*/
+void* pool_alloc(pool_t* pool);
+
+/**
+ * Return a block to the pool
+ *
+ * @note Freeing the same block twice is not detected
+ *
+ * @return `STATUS_ERROR` if the block does not belong to this pool
+*/
+status_t pool_free(pool_t* pool, void* block);
+
+/**
+ * Check if the pointer is a block of this pool
+*/
+int pool_owns(const pool_t* pool, const void* block);
+
+/**
+ * Get current usage and high-water mark
+*/
+void pool_get_stats(const pool_t* pool, pool_stats_t* stats);
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef _COMMON_RING_H
+#define _COMMON_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "common/types.h"
+
+/**
+ * Single-producer single-consumer byte ring buffer
+ *
+ * Head and tail are free running counters, buffer size must be a power of two.
+ * Producer and consumer can be in different contexts (thread and ISR) without locking.
+*/
+typedef struct ring {
+    uint8_t* buffer;
+    size_t mask;
+    atomic_size_t head;
+    atomic_size_t tail;
+} ring_t;
+
+/**
+ * Contiguous region of the ring buffer
+*/
+typedef struct ring_span {
+    uint8_t* data;
+    size_t len;
+} ring_span_t;
+
+/**
+ * Initialize an empty ring over `buffer`
+ *
+ * @return `STATUS_ERROR` if `size` is not a power of two
+*/
+static inline status_t ring_init(ring_t* ring, uint8_t* buffer, size_t size)
+{
+    if (buffer == NULL || size == 0 || (size & (size - 1)) != 0)
+        return STATUS_ERROR;
+
+    ring->buffer = buffer;
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    return STATUS_OK;
+}
+
+/**
+ * Number of bytes available for reading
+*/
+static inline size_t ring_used(ring_t* ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire) -
+        atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+/**
+ * Number of bytes available for writing
+*/
+static inline size_t ring_free(ring_t* ring)
+{
+    return ring->mask + 1 - ring_used(ring);
+}
+
+/**
+ * Get the contiguous readable region starting at the tail
+ *
+ * @return Length of the region, can be less than `ring_used` if the data wraps
+*/
+static inline size_t ring_read_span(ring_t* ring, uint8_t** data)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t used = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+    size_t to_end = ring->mask + 1 - (tail & ring->mask);
+
+    *data = ring->buffer + (tail & ring->mask);
+    return used < to_end ? used : to_end;
+}
+
+/**
+ * Release `len` read bytes back to the producer
+*/
+static inline void ring_consume(ring_t* ring, size_t len)
+{
+    atomic_fetch_add_explicit(&ring->tail, len, memory_order_release);
+}
+
+/**
+ * Get the contiguous writable region starting at the head
+ *
+ * @return Length of the region, can be less than `ring_free` if the free space wraps
+*/
+static inline size_t ring_write_span(ring_t* ring, uint8_t** data)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t free = ring->mask + 1 - (head - atomic_load_explicit(&ring->tail, memory_order_acquire));
+    size_t to_end = ring->mask + 1 - (head & ring->mask);
+
+    *data = ring->buffer + (head & ring->mask);
+    return free < to_end ? free : to_end;
+}
+
+/**
+ * Publish `len` written bytes to the consumer
+*/
+static inline void ring_commit(ring_t* ring, size_t len)
+{
+    atomic_fetch_add_explicit(&ring->head, len, memory_order_release);
+}
+
+/**
+ * Publish written bytes up to the free running position `head`, unless already published
+ *
+ * @note For a producer split between contexts which agree on the positions,
+ * for example an ISR and a thread both publishing the progress of the same transfer
+*/
+static inline void ring_commit_to(ring_t* ring, size_t head)
+{
+    size_t current = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    while ((ptrdiff_t)(head - current) > 0 &&
+        !atomic_compare_exchange_weak_explicit(&ring->head, &current, head,
+            memory_order_release, memory_order_relaxed)) {}
+}
+
+/**
+ * Copy `len` bytes into the ring
+ *
+ * @note Nothing is written if there is not enough free space
+*/
+static inline status_t ring_write(ring_t* ring, const uint8_t* data, size_t len)
+{
+    if (ring_free(ring) < len)
+        return STATUS_ERROR;
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t pos = head & ring->mask;
+    size_t first = ring->mask + 1 - pos;
+
+    if (first > len)
+        first = len;
+    memcpy(ring->buffer + pos, data, first);
+    memcpy(ring->buffer, data + first, len - first);
+
+    ring_commit(ring, len);
+    return STATUS_OK;
+}
+
+/**
+ * Copy up to `len` bytes out of the ring
+ *
+ * @return Number of bytes copied
+*/
+static inline size_t ring_read(ring_t* ring, uint8_t* data, size_t len)
+{
+    size_t used = ring_used(ring);
+
+    if (len > used)
+        len = used;
+
+    size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed) & ring->mask;
+    size_t first = ring->mask + 1 - pos;
+
+    if (first > len)
+        first = len;
+    memcpy(data, ring->buffer + pos, first);
+    memcpy(data + first, ring->buffer, len - first);
+
+    ring_consume(ring, len);
+    return len;
+}
+
+
+/**
+ * Describe `len` bytes starting at counter `pos` as up to two contiguous spans
+*/
+static inline void ring_spans_at(ring_t* ring, size_t pos, size_t len, ring_span_t span[2])
+{
+    size_t offset = pos & ring->mask;
+    size_t to_end = ring->mask + 1 - offset;
+
+    span[0].data = ring->buffer + offset;
+    span[0].len = len < to_end ? len : to_end;
+    span[1].data = ring->buffer;
+    span[1].len = len - span[0].len;
+}
+
+/**
+ * Get all readable data without copying, the second span is not empty only if the data wraps
+ *
+ * @return Total length of the spans
+*/
+static inline size_t ring_read_spans(ring_t* ring, ring_span_t span[2])
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t used = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+
+    ring_spans_at(ring, tail, used, span);
+    return used;
+}
+
+/**
+ * Get the next line without copying, spans cover the line including the `delim` byte
+ *
+ * @note Line stays in the ring until `ring_consume` is called with the returned length
+ *
+ * @return Length of the line or 0 if no complete line is available
+*/
+static inline size_t ring_get_line(ring_t* ring, uint8_t delim, ring_span_t span[2])
+{
+    ring_span_t data[2];
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t len = 0;
+
+    ring_read_spans(ring, data);
+    for (uint8_t i = 0; i < 2; i++) {
+        uint8_t* end = memchr(data[i].data, delim, data[i].len);
+
+        if (end != NULL) {
+            len += (size_t)(end - data[i].data) + 1;
+            ring_spans_at(ring, tail, len, span);
+            return len;
+        }
+        len += data[i].len;
+    }
+
+    return 0;
+}
+
+/**
+ * Get the next length prefixed frame without copying
+ *
+ * Frame is a 16-bit little endian payload length followed by the payload,
+ * spans cover only the payload
+ *
+ * @note Frame stays in the ring until `ring_consume` is called with the returned length
+ * @note Frames longer than the ring never complete, the ring stays full
+ *
+ * @return Length of the whole frame (header and payload) or 0 if no complete frame is available
+*/
+static inline size_t ring_get_frame(ring_t* ring, ring_span_t span[2])
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t used = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+
+    if (used < 2)
+        return 0;
+
+    size_t payload = ring->buffer[tail & ring->mask] | (ring->buffer[(tail + 1) & ring->mask] << 8);
+    if (used < payload + 2)
+        return 0;
+
+    ring_spans_at(ring, tail + 2, payload, span);
+    return payload + 2;
+}
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef _COMMON_SEQLOCK_H
+#define _COMMON_SEQLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "common/types.h"
+
+/**
+ * Sequence lock for data written rarely and read from many contexts
+ *
+ * The writer makes the sequence odd while it writes and even again when done.
+ * Readers never block the writer, they copy the data and retry if the sequence
+ * was odd or changed during the copy.
+ *
+ * @note A reader which can preempt the writer on the same core (an ISR reading data
+ * written by a thread) has to use a single attempt, retrying would spin forever
+*/
+typedef struct seqlock {
+    atomic_uint seq;
+} seqlock_t;
+
+/**
+ * Called while spinning on a sequence lock, for example a pause instruction
+*/
+#ifndef SEQLOCK_RELAX
+#define SEQLOCK_RELAX()     ((void)0)
+#endif
+
+static inline void seqlock_init(seqlock_t* lock)
+{
+    atomic_init(&lock->seq, 0);
+}
+
+/**
+ * Start reading
+ *
+ * @return Sequence to pass to `seqlock_read_retry`
+*/
+static inline unsigned int seqlock_read_begin(seqlock_t* lock)
+{
+    return atomic_load_explicit(&lock->seq, memory_order_acquire);
+}
+
+/**
+ * Check if the data read since `seqlock_read_begin` may be torn
+*/
+static inline uint8_t seqlock_read_retry(seqlock_t* lock, unsigned int start)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return (start & 1) || atomic_load_explicit(&lock->seq, memory_order_relaxed) != start;
+}
+
+/**
+ * Start writing when there is a single writer
+*/
+static inline void seqlock_write_begin(seqlock_t* lock)
+{
+    unsigned int seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * Finish writing, also releases `seqlock_write_lock`
+*/
+static inline void seqlock_write_end(seqlock_t* lock)
+{
+    unsigned int seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_release);
+}
+
+/**
+ * Start writing if no other writer is writing
+ *
+ * @return Nonzero if the lock was taken
+*/
+static inline uint8_t seqlock_write_trylock(seqlock_t* lock)
+{
+    unsigned int seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+
+    if ((seq & 1) || !atomic_compare_exchange_strong_explicit(&lock->seq, &seq, seq + 1,
+        memory_order_acquire, memory_order_relaxed))
+        return 0;
+
+    atomic_thread_fence(memory_order_release);
+    return 1;
+}
+
+/**
+ * Start writing when there are multiple writers, waits for the current writer
+*/
+static inline void seqlock_write_lock(seqlock_t* lock)
+{
+    while (!seqlock_write_trylock(lock))
+        SEQLOCK_RELAX();
+}
+
+/**
+ * Value published under a sequence lock
+ *
+ * Writers publish a whole structure, readers get a consistent copy of the last published
+ * one without locking. The version counts publications, 0 means nothing was published yet.
+ *
+ * @example
+ * snapshot_t imu_snapshot;
+ * imu_sample_t imu_storage;
+ *
+ * snapshot_init(&imu_snapshot, &imu_storage, sizeof(imu_storage));
+ *
+ * // sampling thread
+ * snapshot_publish(&imu_snapshot, &sample);
+ *
+ * // control loop
+ * imu_sample_t latest;
+ * snapshot_read(&imu_snapshot, &latest);
+ *
+ * @note Members should only be used through API functions starting with snapshot_*
+*/
+typedef struct snapshot {
+    seqlock_t lock;
+    void* data;
+    size_t size;
+} snapshot_t;
+
+/**
+ * Initialize the snapshot over user allocated `storage` of `size` bytes
+*/
+static inline status_t snapshot_init(snapshot_t* snap, void* storage, size_t size)
+{
+    if (storage == NULL || size == 0)
+        return STATUS_ERROR;
+
+    seqlock_init(&snap->lock);
+    snap->data = storage;
+    snap->size = size;
+
+    return STATUS_OK;
+}
+
+/**
+ * Publish a new value when there is a single writer
+*/
+static inline void snapshot_publish(snapshot_t* snap, const void* value)
+{
+    seqlock_write_begin(&snap->lock);
+    memcpy(snap->data, value, snap->size);
+    seqlock_write_end(&snap->lock);
+}
+
+/**
+ * Publish a new value when there are multiple writers
+ *
+ * @note Waits for the current writer, so it deadlocks if it preempts that writer on the same
+ * core (an ISR publishing while a thread publishes), use `snapshot_try_publish` there
+*/
+static inline void snapshot_publish_locked(snapshot_t* snap, const void* value)
+{
+    seqlock_write_lock(&snap->lock);
+    memcpy(snap->data, value, snap->size);
+    seqlock_write_end(&snap->lock);
+}
+
+/**
+ * Publish a new value if no other writer is publishing
+ *
+ * @note Never waits, safe to call from a context which preempts another writer
+ *
+ * @return `STATUS_ERROR` if another writer was publishing, the value is then dropped
+*/
+static inline status_t snapshot_try_publish(snapshot_t* snap, const void* value)
+{
+    if (!seqlock_write_trylock(&snap->lock))
+        return STATUS_ERROR;
+
+    memcpy(snap->data, value, snap->size);
+    seqlock_write_end(&snap->lock);
+
+    return STATUS_OK;
+}
+
+/**
+ * Copy the last published value with a single attempt
+ *
+ * @note Safe to call from a context which preempts the writer
+ *
+ * @return `STATUS_ERROR` if a write was in progress, `value` is then undefined
+*/
+static inline status_t snapshot_try_read(snapshot_t* snap, void* value)
+{
+    unsigned int start = seqlock_read_begin(&snap->lock);
+
+    memcpy(value, snap->data, snap->size);
+
+    return STATUS_FROM_BOOL(!seqlock_read_retry(&snap->lock, start));
+}
+
+/**
+ * Copy the last published value, retrying until the copy is consistent
+ *
+ * @return Version of the copied value
+*/
+static inline unsigned int snapshot_read(snapshot_t* snap, void* value)
+{
+    unsigned int start;
+
+    for (;;) {
+        start = seqlock_read_begin(&snap->lock);
+        memcpy(value, snap->data, snap->size);
+        if (!seqlock_read_retry(&snap->lock, start))
+            break;
+        SEQLOCK_RELAX();
+    }
+
+    return start / 2;
+}
+
+/**
+ * Version of the last published value, to check for new values without copying
+*/
+static inline unsigned int snapshot_version(snapshot_t* snap)
+{
+    return atomic_load_explicit(&snap->lock.seq, memory_order_acquire) / 2;
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef DRIVERS_ADC_PROC_H
+#define DRIVERS_ADC_PROC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "common/types.h"
+
+/**
+ * ADC sample processing
+ *
+ * Fixed-point kernels over 16-bit samples as written by the ADC DMA (see drivers/adc_stream.h).
+ * SSE2 is used on hosts which support it, on Cortex-M with the DSP extension the
+ * multiply-accumulate kernels use dual 16-bit MAC instructions. All other builds use
+ * plain loops which the compiler can vectorise.
+ *
+ * @note Functions do not allocate, state and output buffers are provided by the caller
+*/
+
+/**
+ * Statistics of a block of samples
+*/
+typedef struct adc_proc_stats {
+    uint16_t min;
+    uint16_t max;
+    uint16_t mean;
+    uint16_t rms;
+} adc_proc_stats_t;
+
+#define ADC_PROC_CIC_MAX_ORDER  (5)
+
+/**
+ * Cascaded integrator-comb decimator
+ *
+ * @note Members should only be used through API functions starting with adc_proc_cic_*
+*/
+typedef struct adc_proc_cic {
+    uint8_t order;
+    uint16_t decimation;
+    uint8_t shift;
+    uint16_t phase;
+    /* Integrator and comb states, wrap around arithmetic is intended */
+    uint32_t integrator[ADC_PROC_CIC_MAX_ORDER];
+    uint32_t comb[ADC_PROC_CIC_MAX_ORDER];
+} adc_proc_cic_t;
+
+/**
+ * Decimating FIR filter with Q15 coefficients
+ *
+ * @note Members should only be used through API functions starting with adc_proc_fir_*
+*/
+typedef struct adc_proc_fir {
+    const int16_t* taps;
+    /* Delay line written twice, so the last `ntaps` samples are always contiguous (newest first) */
+    int16_t* delay;
+    uint16_t ntaps;
+    uint16_t decimation;
+    uint16_t pos;
+    uint16_t phase;
+} adc_proc_fir_t;
+
+/**
+ * Split `frames` frames of `channels` interleaved samples into one buffer per channel
+*/
+void adc_proc_deinterleave(const uint16_t* in, size_t frames, uint8_t channels, uint16_t* const* out);
+
+/**
+ * Oversample by summing groups of `factor` samples and shifting the sum right by `shift`
+ *
+ * @note For `factor` = 4^k and `shift` = k the resolution is increased by k bits,
+ * for `shift` = log2(`factor`) the result is the average
+ *
+ * @return Number of output samples (`n` / `factor`)
+*/
+size_t adc_proc_oversample(const uint16_t* in, size_t n, uint16_t factor, uint8_t shift, uint16_t* out);
+
+/**
+ * Convert samples to signed by subtracting `offset` (for example the mid-scale value)
+*/
+void adc_proc_to_signed(const uint16_t* in, size_t n, uint16_t offset, int16_t* out);
+
+/**
+ * Minimum, maximum, mean and RMS of the samples
+*/
+status_t adc_proc_get_stats(const uint16_t* in, size_t n, adc_proc_stats_t* stats);
+
+/**
+ * Dot product of two Q15 vectors with a 32-bit accumulator
+*/
+int32_t adc_proc_dot_q15(const int16_t* a, const int16_t* b, size_t n);
+
+/**
+ * Initialize a CIC decimator
+ *
+ * @note Gain of the filter is `decimation`^`order`, the output is shifted right by `shift`
+ * to compensate, for unity gain `shift` = `order` * log2(`decimation`)
+ * @note Input bits + `order` * log2(`decimation`) must not exceed 32
+*/
+status_t adc_proc_cic_init(adc_proc_cic_t* cic, uint8_t order, uint16_t decimation, uint8_t shift);
+
+/**
+ * Filter and decimate `n` samples
+ *
+ * @return Number of output samples written to `out`, at most `n` / `decimation` + 1
+*/
+size_t adc_proc_cic_run(adc_proc_cic_t* cic, const uint16_t* in, size_t n, uint16_t* out);
+
+/**
+ * Initialize a decimating FIR filter
+ *
+ * @note `taps[0]` multiplies the newest sample
+ * @note `taps` and `state` must have static (persistent) allocation, `state` must hold 2 * `ntaps` values
+*/
+status_t adc_proc_fir_init(adc_proc_fir_t* fir, const int16_t* taps, uint16_t ntaps,
+    uint16_t decimation, int16_t* state);
+
+/**
+ * Filter and decimate `n` signed samples, output is rounded and saturated to Q15
+ *
+ * @return Number of output samples written to `out`, at most `n` / `decimation` + 1
+*/
+size_t adc_proc_fir_run(adc_proc_fir_t* fir, const int16_t* in, size_t n, int16_t* out);
+
+#endif
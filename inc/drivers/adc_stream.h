@@ -0,0 +1,113 @@
+#ifndef DRIVERS_ADC_STREAM_H
+#define DRIVERS_ADC_STREAM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "hal_adc.h"
+#include "common/types.h"
+
+/**
+ * Called from ISR every time a half of the buffer is filled
+*/
+typedef void (*adc_stream_callback_t)(void* arg, const uint16_t* samples, size_t count);
+
+/**
+ * Continuous ADC acquisition into a circular DMA buffer
+ *
+ * DMA never stops, the consumer reads completed samples in place up to the current
+ * DMA write position. Positions are free running sample counters, the half and full
+ * buffer ISRs count the laps of the DMA.
+ *
+ * @note Members should only be used through API functions starting with adc_stream_*
+*/
+typedef struct adc_stream {
+    adc_t adc;
+    uint16_t* buffer;
+    uint32_t length;
+    /* Samples written up to the last half or full buffer ISR */
+    atomic_uint_fast32_t written;
+    uint32_t read_pos;
+    adc_stream_callback_t callback;
+    void* arg;
+    /* Samples lost because the consumer was too slow */
+    atomic_uint_fast32_t lost;
+    /* ADC overrun or DMA errors */
+    atomic_uint_fast32_t errors;
+} adc_stream_t;
+
+/**
+ * Initialize the stream over `buffer` of `length` samples
+ *
+ * @note `length` must be a power of two, DMA must be configured in circular mode with half-word transfers
+ * @note Requires static (persistent) allocation of the stream and the buffer
+ * @note `adc_dma_buffer_half_isr`, `adc_dma_buffer_filled_isr` and `adc_error_isr` for this ADC
+ * must call `adc_stream_half_isr`, `adc_stream_full_isr` and `adc_stream_error_isr`
+*/
+status_t adc_stream_open(adc_stream_t* stream, adc_t adc, uint16_t* buffer, uint32_t length);
+
+/**
+ * Set the callback called with each filled half of the buffer (ping-pong processing)
+ *
+ * @note Callback must finish before the other half is filled
+*/
+status_t adc_stream_set_callback(adc_stream_t* stream, adc_stream_callback_t callback, void* arg);
+
+/**
+ * Start continuous sampling
+*/
+status_t adc_stream_start(adc_stream_t* stream);
+
+/**
+ * Stop sampling
+*/
+status_t adc_stream_stop(adc_stream_t* stream);
+
+/**
+ * Get the contiguous completed samples starting at the read position
+ *
+ * @note If the DMA has lapped the read position, the overwritten samples are skipped and counted as lost
+ *
+ * @return Number of samples, can be less than available if the data wraps
+*/
+size_t adc_stream_read_span(adc_stream_t* stream, const uint16_t** samples);
+
+/**
+ * Release `count` samples returned by `adc_stream_read_span`
+ *
+ * @return `STATUS_ERROR` if the DMA overwrote some of the samples while they were being used
+*/
+status_t adc_stream_release(adc_stream_t* stream, size_t count);
+
+/**
+ * Number of samples lost because the consumer did not keep up
+*/
+uint32_t adc_stream_get_lost(adc_stream_t* stream);
+
+/**
+ * Number of ADC overrun and DMA errors
+*/
+uint32_t adc_stream_get_errors(adc_stream_t* stream);
+
+/**
+ * First half of the buffer filled
+ *
+ * @note Should be called from `adc_dma_buffer_half_isr`
+*/
+void adc_stream_half_isr(adc_stream_t* stream);
+
+/**
+ * Second half of the buffer filled
+ *
+ * @note Should be called from `adc_dma_buffer_filled_isr`
+*/
+void adc_stream_full_isr(adc_stream_t* stream);
+
+/**
+ * ADC overrun or DMA error
+ *
+ * @note Should be called from `adc_error_isr`
+*/
+void adc_stream_error_isr(adc_stream_t* stream);
+
+#endif
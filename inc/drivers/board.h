@@ -0,0 +1,220 @@
+#ifndef DRIVERS_BOARD_H
+#define DRIVERS_BOARD_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "common/types.h"
+#include "drivers/coro_sched.h"
+#include "drivers/i2c.h"
+#include "drivers/i2c_mux.h"
+#include "drivers/sdev.h"
+
+/**
+ * Declarative board description
+ *
+ * Buses, multiplexers, multiplexer channels and devices are listed in X-macro tables,
+ * `BOARD_DEFINE` emits the driver structures and constant tables from them and
+ * `board_init` brings the whole board up.
+ *
+ * Bring-up is split into lanes, one per root bus. A lane probes and initializes the devices
+ * of its bus, grouped by multiplexer channel so each channel is selected once. Lanes share
+ * nothing: by default they are coroutines which take turns device by device, they run in
+ * parallel if `BOARD_LANE_START` starts them in separate threads.
+ *
+ * @note Probes and driver initialization are blocking calls, coroutine lanes only interleave
+ * them and bring-up takes as long as all of them one after another. Only lane threads
+ * overlap the transactions of different buses and shorten the bring-up.
+ *
+ * @example
+ * #define BOARD_BUSES(X)                                                  \
+ *     X(i2c_sensors, &stm32_i2c_ops, &i2c1_bus)                           \
+ *     X(i2c_aux, &stm32_i2c_ops, &i2c2_bus)
+ *
+ * #define BOARD_MUXES(X)                                                  \
+ *     X(mux_sensors, i2c_sensors, &tca9544a_i2c_mux_open)
+ *
+ * #define BOARD_MUX_CHANNELS(X)                                           \
+ *     X(i2c_outside, mux_sensors, I2C_MUX_CH_0)                           \
+ *     X(i2c_inside, mux_sensors, I2C_MUX_CH_1)
+ *
+ * #define BOARD_DEVICES(X)                                                \
+ *     X(dev_outside, i2c_outside, BME280_I2C_ADDRESS_PRIMARY, &bme_init, &bme_outside) \
+ *     X(dev_inside, i2c_inside, BME280_I2C_ADDRESS_PRIMARY, &bme_init, &bme_inside)    \
+ *     X(dev_eeprom, i2c_aux, 0x50, NULL, NULL)
+ *
+ * BOARD_DEFINE(board, BOARD_BUSES, BOARD_MUXES, BOARD_MUX_CHANNELS, BOARD_DEVICES);
+ *
+ * status_t bme_init(void* driver, sdev_t* device) { return bme280_open(driver, device); }
+ *
+ * @note Use `BOARD_NONE` for an empty table
+ * @note Other files can use the structures after `BOARD_DECLARE` with the same tables
+*/
+
+/**
+ * `BOARD_LANE_START(fn, lane)`: start a thread which calls `fn` with `lane` as the argument, evaluates to 0 on success,
+ * for example `pthread_create(&(pthread_t){0}, NULL, fn, lane)`
+ *
+ * @note Not defined by default, lanes are then run as coroutines by `board_init` in the calling
+ * context, without overlapping the bus transactions
+ * @note A lane which fails to start is run in the calling context
+*/
+
+/**
+ * Called by `board_init` while waiting for the lane threads to finish
+*/
+#ifndef BOARD_LANE_WAIT
+#define BOARD_LANE_WAIT()           ((void)0)
+#endif
+
+/**
+ * Driver initialization of a device, called once the device acknowledged its address
+*/
+typedef status_t (*board_dev_init_t)(void* driver, sdev_t* device);
+
+/**
+ * Multiplexer driver open function (for example `tca9544a_i2c_mux_open`)
+*/
+typedef status_t (*board_mux_open_t)(i2c_mux_t* mux, i2c_t* in_bus);
+
+typedef struct board_bus {
+    i2c_t* bus;
+    i2c_ops_t* ops;
+    void* context;
+} board_bus_t;
+
+typedef struct board_mux {
+    i2c_mux_t* mux;
+    i2c_t* in_bus;
+    board_mux_open_t open;
+} board_mux_t;
+
+typedef struct board_mux_channel {
+    i2c_t* bus;
+    i2c_mux_t* mux;
+    i2c_mux_ch_t ch;
+} board_mux_channel_t;
+
+typedef struct board_device {
+    sdev_t* device;
+    i2c_sdev_context_t* context;
+    i2c_t* bus;
+    uint8_t addr;
+    /* Can be NULL if the device only has to be probed */
+    board_dev_init_t init;
+    void* driver;
+} board_device_t;
+
+struct board;
+
+/**
+ * Bring-up of all devices behind one root bus
+*/
+typedef struct board_lane {
+    struct board* board;
+    i2c_t* root;
+    coro_task_t task;
+    /* Bus being brought up, next channel and next device */
+    i2c_t* bus;
+    size_t channel;
+    size_t device;
+} board_lane_t;
+
+/**
+ * @note Members should only be used through API functions starting with board_*
+*/
+typedef struct board {
+    const board_bus_t* buses;
+    size_t n_buses;
+    const board_mux_t* muxes;
+    size_t n_muxes;
+    const board_mux_channel_t* channels;
+    size_t n_channels;
+    const board_device_t* devices;
+    size_t n_devices;
+    /* One lane per bus and one result per device */
+    board_lane_t* lanes;
+    status_t* results;
+    /* Lanes not finished yet */
+    atomic_uint running;
+    coro_sched_t sched;
+} board_t;
+
+/**
+ * Empty table
+*/
+#define BOARD_NONE(X)
+
+#define BOARD_BUS_DECLARE(name, ops, context)               extern i2c_t name;
+#define BOARD_BUS_STORAGE(name, ops, context)               i2c_t name;
+#define BOARD_BUS_ENTRY(name, ops, context)                 { &name, ops, context },
+
+#define BOARD_MUX_DECLARE(name, in_bus, open)               extern i2c_mux_t name;
+#define BOARD_MUX_STORAGE(name, in_bus, open)               i2c_mux_t name;
+#define BOARD_MUX_ENTRY(name, in_bus, open)                 { &name, &in_bus, open },
+
+#define BOARD_CHANNEL_DECLARE(name, mux, ch)                extern i2c_t name;
+#define BOARD_CHANNEL_STORAGE(name, mux, ch)                i2c_t name;
+#define BOARD_CHANNEL_ENTRY(name, mux, ch)                  { &name, &mux, ch },
+
+#define BOARD_DEVICE_DECLARE(name, bus, addr, init, driver) extern sdev_t name;
+#define BOARD_DEVICE_STORAGE(name, bus, addr, init, driver) sdev_t name; static i2c_sdev_context_t name##_context;
+#define BOARD_DEVICE_ENTRY(name, bus, addr, init, driver)   { &name, &name##_context, &bus, addr, init, driver },
+
+/**
+ * Number of entries of a table emitted by `BOARD_DEFINE` (without the terminating entry)
+*/
+#define BOARD_TABLE_LEN(table)      (sizeof(table) / sizeof((table)[0]) - 1)
+
+/**
+ * Declare the structures emitted by `BOARD_DEFINE`
+*/
+#define BOARD_DECLARE(name, bus_table, mux_table, channel_table, device_table)                      \
+    bus_table(BOARD_BUS_DECLARE)                                                                    \
+    mux_table(BOARD_MUX_DECLARE)                                                                    \
+    channel_table(BOARD_CHANNEL_DECLARE)                                                            \
+    device_table(BOARD_DEVICE_DECLARE)                                                              \
+    extern board_t name
+
+/**
+ * Emit the structures and tables of a board described by the X-macro tables
+ *
+ * @note Tables are terminated by a zeroed entry so that they are never empty
+*/
+#define BOARD_DEFINE(name, bus_table, mux_table, channel_table, device_table)                       \
+    bus_table(BOARD_BUS_STORAGE)                                                                    \
+    mux_table(BOARD_MUX_STORAGE)                                                                    \
+    channel_table(BOARD_CHANNEL_STORAGE)                                                            \
+    device_table(BOARD_DEVICE_STORAGE)                                                              \
+    static const board_bus_t name##_buses[] = { bus_table(BOARD_BUS_ENTRY) {0} };                   \
+    static const board_mux_t name##_muxes[] = { mux_table(BOARD_MUX_ENTRY) {0} };                   \
+    static const board_mux_channel_t name##_channels[] = { channel_table(BOARD_CHANNEL_ENTRY) {0} };\
+    static const board_device_t name##_devices[] = { device_table(BOARD_DEVICE_ENTRY) {0} };        \
+    static board_lane_t name##_lanes[BOARD_TABLE_LEN(name##_buses) + 1];                            \
+    static status_t name##_results[BOARD_TABLE_LEN(name##_devices) + 1];                            \
+    board_t name = {                                                                                \
+        .buses = name##_buses, .n_buses = BOARD_TABLE_LEN(name##_buses),                            \
+        .muxes = name##_muxes, .n_muxes = BOARD_TABLE_LEN(name##_muxes),                            \
+        .channels = name##_channels, .n_channels = BOARD_TABLE_LEN(name##_channels),                \
+        .devices = name##_devices, .n_devices = BOARD_TABLE_LEN(name##_devices),                    \
+        .lanes = name##_lanes,                                                                      \
+        .results = name##_results                                                                   \
+    }
+
+/**
+ * Open all buses, multiplexers and devices, then probe and initialize the devices
+ *
+ * @note Blocking function, exits once all lanes are finished
+ *
+ * @return Return value indicates if all devices were brought up successfully.
+*/
+status_t board_init(board_t* board);
+
+/**
+ * Result of the bring-up of a device
+ *
+ * @return `STATUS_ERROR` if the device is not on the board, did not acknowledge or failed to initialize
+*/
+status_t board_get_status(board_t* board, sdev_t* device);
+
+#endif
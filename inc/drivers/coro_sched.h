@@ -0,0 +1,200 @@
+#ifndef DRIVERS_CORO_SCHED_H
+#define DRIVERS_CORO_SCHED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common/coro.h"
+#include "common/mpsc.h"
+#include "common/types.h"
+#include "drivers/swtimer.h"
+
+/**
+ * Scheduler of coroutine tasks
+ *
+ * Tasks are only run when woken: by an asynchronous operation they wait for completing,
+ * by their delay expiring or by yielding. Woken tasks are pushed to a lock-free queue,
+ * so they can be woken from ISRs and the scheduler never scans idle tasks.
+ * A task costs its `coro_task_t`, there are no per-task stacks.
+ *
+ * @example
+ * typedef struct {
+ *     coro_task_t task;
+ *     coro_completion_t done;
+ *     uint8_t data[6];
+ * } reader_t;
+ *
+ * coro_status_t reader_run(coro_task_t* task)
+ * {
+ *     reader_t* r = CORO_TASK_ENTRY(task, reader_t, task);
+ *
+ *     CORO_BEGIN(&task->coro);
+ *     for (;;) {
+ *         CORO_AWAIT_OP(task, &r->done, sdev_read_async(&dev, r->data, 6, coro_completion_callback, &r->done));
+ *         if (coro_completion_status(&r->done) == STATUS_OK)
+ *             process(r->data);
+ *         CORO_DELAY(task, 100);
+ *     }
+ *     CORO_END(&task->coro);
+ * }
+*/
+
+struct coro_sched;
+struct coro_task;
+
+typedef coro_status_t (*coro_fn_t)(struct coro_task* task);
+
+/**
+ * @note Members should only be used through API functions starting with coro_task_*
+*/
+typedef struct coro_task {
+    coro_t coro;
+    coro_fn_t fn;
+    struct coro_sched* sched;
+    mpsc_node_t node;
+    /* Set while the task is in the ready queue */
+    atomic_bool queued;
+    /* Delay timer and its expiry flag */
+    swtimer_t timer;
+    atomic_bool timer_expired;
+    uint8_t done;
+} coro_task_t;
+
+/**
+ * @note Members should only be used through API functions starting with coro_sched_*
+*/
+typedef struct coro_sched {
+    mpsc_t ready;
+    /* Queued at the start of a poll, tasks behind it are left for the next poll */
+    mpsc_node_t marker;
+    uint8_t marker_queued;
+    swtimer_wheel_t* wheel;
+} coro_sched_t;
+
+/**
+ * Completion of an asynchronous operation a task waits for
+*/
+typedef struct coro_completion {
+    coro_task_t* waiter;
+    atomic_bool done;
+    status_t status;
+} coro_completion_t;
+
+/**
+ * Get the structure containing the task
+*/
+#define CORO_TASK_ENTRY(task, type, member)     ((type*)((char*)(task) - offsetof(type, member)))
+
+/**
+ * Return `CORO_WAITING` at least once, then until `cond` is true
+ *
+ * @note Used after starting a wait which may complete right away, its wake runs the task
+ * again on the next poll. A loop of waits which complete right away never blocks the scheduler.
+*/
+#define CORO_TASK_AWAIT(task, cond)                                                 \
+    do {                                                                            \
+        (task)->coro.line = __LINE__;                                               \
+        return CORO_WAITING;                                                        \
+        case __LINE__:                                                              \
+        if (!(cond))                                                                \
+            return CORO_WAITING;                                                    \
+    } while (0)
+
+/**
+ * Start the operation `start`, which signals `completion` when done, and wait for it
+ *
+ * @note If `start` fails the completion is signalled with its status
+*/
+#define CORO_AWAIT_OP(task, completion, start)                                      \
+    do {                                                                            \
+        coro_completion_arm((completion), (task));                                  \
+        status_t coro_start_status_ = (start);                                      \
+        if (coro_start_status_ != STATUS_OK)                                        \
+            coro_completion_signal((completion), coro_start_status_);               \
+        CORO_TASK_AWAIT((task), coro_completion_done(completion));                  \
+    } while (0)
+
+/**
+ * Wait for `ticks` ticks of the scheduler timer wheel
+*/
+#define CORO_DELAY(task, ticks)                                                     \
+    do {                                                                            \
+        coro_task_sleep((task), (ticks));                                           \
+        CORO_TASK_AWAIT((task), coro_task_slept(task));                             \
+    } while (0)
+
+/**
+ * Initialize the scheduler
+ *
+ * @param wheel Timer wheel for delays, can be NULL if `CORO_DELAY` is not used
+ * @note Requires static (persistent) allocation
+*/
+status_t coro_sched_init(coro_sched_t* sched, swtimer_wheel_t* wheel);
+
+/**
+ * Run the tasks woken before the call once each
+ *
+ * Tasks woken while the poll runs, including by themselves or by yielding, are run on the next poll.
+ *
+ * @note Only one context may run the scheduler
+ * @return Number of tasks run
+*/
+size_t coro_sched_poll(coro_sched_t* sched);
+
+/**
+ * Start the task, `fn` is first called from `coro_sched_poll`
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t coro_task_start(coro_sched_t* sched, coro_task_t* task, coro_fn_t fn);
+
+/**
+ * Mark the task to be run on the next poll
+ *
+ * @note Safe to call from any context including ISRs
+*/
+void coro_task_wake(coro_task_t* task);
+
+/**
+ * Returns whether the task has finished
+*/
+uint8_t coro_task_done(coro_task_t* task);
+
+/**
+ * Start the delay timer of the task, used by `CORO_DELAY`
+*/
+void coro_task_sleep(coro_task_t* task, uint32_t ticks);
+
+/**
+ * Returns whether the delay started by `coro_task_sleep` expired
+*/
+uint8_t coro_task_slept(coro_task_t* task);
+
+/**
+ * Prepare the completion for a new operation of `task`
+*/
+void coro_completion_arm(coro_completion_t* completion, coro_task_t* task);
+
+/**
+ * Complete the operation and wake the waiting task
+ *
+ * @note Safe to call from any context including ISRs
+*/
+void coro_completion_signal(coro_completion_t* completion, status_t status);
+
+/**
+ * Completion as `sdev_callback_t`, `arg` is the `coro_completion_t`
+*/
+void coro_completion_callback(status_t status, void* arg);
+
+/**
+ * Returns whether the operation completed
+*/
+uint8_t coro_completion_done(coro_completion_t* completion);
+
+/**
+ * Status the operation completed with
+*/
+status_t coro_completion_status(coro_completion_t* completion);
+
+#endif
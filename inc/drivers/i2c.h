@@ -4,16 +4,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "common/types.h"
+#include "common/pool.h"
 #include "drivers/sdev.h"
 
-/**
- * I2C driver interface
- * 
- * @note Should only be used through API functions starting with i2c_*
-*/
-typedef struct i2c i2c_t;
-typedef struct i2c_sdev_context i2c_sdev_context_t;
-
 /**
  * Hardware (driver) specific implementation of I2C functions
 */
@@ -21,18 +14,185 @@ typedef struct i2c_ops {
     status_t (*write)(void* context, uint8_t addr, uint8_t* data, size_t nbyte);
     status_t (*read)(void* context, uint8_t addr, uint8_t* data, size_t nbyte);
     status_t (*dev_probe)(void* context, uint8_t addr); /** @note Could also be implemented as writing 0 bytes to a device and waiting for ACK */
+    status_t (*set_timeout)(void* context, uint16_t timeout_ms); /** @note Optional, used for per attempt timeouts of the retry policy, 0 restores the default of the driver */
+    status_t (*writev)(void* context, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt); /** @note Optional, all segments in one transaction */
+    status_t (*readv)(void* context, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt); /** @note Optional, all segments in one transaction */
     /** @todo add async_write and async_read with registrable callbacks */
     /** @todo add close and test if needed */
 } i2c_ops_t;
 
 /**
- * @todo Can also implement dynamic allocation I2C open if dyn alloc enabled
- * 
- * i2c_t* i2c_open(i2c_ops_t* ops, void* context);
- * return NULL if failed, else return pointer to allocated structure
+ * Called between two attempts of a transaction, for example a sleep or a busy wait
+ *
+ * @note There is no default, policies with a backoff are rejected unless it is defined
+*/
+#ifdef I2C_RETRY_BACKOFF
+#define I2C_RETRY_HAS_BACKOFF   (1)
+#else
+#define I2C_RETRY_HAS_BACKOFF   (0)
+#define I2C_RETRY_BACKOFF(us)   ((void)(us))
+#endif
+
+/**
+ * Retry policy of I2C transactions
+ *
+ * A failed transaction is attempted again up to `tries` times in total. Before each retry
+ * the caller backs off, starting with `backoff_us` and doubling up to `backoff_max_us`.
+ * With `jitter` each backoff is randomized to between half and all of its value,
+ * so devices failing together do not retry in lockstep.
+ *
+ * A device (or bus) which failed `fail_fast_after` transactions in a row only gets a single
+ * attempt until it responds again, so a dead device does not keep the bus busy with retries.
+ *
+ * @note Can be shared between any number of buses and devices
+*/
+typedef struct i2c_retry_policy {
+    uint8_t tries;
+    uint32_t backoff_us;
+    uint32_t backoff_max_us;
+    uint8_t jitter;
+    /* Timeout of each attempt passed to `set_timeout`, 0 uses the one of the bus policy or the driver */
+    uint16_t timeout_ms;
+    /* 0 to always retry */
+    uint8_t fail_fast_after;
+} i2c_retry_policy_t;
+
+/**
+ * Retry statistics of a bus or a device
+*/
+typedef struct i2c_retry_stats {
+    uint32_t transactions;
+    /* Attempts after the first one */
+    uint32_t retries;
+    /* Transactions which failed after all attempts */
+    uint32_t failures;
+    /* Transactions which got a single attempt because of the failure streak */
+    uint32_t fail_fast;
+    /* Sum of all backoffs */
+    uint32_t backoff_us;
+} i2c_retry_stats_t;
+
+/**
+ * Retry state of a bus or a device
+*/
+typedef struct i2c_retry {
+    const i2c_retry_policy_t* policy;
+    i2c_retry_stats_t stats;
+    uint8_t streak;
+    uint32_t seed;
+} i2c_retry_t;
+
+/**
+ * Timestamp used to measure transaction latency and re-probe intervals of the health
+ * tracker, for example a free running timer count
+ *
+ * @note If not defined, re-probe intervals are counted in operations of the device
+ * (rejected ones included) and latency is not tracked
+*/
+#ifdef I2C_HEALTH_TIMESTAMP
+#define I2C_HEALTH_HAS_TIMESTAMP    (1)
+#else
+#define I2C_HEALTH_HAS_TIMESTAMP    (0)
+#endif
+
+/**
+ * Weight of a new sample in the health moving averages is 1 / 2^shift
+*/
+#ifndef I2C_HEALTH_EWMA_SHIFT
+#define I2C_HEALTH_EWMA_SHIFT   (3)
+#endif
+
+/**
+ * Error rate of a device as unsigned Q0.16 fixed point
+*/
+#define I2C_HEALTH_ERROR_RATE(percent)  ((uint32_t)(percent) * 65536u / 100u)
+
+typedef enum i2c_health_state {
+    I2C_HEALTH_OK,
+    I2C_HEALTH_DEGRADED,
+    /* Operations fail right away, the device is only re-probed periodically */
+    I2C_HEALTH_QUARANTINED
+} i2c_health_state_t;
+
+/**
+ * Thresholds of the device health tracker
+ *
+ * A device whose average error rate reaches `error_rate_quarantine` (or average latency
+ * reaches `latency_quarantine`) is quarantined. Operations on a quarantined device fail
+ * without a bus transaction, except for one `i2c_dev_probe` every `reprobe_interval`,
+ * which releases the device if it acknowledges.
+ *
+ * @note Rates are Q0.16 (see `I2C_HEALTH_ERROR_RATE`), latency and interval are in
+ * `I2C_HEALTH_TIMESTAMP` units (interval in operations without it),
+ * a latency threshold of 0 disables it
+*/
+typedef struct i2c_health_policy {
+    uint32_t error_rate_degraded;
+    uint32_t error_rate_quarantine;
+    uint32_t latency_degraded;
+    uint32_t latency_quarantine;
+    uint32_t reprobe_interval;
+} i2c_health_policy_t;
+
+/**
+ * Health of a device
+*/
+typedef struct i2c_health_stats {
+    i2c_health_state_t state;
+    /* Moving averages, Q0.16 and `I2C_HEALTH_TIMESTAMP` units */
+    uint32_t error_rate;
+    uint32_t latency;
+    /* Times the device was quarantined */
+    uint32_t quarantines;
+    /* Operations failed without a bus transaction because of the quarantine */
+    uint32_t rejected;
+} i2c_health_stats_t;
+
+/**
+ * Health tracker state of a device
+*/
+typedef struct i2c_health {
+    const i2c_health_policy_t* policy;
+    i2c_health_stats_t stats;
+    uint32_t last_probe;
+    /* Operations of the device, the clock when there is no timestamp */
+    uint32_t operations;
+} i2c_health_t;
+
+/**
+ * I2C driver interface
  * 
- * then also add i2c_close to free the memory
+ * @note Should only be used through API functions starting with i2c_*,
+ * members are visible only for static allocation and static binding
 */
+typedef struct i2c {
+    i2c_ops_t* ops;
+    void* context;
+    i2c_retry_t retry;
+    /* Timeout last passed to `set_timeout`, 0 for the default of the driver */
+    uint16_t timeout_ms;
+} i2c_t;
+
+/**
+ * Additional data for serial devices connected to an I2C
+*/
+typedef struct i2c_sdev_context {
+    i2c_t* bus;
+    uint8_t addr;
+    /* Policy NULL uses the policy of the bus */
+    i2c_retry_t retry;
+    /* Policy NULL only tracks the health */
+    i2c_health_t health;
+} i2c_sdev_context_t;
+
+typedef enum i2c_op {
+    I2C_OP_WRITE,
+    I2C_OP_READ,
+    I2C_OP_DEV_PROBE,
+    /* Vectored, see `i2c_transfer` */
+    I2C_OP_WRITEV,
+    I2C_OP_READV
+} i2c_op_t;
 
 /**
  * Create and initialize an I2C structure
@@ -41,6 +201,55 @@ typedef struct i2c_ops {
 */
 status_t i2c_open(i2c_t* i2c, i2c_ops_t* ops, void* context);
 
+#ifdef DRIVERS_USE_POOL
+/**
+ * Number of I2C structures available for dynamic opening
+*/
+#ifndef I2C_POOL_SIZE
+#define I2C_POOL_SIZE       (4)
+#endif
+
+/**
+ * Number of I2C serial device contexts available for dynamic opening
+*/
+#ifndef I2C_SDEV_POOL_SIZE
+#define I2C_SDEV_POOL_SIZE  (8)
+#endif
+
+/**
+ * Allocate an I2C structure from the pool and initialize it
+ * 
+ * @return NULL if the pool is exhausted
+*/
+i2c_t* i2c_open_dynamic(i2c_ops_t* ops, void* context);
+
+/**
+ * Return a dynamically opened I2C structure to the pool
+ * 
+ * @note Devices opened on this I2C should be closed first
+*/
+status_t i2c_close(i2c_t* i2c);
+
+/**
+ * Open a serial device connected to this I2C, allocating the device and its context from the pools
+ * 
+ * @note Closing the device with `sdev_close` returns both to the pools
+ * 
+ * @return NULL if a pool is exhausted
+*/
+sdev_t* i2c_sdev_open_dynamic(i2c_t* i2c, uint8_t addr);
+
+/**
+ * Get usage statistics of the I2C pool
+*/
+void i2c_pool_get_stats(pool_stats_t* stats);
+
+/**
+ * Get usage statistics of the I2C serial device context pool
+*/
+void i2c_sdev_pool_get_stats(pool_stats_t* stats);
+#endif
+
 /**
  * Write a sequence of bytes to an I2C slave
  * 
@@ -59,14 +268,102 @@ status_t i2c_write(i2c_t* i2c, uint8_t addr, uint8_t* data, size_t nbyte);
 */
 status_t i2c_read(i2c_t* i2c, uint8_t addr, uint8_t* data, size_t nbyte);
 
+/**
+ * Write a sequence of segments to an I2C slave in a single transaction
+ *
+ * @note Blocking function, exits once the bus transaction is complete.
+ * @note Buses without a `writev` handler gather the segments, up to `SDEV_IOV_BOUNCE_LEN` bytes
+ *
+ * @return Return value indicates if the transaction was successful.
+*/
+status_t i2c_writev(i2c_t* i2c, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt);
+
+/**
+ * Read a sequence of bytes from an I2C slave into multiple segments in a single transaction
+ *
+ * @note Blocking function, exits once the bus transaction is complete.
+ * @note Buses without a `readv` handler read into a buffer, up to `SDEV_IOV_BOUNCE_LEN` bytes
+ *
+ * @return Return value indicates if the transaction was successful.
+*/
+status_t i2c_readv(i2c_t* i2c, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt);
+
 /**
  * Call the device with the given address and expect acknowledge signal,
- * for a given number of tries. Stop after first success.
+ * for the number of tries of the retry policy. Stop after first success.
  * 
  * @return Return values indicates a successful acknowledge.
 */
 status_t i2c_dev_probe(i2c_t* i2c, uint8_t addr);
 
+/**
+ * Call the device with the given address once, without the retry policy and the statistics
+ *
+ * @note Used for polls where a missing acknowledge is expected, like the end of an EEPROM write cycle
+ *
+ * @return Return values indicates a successful acknowledge.
+*/
+status_t i2c_dev_poll(i2c_t* i2c, uint8_t addr);
+
+/**
+ * Execute a transaction with the retry policy of `device`, or of the bus if it has none
+ *
+ * @note Used by `i2c_write`, `i2c_read`, `i2c_dev_probe` and the serial device handlers,
+ * statistics are counted for both the device and the bus
+ * @note `device` can be NULL
+ * @note For `I2C_OP_WRITEV` and `I2C_OP_READV`, `data` is the `sdev_iovec_t` array
+ * and `nbyte` the number of segments
+*/
+status_t i2c_transfer(i2c_t* i2c, i2c_retry_t* device, i2c_op_t op, uint8_t addr, uint8_t* data, size_t nbyte);
+
+/**
+ * Set the retry policy of the bus, NULL to disable retries
+ *
+ * @note When buses are stacked (multiplexer channels, queued buses) set the policy on the one
+ * used by the callers, so other transactions can run on the bus between the attempts
+ *
+ * @return `STATUS_ERROR` if the policy backs off and `I2C_RETRY_BACKOFF` is not defined
+*/
+status_t i2c_set_retry_policy(i2c_t* i2c, const i2c_retry_policy_t* policy);
+
+/**
+ * Get the retry statistics of the bus
+*/
+void i2c_get_retry_stats(i2c_t* i2c, i2c_retry_stats_t* stats);
+
+/**
+ * Set the retry policy of a device, NULL to use the policy of the bus
+ *
+ * @return `STATUS_ERROR` if the policy backs off and `I2C_RETRY_BACKOFF` is not defined
+*/
+status_t i2c_sdev_set_retry_policy(i2c_sdev_context_t* context, const i2c_retry_policy_t* policy);
+
+/**
+ * Get the retry statistics of a device
+*/
+void i2c_sdev_get_retry_stats(i2c_sdev_context_t* context, i2c_retry_stats_t* stats);
+
+/**
+ * Execute a transaction of a serial device, with its retry policy and health tracking
+ *
+ * @note Used by the serial device handlers
+ *
+ * @return `STATUS_ERROR` without a bus transaction if the device is quarantined
+*/
+status_t i2c_sdev_transfer(i2c_sdev_context_t* context, i2c_op_t op, uint8_t* data, size_t nbyte);
+
+/**
+ * Set the health thresholds of a device, NULL to only track the health without quarantine
+*/
+void i2c_sdev_set_health_policy(i2c_sdev_context_t* context, const i2c_health_policy_t* policy);
+
+/**
+ * Get the health of a device
+ *
+ * @note Does not access the bus
+*/
+void i2c_sdev_get_health(i2c_sdev_context_t* context, i2c_health_stats_t* stats);
+
 /**
  * Open a serial device connected to this I2C
  * 
@@ -74,4 +371,40 @@ status_t i2c_dev_probe(i2c_t* i2c, uint8_t addr);
 */
 status_t i2c_sdev_open(i2c_t* i2c, sdev_t* device, i2c_sdev_context_t* context, uint8_t addr);
 
+/**
+ * Serial device write handler for a device connected to an I2C
+ * 
+ * @note Defined here so it can be bound statically as `SDEV_BIND_WRITE`
+*/
+static inline status_t i2c_sdev_write(void* context, uint8_t* data, size_t len)
+{
+    i2c_sdev_context_t* params = (i2c_sdev_context_t*)context;
+
+    return i2c_sdev_transfer(params, I2C_OP_WRITE, data, len);
+}
+
+/**
+ * Serial device read handler for a device connected to an I2C
+ * 
+ * @note Defined here so it can be bound statically as `SDEV_BIND_READ`
+*/
+static inline status_t i2c_sdev_read(void* context, uint8_t* data, size_t len)
+{
+    i2c_sdev_context_t* params = (i2c_sdev_context_t*)context;
+
+    return i2c_sdev_transfer(params, I2C_OP_READ, data, len);
+}
+
+/**
+ * Serial device test handler for a device connected to an I2C
+ * 
+ * @note Defined here so it can be bound statically as `SDEV_BIND_TEST`
+*/
+static inline status_t i2c_sdev_test(void* context)
+{
+    i2c_sdev_context_t* params = (i2c_sdev_context_t*)context;
+
+    return i2c_sdev_transfer(params, I2C_OP_DEV_PROBE, NULL, 0);
+}
+
 #endif
\ No newline at end of file
@@ -19,15 +19,35 @@ typedef enum i2c_mux_ch {
     I2C_MUX_CH_NONE
 } i2c_mux_ch_t;
 
-/**
- * I2C multiplexer driver interface
-*/
-typedef struct i2c_mux i2c_mux_t;
-
 typedef struct i2c_mux_ops {
     status_t (*ch_select)(void* context, i2c_mux_ch_t ch);
 } i2c_mux_ops_t;
 
+struct i2c_mux;
+
+/**
+ * Context of an I2C opened on an output channel (see `i2c_mux_ch_as_bus`)
+*/
+typedef struct i2c_mux_bus_context {
+    struct i2c_mux* mux;
+    i2c_mux_ch_t ch;
+} i2c_mux_bus_context_t;
+
+/**
+ * I2C multiplexer driver interface
+ *
+ * @note Should only be used through API functions starting with i2c_mux_*,
+ * members are visible only for static allocation
+*/
+typedef struct i2c_mux {
+    i2c_mux_ch_t selected;
+    i2c_t* in_bus;
+    uint8_t n_out_bus;
+    i2c_mux_ops_t* ops;
+    void* context;
+    i2c_mux_bus_context_t out_bus[I2C_MUX_CH_NONE];
+} i2c_mux_t;
+
 /**
  * Create and initialize I2C multiplexer structure
  * 
@@ -35,6 +55,32 @@ typedef struct i2c_mux_ops {
 */
 status_t i2c_mux_open(i2c_mux_t* mux, i2c_t* in, uint8_t nout, i2c_mux_ops_t* ops, void* context);
 
+#ifdef DRIVERS_USE_POOL
+/**
+ * Number of I2C multiplexer structures available for dynamic opening
+*/
+#ifndef I2C_MUX_POOL_SIZE
+#define I2C_MUX_POOL_SIZE   (2)
+#endif
+
+/**
+ * Allocate an I2C multiplexer structure from the pool and initialize it
+ * 
+ * @return NULL if the pool is exhausted or initialization failed
+*/
+i2c_mux_t* i2c_mux_open_dynamic(i2c_t* in, uint8_t nout, i2c_mux_ops_t* ops, void* context);
+
+/**
+ * Return a dynamically opened I2C multiplexer structure to the pool
+*/
+status_t i2c_mux_close(i2c_mux_t* mux);
+
+/**
+ * Get usage statistics of the I2C multiplexer pool
+*/
+void i2c_mux_pool_get_stats(pool_stats_t* stats);
+#endif
+
 /**
  * Select output channel for the mux
 */
@@ -47,6 +93,11 @@ i2c_t* i2c_mux_get_in_bus(i2c_mux_t* mux);
 
 /**
  * Open an I2C corresponding to the given output channel
+ *
+ * Every transaction on `bus` first selects the channel (if not already selected)
+ * and is then executed on the input bus.
+ *
+ * @note Requires static (persistent) allocation
 */
 status_t i2c_mux_ch_as_bus(i2c_mux_t* mux, i2c_t* bus, i2c_mux_ch_t ch);
 
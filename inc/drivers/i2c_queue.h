@@ -0,0 +1,152 @@
+#ifndef DRIVERS_I2C_QUEUE_H
+#define DRIVERS_I2C_QUEUE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "common/types.h"
+#include "common/mpsc.h"
+#include "drivers/i2c.h"
+
+/**
+ * Called by a thread while waiting for its queued transaction to complete
+ *
+ * @note Can be defined as a yield (`sched_yield()`, `taskYIELD()`) to avoid spinning
+*/
+#ifndef I2C_QUEUE_WAIT
+#define I2C_QUEUE_WAIT()    ((void)0)
+#endif
+
+/**
+ * Number of priority classes, 0 is the highest
+*/
+#ifndef I2C_QUEUE_PRIORITIES
+#define I2C_QUEUE_PRIORITIES    (2)
+#endif
+
+/**
+ * Timestamp stored when a transaction is submitted, waits are measured in its units,
+ * for example a free running timer count
+*/
+#ifndef I2C_QUEUE_TIMESTAMP
+#define I2C_QUEUE_TIMESTAMP()   (0u)
+#endif
+
+/**
+ * Statistics of one priority class
+*/
+typedef struct i2c_queue_stats {
+    uint32_t transactions;
+    /* Bus transactions of split reads */
+    uint32_t chunks;
+    /* Longest time from submission to the start of the transaction */
+    uint32_t max_wait;
+    /* Longest time from submission to completion */
+    uint32_t max_latency;
+} i2c_queue_stats_t;
+
+struct i2c_queue;
+struct i2c_queue_req;
+
+/**
+ * Transactions of one priority
+ *
+ * @note Members should only be used through API functions starting with i2c_queue_*
+*/
+typedef struct i2c_queue_class {
+    struct i2c_queue* queue;
+    mpsc_t pending;
+    /* Split read which still has chunks left */
+    struct i2c_queue_req* current;
+    i2c_queue_stats_t stats;
+} i2c_queue_class_t;
+
+/**
+ * Queued bus which splits long reads into chunks, see `i2c_queue_bus_open_chunked`
+ *
+ * @note Members should only be used through API functions starting with i2c_queue_*
+*/
+typedef struct i2c_queue_chunked {
+    i2c_queue_class_t* cls;
+    size_t chunk;
+    /* Chunks get a single attempt, counted here and on the bus */
+    i2c_retry_t retry;
+} i2c_queue_chunked_t;
+
+/**
+ * Shared I2C bus with a lock-free submission queue
+ *
+ * Transactions submitted from any thread are pushed to a MPSC queue and executed
+ * on the underlying bus by a single owner. By default the owner is whichever waiting
+ * caller claims the queue first (it executes all pending transactions, not only its own).
+ * If `I2C_QUEUE_DEDICATED_OWNER` is defined, callers only wait and a dedicated
+ * thread is expected to call `i2c_queue_process` in a loop.
+ *
+ * Each priority class has its own queue. The owner always executes the oldest transaction
+ * of the highest priority class which has one, so a transaction waits for at most one
+ * lower priority transaction (or chunk) already on the bus. Long reads of a device can be
+ * split into chunks (see `i2c_queue_bus_open_chunked`), which bounds that wait.
+ *
+ * @note Members should only be used through API functions starting with i2c_queue_*
+*/
+typedef struct i2c_queue {
+    i2c_t* bus;
+    i2c_queue_class_t classes[I2C_QUEUE_PRIORITIES];
+    atomic_flag owner;
+} i2c_queue_t;
+
+/**
+ * Create and initialize a queue which executes transactions on `bus`
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t i2c_queue_open(i2c_queue_t* queue, i2c_t* bus);
+
+/**
+ * Open an I2C which submits all transactions through the queue with the lowest priority
+ *
+ * @note Any number of threads can use the same `shared` bus,
+ * or each can open its own one on the same queue
+*/
+status_t i2c_queue_bus_open(i2c_queue_t* queue, i2c_t* shared);
+
+/**
+ * Open an I2C which submits all transactions through the queue with the given priority
+*/
+status_t i2c_queue_bus_open_priority(i2c_queue_t* queue, i2c_t* shared, uint8_t priority);
+
+/**
+ * Open an I2C which submits all transactions through the queue with the given priority
+ * and splits its reads into bus transactions of at most `chunk` bytes
+ *
+ * @note Each chunk is a separate transaction, so open it only for devices which continue
+ * reading where the previous transaction stopped (for example EEPROM sequential reads)
+ * and keep the other devices of the class on a bus from `i2c_queue_bus_open_priority`
+ * @note Writes are never split since every write transaction starts with the device register address
+ * @note A chunk is never retried, the device already moved past the bytes of a failed chunk.
+ * A failed chunk fails the whole read, which the caller restarts from the register address.
+ * @note Requires static (persistent) allocation of `chunked`
+*/
+status_t i2c_queue_bus_open_chunked(i2c_queue_t* queue, i2c_t* shared, uint8_t priority,
+    i2c_queue_chunked_t* chunked, size_t chunk);
+
+/**
+ * Execute all pending transactions
+ *
+ * @note Non-blocking if another context currently owns the queue
+ *
+ * @return `STATUS_OK` if the queue was claimed and drained, `STATUS_ERROR` if it is owned by another context
+*/
+status_t i2c_queue_process(i2c_queue_t* queue);
+
+/**
+ * Get the statistics of a priority class
+*/
+status_t i2c_queue_get_stats(i2c_queue_t* queue, uint8_t priority, i2c_queue_stats_t* stats);
+
+/**
+ * Clear the statistics of all priority classes
+*/
+void i2c_queue_reset_stats(i2c_queue_t* queue);
+
+#endif
@@ -4,14 +4,36 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "common/types.h"
+#include "common/pool.h"
 
 /**
- * Serial device interface
+ * Maximum total length of a vectored operation emulated on top of `read`/`write`
+ * 
+ * @note Emulation gathers all segments into a stack buffer so that they are
+ * transferred in a single transaction
+*/
+#ifndef SDEV_IOV_BOUNCE_LEN
+#define SDEV_IOV_BOUNCE_LEN     (64)
+#endif
+
+/**
+ * Segment of a vectored (scatter-gather) operation
 */
-typedef struct sdev sdev_t;
+typedef struct sdev_iovec {
+    uint8_t* data;
+    size_t nbyte;
+} sdev_iovec_t;
+
+/**
+ * Completion callback for asynchronous operations
+*/
+typedef void (*sdev_callback_t)(status_t status, void* arg);
 
 /**
  * Serial device operation handlers
+ * 
+ * @note Vectored and async handlers are optional, if NULL they are
+ * emulated using the blocking `read` and `write` handlers
 */
 typedef struct sdev_ops {
     status_t (*test)(void* context);
@@ -19,9 +41,23 @@ typedef struct sdev_ops {
     status_t (*read)(void* context, uint8_t* data, size_t nbyte);
     status_t (*ioctl)(void* context, int ctl_type, void* arg);
     status_t (*close)(void* context);
-    /** @todo add async */
+    status_t (*writev)(void* context, const sdev_iovec_t* iov, size_t iovcnt);
+    status_t (*readv)(void* context, const sdev_iovec_t* iov, size_t iovcnt);
+    status_t (*write_async)(void* context, uint8_t* data, size_t nbyte, sdev_callback_t callback, void* arg);
+    status_t (*read_async)(void* context, uint8_t* data, size_t nbyte, sdev_callback_t callback, void* arg);
 } sdev_ops_t;
 
+/**
+ * Serial device interface
+ * 
+ * @note Should only be used through API functions starting with sdev_*,
+ * members are visible only for static allocation and static binding
+*/
+typedef struct sdev {
+    sdev_ops_t* ops;
+    void* context;
+} sdev_t;
+
 /**
  * Create and initialize a serial device structure
  * 
@@ -31,6 +67,29 @@ typedef struct sdev_ops {
 */
 status_t sdev_open(sdev_t* sdev, sdev_ops_t* ops, void* context);
 
+#ifdef DRIVERS_USE_POOL
+/**
+ * Number of serial device structures available for dynamic opening
+*/
+#ifndef SDEV_POOL_SIZE
+#define SDEV_POOL_SIZE      (8)
+#endif
+
+/**
+ * Allocate a serial device structure from the pool and initialize it
+ * 
+ * @note Closing the device with `sdev_close` returns the structure to the pool
+ * 
+ * @return NULL if the pool is exhausted
+*/
+sdev_t* sdev_open_dynamic(sdev_ops_t* ops, void* context);
+
+/**
+ * Get usage statistics of the serial device pool
+*/
+void sdev_pool_get_stats(pool_stats_t* stats);
+#endif
+
 /**
  * Test if the device is responding
  * 
@@ -58,6 +117,54 @@ status_t sdev_write(sdev_t* sdev, uint8_t* data, size_t nbyte);
 */
 status_t sdev_read(sdev_t* sdev, uint8_t* data, size_t nbyte);
 
+/**
+ * Write a sequence of segments to a serial device as a single transaction
+ * 
+ * @note Blocking function, exits once the bus transaction is complete.
+ * 
+ * @note If the device has no `writev` handler, the total length is limited to `SDEV_IOV_BOUNCE_LEN`
+ * 
+ * @return Return value indicates if the transaction was successful.
+*/
+status_t sdev_writev(sdev_t* sdev, const sdev_iovec_t* iov, size_t iovcnt);
+
+/**
+ * Read a sequence of bytes from a serial device into multiple segments as a single transaction
+ * 
+ * @note Blocking function, exits once the bus transaction is complete.
+ * 
+ * @note If the device has no `readv` handler, the total length is limited to `SDEV_IOV_BOUNCE_LEN`
+ * 
+ * @return Return value indicates if the transaction was successful.
+*/
+status_t sdev_readv(sdev_t* sdev, const sdev_iovec_t* iov, size_t iovcnt);
+
+/**
+ * Start writing a sequence of bytes to a serial device
+ * 
+ * @note `data` should not be modified until `callback` is called
+ * 
+ * @note If the device has no `write_async` handler, the write is blocking
+ * and `callback` is called before this function returns, in the calling context:
+ * a callback which starts the next operation runs it recursively
+ * 
+ * @return Return value indicates if the operation was started, if it was
+ * `callback` is called exactly once with the result of the transaction
+*/
+status_t sdev_write_async(sdev_t* sdev, uint8_t* data, size_t nbyte, sdev_callback_t callback, void* arg);
+
+/**
+ * Start reading a sequence of bytes from a serial device
+ * 
+ * @note If the device has no `read_async` handler, the read is blocking
+ * and `callback` is called before this function returns, in the calling context:
+ * a callback which starts the next operation runs it recursively
+ * 
+ * @return Return value indicates if the operation was started, if it was
+ * `callback` is called exactly once with the result of the transaction
+*/
+status_t sdev_read_async(sdev_t* sdev, uint8_t* data, size_t nbyte, sdev_callback_t callback, void* arg);
+
 /**
  * Serial device IO control
 */
@@ -65,7 +172,71 @@ status_t sdev_ioctl(sdev_t* sdev, int ctl_type, void* arg);
 
 /**
  * Close the device and free all allocated resources
+ * 
+ * @note If bound statically, only the close handler is called and
+ * the structure is not returned to the pool
 */
 status_t sdev_close(sdev_t* sdev);
 
+/**
+ * Static (compile-time) driver binding
+ * 
+ * If `DRIVERS_BINDING_HEADER` is defined, that header is included here and can bind
+ * handlers of the sdev and i2c interfaces to concrete functions by defining any of:
+ * `SDEV_BIND_TEST`, `SDEV_BIND_WRITE`, `SDEV_BIND_READ`, `SDEV_BIND_IOCTL`, `SDEV_BIND_CLOSE`,
+ * `I2C_BIND_WRITE`, `I2C_BIND_READ`, `I2C_BIND_DEV_PROBE`
+ * 
+ * A bound sdev API function becomes a macro calling the handler directly with the instance
+ * context. Bound I2C handlers replace the calls through the bus `ops` table in i2c.c, which
+ * then has to be built with the binding header too, transactions keep the retry policy and
+ * health tracking. Unbound functions still go through the `ops` table.
+ * 
+ * @note Binding applies to every instance of the interface, so it should only be used
+ * when all instances in the build share the same implementation
+ * 
+ * @note Bound API functions can not be used as function pointers
+ * 
+ * @note The binding header should define the macros before including any driver headers
+ * 
+ * @example board_binding.h for a board with only I2C devices on one STM32 I2C peripheral
+ * 
+ *  #define SDEV_BIND_WRITE     i2c_sdev_write
+ *  #define SDEV_BIND_READ      i2c_sdev_read
+ *  #define SDEV_BIND_TEST      i2c_sdev_test
+ *  #define I2C_BIND_WRITE      board_i2c_write
+ *  #define I2C_BIND_READ       board_i2c_read
+ *  #define I2C_BIND_DEV_PROBE  board_i2c_dev_probe
+ * 
+ *  static inline status_t board_i2c_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+ *  {
+ *      return HAL_I2C_Master_Transmit(context, addr << 1, data, nbyte, 100) == HAL_OK ? STATUS_OK : STATUS_ERROR;
+ *  }
+ *  ...
+ * 
+ *  #include "drivers/i2c.h"
+*/
+#ifdef DRIVERS_BINDING_HEADER
+#include DRIVERS_BINDING_HEADER
+#endif
+
+#ifdef SDEV_BIND_TEST
+#define sdev_test(sdev)                     SDEV_BIND_TEST((sdev)->context)
+#endif
+
+#ifdef SDEV_BIND_WRITE
+#define sdev_write(sdev, data, nbyte)       SDEV_BIND_WRITE((sdev)->context, data, nbyte)
+#endif
+
+#ifdef SDEV_BIND_READ
+#define sdev_read(sdev, data, nbyte)        SDEV_BIND_READ((sdev)->context, data, nbyte)
+#endif
+
+#ifdef SDEV_BIND_IOCTL
+#define sdev_ioctl(sdev, ctl_type, arg)     SDEV_BIND_IOCTL((sdev)->context, ctl_type, arg)
+#endif
+
+#ifdef SDEV_BIND_CLOSE
+#define sdev_close(sdev)                    SDEV_BIND_CLOSE((sdev)->context)
+#endif
+
 #endif
\ No newline at end of file
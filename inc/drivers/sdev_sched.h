@@ -0,0 +1,117 @@
+#ifndef DRIVERS_SDEV_SCHED_H
+#define DRIVERS_SDEV_SCHED_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "common/types.h"
+#include "drivers/sdev.h"
+
+/**
+ * Periodic device read, performs the actual bus transactions
+*/
+typedef status_t (*sdev_sched_read_t)(sdev_t* device, void* arg);
+
+/**
+ * Registration of a periodically polled device
+ *
+ * @note Members should only be used through API functions starting with sdev_sched_*
+*/
+typedef struct sdev_sched_entry {
+    sdev_t* device;
+    /* Key of the bus the device is on, reads are planned per bus */
+    const void* bus;
+    uint32_t period;
+    sdev_sched_read_t read;
+    void* arg;
+    /* Tick of the next release */
+    uint32_t next_release;
+    /* Release and deadline of the pending read */
+    uint32_t release;
+    uint32_t deadline;
+    uint8_t pending;
+    struct sdev_sched_entry* next;
+    /* Statistics */
+    uint32_t runs;
+    uint32_t missed;
+    uint32_t errors;
+    uint32_t last_jitter;
+    uint32_t max_jitter;
+} sdev_sched_entry_t;
+
+/**
+ * Statistics of a registration
+*/
+typedef struct sdev_sched_stats {
+    /* Number of executed reads */
+    uint32_t runs;
+    /* Releases which were skipped or completed after the deadline */
+    uint32_t missed;
+    /* Reads which returned an error */
+    uint32_t errors;
+    /* Delay from release to start of the read, in ticks */
+    uint32_t last_jitter;
+    uint32_t max_jitter;
+} sdev_sched_stats_t;
+
+/**
+ * Deadline based polling scheduler for serial devices
+ *
+ * Time is counted in ticks by `sdev_sched_tick`, which should be called from
+ * `timer_period_isr` (on the PC target the timer is driven by a clock thread).
+ * `sdev_sched_run` executes due reads from the main context: each bus gets its reads in
+ * earliest-deadline-first order and buses are interleaved, so a busy bus does not delay
+ * urgent reads on another one.
+ *
+ * @note Members should only be used through API functions starting with sdev_sched_*
+*/
+typedef struct sdev_sched {
+    sdev_sched_entry_t* entries;
+    atomic_uint_fast32_t now;
+} sdev_sched_t;
+
+/**
+ * Create and initialize a scheduler
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t sdev_sched_open(sdev_sched_t* sched);
+
+/**
+ * Register a device read every `period` ticks
+ *
+ * @note Reads are phase aligned to multiples of `period`, so reads of harmonic periods fall due
+ * on the same tick and are executed in one pass; registrations with the same device, read and arg
+ * which fall due together are merged into one read
+ * @note Requires static (persistent) allocation of the entry
+*/
+status_t sdev_sched_register(sdev_sched_t* sched, sdev_sched_entry_t* entry, sdev_t* device,
+    const void* bus, uint32_t period, sdev_sched_read_t read, void* arg);
+
+/**
+ * Remove the registration
+*/
+status_t sdev_sched_unregister(sdev_sched_t* sched, sdev_sched_entry_t* entry);
+
+/**
+ * Advance the scheduler time by one tick
+ *
+ * @note Safe to call from ISR context, only increments the tick counter
+*/
+void sdev_sched_tick(sdev_sched_t* sched);
+
+/**
+ * Execute all reads which are due
+ *
+ * @note Blocking function, should be called from the main context
+ *
+ * @return Return value indicates if all executed reads were successful.
+*/
+status_t sdev_sched_run(sdev_sched_t* sched);
+
+/**
+ * Get statistics of the registration
+*/
+void sdev_sched_get_stats(sdev_sched_entry_t* entry, sdev_sched_stats_t* stats);
+
+#endif
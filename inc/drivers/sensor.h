@@ -0,0 +1,166 @@
+#ifndef DRIVERS_SENSOR_H
+#define DRIVERS_SENSOR_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "common/types.h"
+#include "common/seqlock.h"
+#include "drivers/i2c_mux.h"
+
+/**
+ * Sensor device operation handlers
+*/
+typedef struct sensor_ops {
+    /* Fetch all channels of the device (in one burst if possible) and convert them */
+    status_t (*sample)(void* context);
+} sensor_ops_t;
+
+/**
+ * Generic sampled sensor device
+ *
+ * Typed interfaces below return values converted by the last `sample` call.
+ *
+ * @note Should only be used through API functions starting with sensor_*,
+ * members are visible only for static allocation
+*/
+typedef struct sensor {
+    sensor_ops_t* ops;
+    void* context;
+    /* Sampling group, sensors on the same bus and mux channel are sampled back to back */
+    const void* bus;
+    i2c_mux_ch_t channel;
+    /* Converted values published by the driver after each sample, NULL if not published */
+    snapshot_t* snapshot;
+} sensor_t;
+
+/**
+ * Temperature in hundredths of a degree Celsius
+*/
+typedef struct sensor_temperature {
+    sensor_t* sensor;
+    status_t (*get)(void* context, int32_t* centi_celsius);
+} sensor_temperature_t;
+
+/**
+ * Pressure in Pascal as unsigned Q24.8 fixed point
+*/
+typedef struct sensor_pressure {
+    sensor_t* sensor;
+    status_t (*get)(void* context, uint32_t* pascal_q8);
+} sensor_pressure_t;
+
+/**
+ * Relative humidity in percent as unsigned Q22.10 fixed point
+*/
+typedef struct sensor_humidity {
+    sensor_t* sensor;
+    status_t (*get)(void* context, uint32_t* percent_q10);
+} sensor_humidity_t;
+
+/**
+ * Create and initialize a sensor structure
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t sensor_open(sensor_t* sensor, sensor_ops_t* ops, void* context);
+
+/**
+ * Set the sampling group of the sensor
+ *
+ * @note `bus` is only used as a key, usually the root `i2c_t*` of the sensor
+ * @note Use `I2C_MUX_CH_NONE` if the sensor is not behind a multiplexer
+*/
+void sensor_set_group(sensor_t* sensor, const void* bus, i2c_mux_ch_t channel);
+
+/**
+ * Set the snapshot the driver publishes its converted values to
+ *
+ * @note Called by drivers, the layout of the values is driver specific
+*/
+void sensor_set_snapshot(sensor_t* sensor, snapshot_t* snapshot);
+
+/**
+ * Get the snapshot of the converted values, which can be read from any context
+ * without locking (see common/seqlock.h)
+ *
+ * @return NULL if the driver does not publish its values
+*/
+snapshot_t* sensor_get_snapshot(sensor_t* sensor);
+
+/**
+ * Fetch and convert all channels of the sensor
+ *
+ * @note Blocking function, exits once the bus transactions are complete.
+*/
+status_t sensor_sample(sensor_t* sensor);
+
+/**
+ * Get the temperature from the last sample
+*/
+status_t sensor_temperature_get(sensor_temperature_t* temp, int32_t* centi_celsius);
+
+/**
+ * Sample the sensor and get the temperature
+*/
+status_t sensor_temperature_read(sensor_temperature_t* temp, int32_t* centi_celsius);
+
+/**
+ * Get the pressure from the last sample
+*/
+status_t sensor_pressure_get(sensor_pressure_t* press, uint32_t* pascal_q8);
+
+/**
+ * Sample the sensor and get the pressure
+*/
+status_t sensor_pressure_read(sensor_pressure_t* press, uint32_t* pascal_q8);
+
+/**
+ * Get the humidity from the last sample
+*/
+status_t sensor_humidity_get(sensor_humidity_t* hum, uint32_t* percent_q10);
+
+/**
+ * Sample the sensor and get the humidity
+*/
+status_t sensor_humidity_read(sensor_humidity_t* hum, uint32_t* percent_q10);
+
+/**
+ * Batched sampling of many sensors
+ *
+ * Sensors are kept ordered by sampling group, so each bus and each mux
+ * channel is visited once per cycle and every device is sampled with its own burst.
+ *
+ * @note Members should only be used through API functions starting with sensor_sampler_*
+*/
+typedef struct sensor_sampler {
+    sensor_t** sensors;
+    size_t capacity;
+    size_t count;
+    /* Failed samples since opening */
+    uint32_t errors;
+} sensor_sampler_t;
+
+/**
+ * Create and initialize a sampler with user allocated storage for `capacity` sensors
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t sensor_sampler_open(sensor_sampler_t* sampler, sensor_t** storage, size_t capacity);
+
+/**
+ * Add a sensor to the sampling cycle
+ *
+ * @note Group of the sensor should be set before adding it
+*/
+status_t sensor_sampler_add(sensor_sampler_t* sampler, sensor_t* sensor);
+
+/**
+ * Sample all sensors once
+ *
+ * @note Blocking function, failed sensors are skipped
+ *
+ * @return Return value indicates if all sensors were sampled successfully.
+*/
+status_t sensor_sampler_run(sensor_sampler_t* sampler);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef DRIVERS_SENSORS_BME280_H
+#define DRIVERS_SENSORS_BME280_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "common/types.h"
+#include "common/seqlock.h"
+#include "drivers/sdev.h"
+#include "drivers/sensor.h"
+
+#define BME280_I2C_ADDRESS_PRIMARY      (0x76)
+#define BME280_I2C_ADDRESS_SECONDARY    (0x77)
+
+/**
+ * Factory calibration parameters
+*/
+typedef struct bme280_calib {
+    uint16_t dig_t1;
+    int16_t dig_t2;
+    int16_t dig_t3;
+    uint16_t dig_p1;
+    int16_t dig_p2;
+    int16_t dig_p3;
+    int16_t dig_p4;
+    int16_t dig_p5;
+    int16_t dig_p6;
+    int16_t dig_p7;
+    int16_t dig_p8;
+    int16_t dig_p9;
+    uint8_t dig_h1;
+    int16_t dig_h2;
+    uint8_t dig_h3;
+    int16_t dig_h4;
+    int16_t dig_h5;
+    int8_t dig_h6;
+} bme280_calib_t;
+
+/**
+ * Converted values of one sample, published to the sensor snapshot
+*/
+typedef struct bme280_reading {
+    int32_t temperature;
+    uint32_t pressure;
+    uint32_t humidity;
+} bme280_reading_t;
+
+/**
+ * BME280 temperature, pressure and humidity sensor
+ *
+ * @note Members should only be used through API functions
+*/
+typedef struct bme280 {
+    sdev_t* device;
+    sensor_t sensor;
+    bme280_calib_t calib;
+    /* Converted values of the last sample, published through `snapshot` */
+    bme280_reading_t reading;
+    snapshot_t snapshot;
+} bme280_t;
+
+/**
+ * Check the chip id, read the calibration and start continuous (normal mode) measurement
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t bme280_open(bme280_t* bme, sdev_t* device);
+
+/**
+ * Get the generic sensor used for sampling this device
+*/
+sensor_t* bme280_get_sensor(bme280_t* bme);
+
+/**
+ * Get a consistent copy of the last sample, safe to call from any context
+ * which does not preempt the sampling one
+ *
+ * @return Number of samples taken so far, 0 if `reading` holds no sample yet
+*/
+unsigned int bme280_get_reading(bme280_t* bme, bme280_reading_t* reading);
+
+/**
+ * Open the temperature interface of the device
+*/
+status_t bme280_sensor_temperature_open(sensor_temperature_t* temp, bme280_t* bme);
+
+/**
+ * Open the pressure interface of the device
+*/
+status_t bme280_sensor_pressure_open(sensor_pressure_t* press, bme280_t* bme);
+
+/**
+ * Open the humidity interface of the device
+*/
+status_t bme280_sensor_humidity_open(sensor_humidity_t* hum, bme280_t* bme);
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef DRIVERS_STORAGE_AT24CXX_H
+#define DRIVERS_STORAGE_AT24CXX_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "common/types.h"
+#include "drivers/i2c.h"
+#include "drivers/sdev.h"
+
+#define AT24CXX_I2C_ADDRESS         (0x50)
+
+/**
+ * Called between two ACK polls while the EEPROM is busy with a write cycle,
+ * for example a short sleep or a yield
+*/
+#ifndef AT24CXX_POLL_WAIT
+#define AT24CXX_POLL_WAIT()         ((void)0)
+#endif
+
+/**
+ * ACK polls before a write cycle is considered failed
+ *
+ * @note Should cover the longest write cycle (usually 5 ms) at the bus speed
+*/
+#ifndef AT24CXX_POLL_LIMIT
+#define AT24CXX_POLL_LIMIT          (1000)
+#endif
+
+/**
+ * Largest page size of the supported parts, a full page burst is sent from a stack
+ * buffer of this size plus the address bytes
+*/
+#ifndef AT24CXX_PAGE_MAX
+#define AT24CXX_PAGE_MAX            (128)
+#endif
+
+/**
+ * Memory organization of a 24Cxx part
+ *
+ * @note Parts with one address byte and more than 256 bytes select the 256 byte
+ * block with the low bits of the I2C address
+*/
+typedef struct at24cxx_model {
+    uint32_t size;
+    uint16_t page_size;
+    uint8_t addr_len;
+} at24cxx_model_t;
+
+extern const at24cxx_model_t at24c01;
+extern const at24cxx_model_t at24c02;
+extern const at24cxx_model_t at24c04;
+extern const at24cxx_model_t at24c08;
+extern const at24cxx_model_t at24c16;
+extern const at24cxx_model_t at24c32;
+extern const at24cxx_model_t at24c64;
+extern const at24cxx_model_t at24c128;
+extern const at24cxx_model_t at24c256;
+extern const at24cxx_model_t at24c512;
+
+/**
+ * 24Cxx I2C EEPROM
+ *
+ * Writes are split into bursts which never cross a page, each sent as a single transaction
+ * with the memory address. The end of the write cycle is detected by ACK polling
+ * (`i2c_dev_poll`) right before the next access, so the caller is not blocked after the
+ * last page and a cycle is never waited for longer than it takes.
+ *
+ * @note Models with pages larger than `AT24CXX_PAGE_MAX` are rejected by `at24cxx_open`
+ * @note Members should only be used through API functions starting with at24cxx_*
+*/
+typedef struct at24cxx {
+    const at24cxx_model_t* model;
+    i2c_t* bus;
+    uint8_t addr;
+    sdev_t device;
+    i2c_sdev_context_t context;
+    /* Write cycle may be in progress */
+    uint8_t busy;
+} at24cxx_t;
+
+/**
+ * Initialize the driver for a part at I2C address `addr` (`AT24CXX_I2C_ADDRESS` plus address pins)
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t at24cxx_open(at24cxx_t* eeprom, i2c_t* bus, uint8_t addr, const at24cxx_model_t* model);
+
+/**
+ * Read `nbyte` bytes starting at `mem_addr` with a sequential read
+ *
+ * @note Blocking function, waits for a previous write cycle first
+*/
+status_t at24cxx_read(at24cxx_t* eeprom, uint32_t mem_addr, uint8_t* data, size_t nbyte);
+
+/**
+ * Write `nbyte` bytes starting at `mem_addr` using page bursts
+ *
+ * @note Blocking function, exits once the last burst is sent, the write cycle
+ * of the last page can still be in progress (see `at24cxx_sync`)
+*/
+status_t at24cxx_write(at24cxx_t* eeprom, uint32_t mem_addr, const uint8_t* data, size_t nbyte);
+
+/**
+ * Wait until the last write cycle is complete
+*/
+status_t at24cxx_sync(at24cxx_t* eeprom);
+
+/**
+ * Get the I2C device context used for data transfers, for example to set its retry or health policy
+*/
+i2c_sdev_context_t* at24cxx_get_context(at24cxx_t* eeprom);
+
+#endif
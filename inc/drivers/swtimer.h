@@ -0,0 +1,111 @@
+#ifndef DRIVERS_SWTIMER_H
+#define DRIVERS_SWTIMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hal_timer.h"
+#include "common/types.h"
+
+/**
+ * Protect the wheel from the timer ISR while it is changed from another context,
+ * for example by disabling interrupts
+*/
+#ifndef SWTIMER_LOCK
+#define SWTIMER_LOCK()
+#define SWTIMER_UNLOCK()
+#endif
+
+#define SWTIMER_LEVELS      (4)
+#define SWTIMER_SLOT_BITS   (6)
+#define SWTIMER_SLOTS       (1 << SWTIMER_SLOT_BITS)
+
+/**
+ * Called from the timer ISR context when the timer expires
+*/
+typedef void (*swtimer_callback_t)(void* arg);
+
+/**
+ * Software timer
+ *
+ * @note Members should only be used through API functions starting with swtimer_*
+*/
+typedef struct swtimer {
+    struct swtimer* next;
+    struct swtimer* prev;
+    /* Tick at which the timer expires */
+    uint32_t expiry;
+    /* Reload in ticks, 0 for one-shot */
+    uint32_t period;
+    swtimer_callback_t callback;
+    void* arg;
+    uint8_t active;
+    uint8_t level;
+    uint8_t slot;
+} swtimer_t;
+
+/**
+ * Hierarchical timing wheel driven by a hardware timer
+ *
+ * Each of the `SWTIMER_LEVELS` levels has `SWTIMER_SLOTS` slots, a slot of level L covers
+ * 64^L ticks. Timers are kept in the slot of their expiry and moved to a lower level when
+ * the wheel reaches it, so start, stop and expire are O(1) and a tick only looks at one slot.
+ * Occupied slots are tracked in bitmaps, which finds the next deadline without scanning.
+ *
+ * In tickless mode the hardware timer period is reprogrammed to the next deadline,
+ * so the ISR is entered only when a timer expires (or a higher level slot is reached).
+ *
+ * @note Members should only be used through API functions starting with swtimer_*
+*/
+typedef struct swtimer_wheel {
+    hal_timer_t timer;
+    uint32_t now;
+    /* Hardware timer counts per tick */
+    timer_count_t tick_counts;
+    uint8_t tickless;
+    /* Ticks until the next ISR in tickless mode */
+    uint32_t programmed;
+    uint64_t occupied[SWTIMER_LEVELS];
+    swtimer_t* slots[SWTIMER_LEVELS][SWTIMER_SLOTS];
+} swtimer_wheel_t;
+
+/**
+ * Initialize the wheel and start the hardware timer
+ *
+ * @note Requires static (persistent) allocation
+ * @note `timer_period_isr` for this timer must call `swtimer_wheel_isr`
+*/
+status_t swtimer_wheel_open(swtimer_wheel_t* wheel, hal_timer_t timer, timer_count_t tick_counts, uint8_t tickless);
+
+/**
+ * Current time of the wheel in ticks
+*/
+uint32_t swtimer_wheel_now(swtimer_wheel_t* wheel);
+
+/**
+ * Advance the wheel, should be called from `timer_period_isr`
+*/
+void swtimer_wheel_isr(swtimer_wheel_t* wheel);
+
+/**
+ * Initialize the timer
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t swtimer_init(swtimer_t* timer, swtimer_callback_t callback, void* arg);
+
+/**
+ * Start the timer to expire after `delay` ticks, then every `period` ticks if `period` is not 0
+ *
+ * @note Restarts the timer if it is already running
+ * @note Can be called from the timer callback
+*/
+status_t swtimer_start(swtimer_wheel_t* wheel, swtimer_t* timer, uint32_t delay, uint32_t period);
+
+/**
+ * Stop the timer
+ *
+ * @note Does nothing if the timer is not running
+*/
+status_t swtimer_stop(swtimer_wheel_t* wheel, swtimer_t* timer);
+
+#endif
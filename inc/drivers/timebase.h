@@ -0,0 +1,103 @@
+#ifndef DRIVERS_TIMEBASE_H
+#define DRIVERS_TIMEBASE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "hal_timer.h"
+#include "common/types.h"
+
+/**
+ * Check if the timer count wrapped and the period ISR did not run yet,
+ * for example on STM32 `(__HAL_TIM_GET_FLAG(timer, TIM_FLAG_UPDATE) != RESET)`
+ *
+ * @note Without it a read in a context which delays the ISR (interrupts disabled,
+ * higher priority interrupt) right after the wrap returns a time one period late
+ *
+ * @warning The flag has to stay set until `timebase_isr` returns. The STM32 HAL clears it in
+ * `HAL_TIM_IRQHandler` before calling `timer_period_isr`, so an interrupt preempting the timer
+ * interrupt between the two reads the old base with the wrapped count, one period late. Reads
+ * from threads and from interrupts which can not preempt the timer interrupt are not affected.
+*/
+#ifndef TIMEBASE_PERIOD_PENDING
+#define TIMEBASE_PERIOD_PENDING(timer)  (0)
+#endif
+
+/**
+ * 64-bit monotonic tick count extended from a hardware timer
+ *
+ * The period ISR adds the timer period to the base, readers combine the base with the
+ * current count. Base is kept in two slots selected by the sequence counter: the ISR writes
+ * the unused slot and then switches to it. Reading never blocks the ISR, never disables
+ * interrupts and never waits for the ISR, even from an interrupt which preempts it.
+ *
+ * Tick to time conversions use multipliers computed once in `timebase_open`,
+ * so converting is a few 32-bit multiplications and no division.
+ *
+ * @note Members should only be used through API functions starting with timebase_*
+*/
+typedef struct timebase {
+    hal_timer_t timer;
+    uint32_t frequency;
+    /* Counts per timer period */
+    uint64_t period;
+    /* Counts the periods, its lowest bit selects the current base */
+    atomic_uint seq;
+    volatile uint64_t base[2];
+    /* Q32.32 conversion multipliers */
+    uint64_t ns_per_tick;
+    uint64_t us_per_tick;
+    uint64_t ticks_per_us;
+} timebase_t;
+
+/**
+ * Initialize the timebase and start the timer
+ *
+ * @param frequency Timer counting frequency in Hz (after the prescaler)
+ * @param period Timer period, 0 for the full counter range
+ *
+ * @note Requires static (persistent) allocation
+ * @note `timer_period_isr` for this timer must call `timebase_isr`, the period can be shared
+ * with other users of the timer but must not be changed
+*/
+status_t timebase_open(timebase_t* timebase, hal_timer_t timer, uint32_t frequency, timer_count_t period);
+
+/**
+ * Extend the count by one period, should be called from `timer_period_isr`
+*/
+void timebase_isr(timebase_t* timebase);
+
+/**
+ * Ticks since `timebase_open`
+ *
+ * @note Can be called from any context, including interrupts
+ * @note Interrupts with a higher priority than the timer interrupt can read one period late
+ * right after the wrap, see `TIMEBASE_PERIOD_PENDING`
+*/
+uint64_t timebase_now(timebase_t* timebase);
+
+/**
+ * Convert ticks to nanoseconds
+*/
+uint64_t timebase_ticks_to_ns(timebase_t* timebase, uint64_t ticks);
+
+/**
+ * Convert ticks to microseconds
+*/
+uint64_t timebase_ticks_to_us(timebase_t* timebase, uint64_t ticks);
+
+/**
+ * Convert microseconds to ticks, for example to compute a timeout deadline
+*/
+uint64_t timebase_us_to_ticks(timebase_t* timebase, uint64_t us);
+
+/**
+ * Nanoseconds since `timebase_open`
+*/
+uint64_t timebase_now_ns(timebase_t* timebase);
+
+/**
+ * Microseconds since `timebase_open`
+*/
+uint64_t timebase_now_us(timebase_t* timebase);
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef DRIVERS_UART_SDEV_H
+#define DRIVERS_UART_SDEV_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "hal_uart.h"
+#include "common/types.h"
+#include "common/ring.h"
+#include "drivers/sdev.h"
+
+/**
+ * Largest chunk passed to a single `uart_send_it` call
+*/
+#ifndef UART_SDEV_TX_CHUNK_MAX
+#define UART_SDEV_TX_CHUNK_MAX  (0xffff)
+#endif
+
+/**
+ * Largest span of the receive ring armed with a single `uart_recv_it` call
+*/
+#ifndef UART_SDEV_RX_CHUNK_MAX
+#define UART_SDEV_RX_CHUNK_MAX  (0xffff)
+#endif
+
+/**
+ * Called by `UART_SDEV_IOCTL_FLUSH` while waiting for the transmit ring to drain,
+ * for example a yield
+*/
+#ifndef UART_SDEV_FLUSH_WAIT
+#define UART_SDEV_FLUSH_WAIT()  ((void)0)
+#endif
+
+/**
+ * Failed transmit starts in a row before `UART_SDEV_IOCTL_FLUSH` gives up
+*/
+#ifndef UART_SDEV_FLUSH_TRIES
+#define UART_SDEV_FLUSH_TRIES   (16)
+#endif
+
+/**
+ * IO control types for a serial device on a UART
+*/
+typedef enum uart_sdev_ioctl {
+    UART_SDEV_IOCTL_RX_AVAILABLE,   /* arg is `size_t*`, number of received bytes buffered */
+    UART_SDEV_IOCTL_TX_FREE,        /* arg is `size_t*`, free space in the transmit buffer */
+    UART_SDEV_IOCTL_FLUSH           /* arg is unused, block until all buffered data is sent,
+                                       fails after `UART_SDEV_FLUSH_TRIES` failed transmit starts */
+} uart_sdev_ioctl_t;
+
+/**
+ * Additional data for a serial device on a UART
+ *
+ * @note Members should only be used through the serial device API
+*/
+typedef struct uart_sdev_context {
+    uart_t uart;
+    ring_t tx;
+    ring_t rx;
+    /* Length of the chunk currently being sent */
+    size_t tx_inflight;
+    atomic_flag tx_active;
+    /* Ring position and length of the span currently being received */
+    atomic_size_t rx_start;
+    size_t rx_len;
+    atomic_bool rx_stalled;
+    uint32_t tx_errors;
+    uint32_t rx_errors;
+} uart_sdev_context_t;
+
+/**
+ * Open a serial device on the UART
+ *
+ * Writes are copied to the transmit ring and never block, the ring is drained in
+ * large `uart_send_it` chunks chained from the send ISR. Reception runs continuously over
+ * the free span of the receive ring with a single `uart_recv_it`, rearmed from the receive
+ * ISR when the span is full. Reads pick up the bytes received so far with
+ * `uart_recv_it_count`, so data does not wait for the span to complete.
+ *
+ * @note Buffer sizes must be powers of two
+ * @note Requires static (persistent) allocation of the context and buffers
+ * @note `uart_send_isr` and `uart_recv_isr` for this UART must call `uart_sdev_send_isr` and `uart_sdev_recv_isr`
+ * @note Writes should come from a single context
+*/
+status_t uart_sdev_open(uart_t uart, sdev_t* device, uart_sdev_context_t* context,
+    uint8_t* tx_buffer, size_t tx_len, uint8_t* rx_buffer, size_t rx_len);
+
+/**
+ * Send complete handler, chains the next transmit chunk
+ *
+ * @note Should be called from `uart_send_isr`
+*/
+void uart_sdev_send_isr(uart_sdev_context_t* context, hal_status_t status);
+
+/**
+ * Receive complete handler, publishes the received span and rearms receiving
+ *
+ * @note Should be called from `uart_recv_isr`
+*/
+void uart_sdev_recv_isr(uart_sdev_context_t* context, hal_status_t status);
+
+#endif
@@ -11,8 +11,18 @@
     typedef HAL_ADC_TYPEDEF adc_t;
 #endif
 
+typedef enum {
+    ADC_CB_SRC_EOS,
+    ADC_CB_SRC_DMA_BUFFER_HALF,
+    ADC_CB_SRC_DMA_BUFFER_FILLED,
+    ADC_CB_SRC_ERROR
+} adc_callback_src_t;
+
 /**
  * Start the ADC in DMA mode
+ * @note `length` is the number of DMA transfers (samples)
+ * @note If the DMA is in circular mode, `adc_dma_buffer_half_isr` and `adc_dma_buffer_filled_isr`
+ * are called every time the first and the second half of the buffer is filled
 */
 hal_status_t adc_start_dma(adc_t adc, uint8_t* buffer, uint32_t length);
 
@@ -40,6 +50,7 @@ void adc_clear_eos_flag(adc_t adc);
 
 /**
  * Read the position of dma write pointer relative to start of the buffer
+ * @note Position is in samples, in range [0, length)
  */
 uint32_t adc_dma_get_counter(adc_t adc);
 
@@ -50,8 +61,9 @@ uint32_t adc_dma_get_counter(adc_t adc);
  * @retval `HAL_STATUS_ERROR` callback registration failed
  * @note Implement in hal_adc.c
  * @note Multiple registrations should override the last one
+ * @note Targets which sample only with DMA reject `ADC_CB_SRC_EOS`, poll `adc_read_eos_flag` instead
 */
-hal_status_t adc_register_callback(adc_t adc, callback_t callback);
+hal_status_t adc_register_callback(adc_t adc, callback_t callback, adc_callback_src_t src);
 #else
 /**
  * ADC end of sequence ISR
@@ -66,6 +78,18 @@ void adc_eos_isr(adc_t adc);
  * @note This function should be called from lower level (driver's) ISR in the hal_adc.c
 */
 void adc_dma_buffer_filled_isr(adc_t adc);
+
+/**
+ * ADC first half of the buffer filled by DMA ISR
+ * @note This function should be called from lower level (driver's) ISR in the hal_adc.c
+*/
+void adc_dma_buffer_half_isr(adc_t adc);
+
+/**
+ * ADC overrun or DMA error ISR
+ * @note This function should be called from lower level (driver's) ISR in the hal_adc.c
+*/
+void adc_error_isr(adc_t adc);
 #endif
 
 #endif
\ No newline at end of file
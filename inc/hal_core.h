@@ -1,6 +1,38 @@
 #ifndef HAL_CORE_H
 #define HAL_CORE_H
 
+/* Defined before the target header, so targets can use them in their types */
+typedef enum {
+	HAL_STATUS_OK,
+	HAL_STATUS_ERROR,
+	HAL_STATUS_BUSY
+} hal_status_t;
+
+typedef void (*callback_t)(hal_status_t);
+
+/* Callback sources, targets size their callback tables by the last source */
+typedef enum {
+	I2C_CB_SRC_MASTER_SEND_COMPLETE,
+	I2C_CB_SRC_MASTER_RECV_COMPLETE,
+	I2C_CB_SRC_MASTER_SEND_ERROR,
+	I2C_CB_SRC_MASTER_RECV_ERROR,
+	I2C_CB_SRC_SLAVE_SEND_COMPLETE,
+	I2C_CB_SRC_SLAVE_RECV_COMPLETE,
+	I2C_CB_SRC_SLAVE_SEND_ERROR,
+	I2C_CB_SRC_SLAVE_RECV_ERROR
+} i2c_callback_src_t;
+
+typedef enum {
+	UART_CB_SRC_SEND_COMPLETE,
+	UART_CB_SRC_RECV_COMPLETE,
+	UART_CB_SRC_SEND_ERROR,
+	UART_CB_SRC_RECV_ERROR
+} uart_callback_src_t;
+
+typedef enum {
+	TIMER_CB_SRC_PERIOD
+} timer_callback_src_t;
+
 #if defined(HAL_TARGET_PC)
 #include "hal_target_pc.h"
 #elif defined(HAL_TARGET_STM32F4)
@@ -41,12 +73,4 @@
 */
 #define __HAL_TEMPLATE_TYPEDEF(x)		typedef void* x
 
-typedef enum {
-	HAL_STATUS_OK,
-	HAL_STATUS_ERROR,
-	HAL_STATUS_BUSY
-} hal_status_t;
-
-typedef void (*callback_t)(hal_status_t);
-
 #endif /* HAL_CORE_H */
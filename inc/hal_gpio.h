@@ -44,12 +44,13 @@ void gpio_port_toggle(gpio_port_t port, gpio_pin_t pins);
 #ifdef HAL_GPIO_USE_REGISTER_CALLBACKS
 /**
  * Register a callback for GPIO external interrupt
+ * @note `pin` is a mask, the callback is registered for every pin in it
  * @retval `HAL_STATUS_OK` callback registered successfully
  * @retval `HAL_STATUS_ERROR` callback registration failed
  * @note Implement in hal_gpio.c
  * @note Multiple registrations should override the last one
 */
-hal_status_t gpio_register_callback(gpio_t gpio, gpio_pin_t pin, callback_t callback);
+hal_status_t gpio_register_callback(gpio_port_t port, gpio_pin_t pin, callback_t callback);
 #else
 /**
  * GPIO external interrupt ISR
@@ -11,16 +11,7 @@
     typedef HAL_I2C_TYPEDEF i2c_t;
 #endif
 
-typedef enum {
-    I2C_CB_SRC_MASTER_SEND_COMPLETE,
-    I2C_CB_SRC_MASTER_RECV_COMPLETE,
-    I2C_CB_SRC_MASTER_SEND_ERROR,
-    I2C_CB_SRC_MASTER_RECV_ERROR,
-    I2C_CB_SRC_SLAVE_SEND_COMPLETE,
-    I2C_CB_SRC_SLAVE_RECV_COMPLETE,
-    I2C_CB_SRC_SLAVE_SEND_ERROR,
-    I2C_CB_SRC_SLAVE_RECV_ERROR
-} i2c_callback_src_t;
+/* `i2c_callback_src_t` is defined in hal_core.h */
 
 /**
  * Send <size> bytes via I2C to slave at address <addr>
@@ -70,6 +61,7 @@ hal_status_t i2c_master_recv_it(i2c_t i2c, uint16_t addr, uint8_t* buff, uint16_
  * @retval `HAL_STATUS_ERROR` callback registration failed
  * @note Implement in hal_i2c.c
  * @note Multiple registrations should override the last one
+ * @note Slave sources are rejected while slave mode is not implemented
 */
 hal_status_t i2c_register_callback(i2c_t i2c, callback_t callback, i2c_callback_src_t src);
 #else
@@ -3,24 +3,35 @@
 
 #include "hal_core.h"
 #include "stdint.h"
+#include "common/ring.h"
 
 /**
  * Send `len` bytes of data starting from `buffer`
  * 
- * @note Blocking function
- * @note Never returns busy since all IO functions should be blocking
- * @retval `HAL_STATUS_OK` - message sent successfully
+ * @note Implementation can buffer the data and send it in background, use `io_flush` to wait for it
+ * @note Blocks only if the data can not be buffered
+ * @retval `HAL_STATUS_OK` - message sent (or buffered) successfully
+ * @retval `HAL_STATUS_BUSY` - buffer full and the implementation drops data instead of blocking
  * @retval `HAL_STATUS_ERROR` - error during communication
 */
 hal_status_t io_putdata(const uint8_t* buffer, uint16_t len);
 
+/**
+ * Wait until all data buffered by `io_putdata` is sent
+ * 
+ * @retval `HAL_STATUS_OK` - all data sent
+ * @retval `HAL_STATUS_BUSY` - can not wait in the current context (ISR), data is still being sent
+ * @retval `HAL_STATUS_ERROR` - error during communication
+*/
+hal_status_t io_flush(void);
+
 /**
  * Receive `len` bytes of data and store starting at `buffer`
  * 
- * @note Blocking function
+ * @note Blocking function, implementation can give up after a timeout
  * @note Never returns busy since all IO functions should be blocking
  * @retval `HAL_STATUS_OK` - message sent successfully
- * @retval `HAL_STATUS_ERROR` - error during communication
+ * @retval `HAL_STATUS_ERROR` - error during communication, timeout or end of input
 */
 hal_status_t io_getdata(uint8_t* buffer, uint16_t len);
 
@@ -49,9 +60,34 @@ hal_status_t io_putchar(const char c);
 */
 hal_status_t io_getchar(char* c);
 
+/**
+ * Start continuous receiving into the IO receive ring
+ * 
+ * @note Received data is read with the ring reader functions on `io_rx_ring`
+ * (`ring_read_spans`, `ring_get_line`, `ring_get_frame` and `ring_consume`)
+ * @note Started automatically by `io_register_receive_callback`
+*/
+hal_status_t io_rx_start(void);
+
+/**
+ * Get the IO receive ring
+ * 
+ * @note Single consumer, not to be used while a receive callback is registered
+ * @note Call before each read, implementations whose reception does not stop when the ring
+ * is full skip the overwritten data here
+*/
+ring_t* io_rx_ring(void);
+
+/**
+ * Number of received bytes lost because the receive ring was full
+*/
+uint32_t io_rx_get_overruns(void);
+
 /**
  * Register a callback for when data is received over IO port
  * @note Callback function is called from ISR context
+ * @note `data` points into the receive ring and is valid only during the callback,
+ * data which wraps in the ring is passed in two calls
  */
 hal_status_t io_register_receive_callback(void (*callback)(uint8_t* data, uint16_t len));
 
@@ -10,9 +10,18 @@
 
 #ifndef HAL_TIMER_TYPEDEF
     #error "HAL_TIMER_TYPEDEF not defined"
-    __HAL_TEMPLATE_TYPEDEF(timer_t);
+    __HAL_TEMPLATE_TYPEDEF(hal_timer_t);
 #else
-    typedef HAL_TIMER_TYPEDEF timer_t;
+    typedef HAL_TIMER_TYPEDEF hal_timer_t;
+#endif
+
+/**
+ * Short name of the timer type
+ * @note Not declared if the target defines `HAL_TIMER_NO_TIMER_T` because its system headers
+ * already use `timer_t` (POSIX), portable code should use `hal_timer_t`
+*/
+#ifndef HAL_TIMER_NO_TIMER_T
+    typedef hal_timer_t timer_t;
 #endif
 
 #ifdef HAL_TIMER_32BIT
@@ -29,12 +38,14 @@ typedef enum {
     // TIMER_COUNT_MODE_UP_DOWN
 } timer_count_mode_t;
 
+/* `timer_callback_src_t` is defined in hal_core.h */
+
 /**
  * Set timer counting mode
  * @note Can be used to stop the timer using `TIMER_COUNT_MODE_STOP`
  * @note Up to implementation if can be called during timer running
 */
-hal_status_t timer_set_mode(timer_t timer, timer_count_mode_t timer_mode);
+hal_status_t timer_set_mode(hal_timer_t timer, timer_count_mode_t timer_mode);
 
 /**
  * Set timer period
@@ -42,7 +53,7 @@ hal_status_t timer_set_mode(timer_t timer, timer_count_mode_t timer_mode);
  * @note If enabled, triggers `timer_period_isr` when timer count hits `period`
  * @note If set to value less than current count while timer is running, timer should trigger isr and reset to 0
 */
-hal_status_t timer_set_period(timer_t timer, timer_count_t period);
+hal_status_t timer_set_period(hal_timer_t timer, timer_count_t period);
 
 /**
  * Start the timer (enable counting)
@@ -50,7 +61,7 @@ hal_status_t timer_set_period(timer_t timer, timer_count_t period);
  * @retval `HAL_STATUS_ERROR` if timer starting failed
  * @note This should not reset the current value of the counter
 */
-hal_status_t timer_start(timer_t timer);
+hal_status_t timer_start(hal_timer_t timer);
 
 /**
  * Stop the timer (disable counting)
@@ -58,7 +69,7 @@ hal_status_t timer_start(timer_t timer);
  * @retval `HAL_STATUS_ERROR` if timer stopping failed
  * @note This should not reset the current value of the counter
 */
-hal_status_t timer_stop(timer_t timer);
+hal_status_t timer_stop(hal_timer_t timer);
 
 /**
  * Clear the timer count value (set to 0)
@@ -66,22 +77,29 @@ hal_status_t timer_stop(timer_t timer);
  * @retval `HAL_STATUS_ERROR` if timer clearing failed
  * @note Should work and should not change if the timer is enabled or disabled
 */
-hal_status_t timer_clear(timer_t timer);
+hal_status_t timer_clear(hal_timer_t timer);
 
 /**
  * Get current count of the timer
  * @note This should just act as a macro for reading timer counter register
 */
-timer_count_t timer_get_count(timer_t timer);
+timer_count_t timer_get_count(hal_timer_t timer);
 
 #ifdef HAL_TIMER_USE_REGISTER_CALLBACKS
-
+/**
+ * Register a callback for timer event
+ * @retval `HAL_STATUS_OK` callback registered successfully
+ * @retval `HAL_STATUS_ERROR` callback registration failed
+ * @note Implement in hal_timer.c
+ * @note Multiple registrations should override the last one
+*/
+hal_status_t timer_register_callback(hal_timer_t timer, callback_t callback, timer_callback_src_t src);
 #else
 /**
  * Timer periodic ISR
  * Called when timer count hits timer period value
 */
-void timer_period_isr(timer_t timer);
+void timer_period_isr(hal_timer_t timer);
 #endif
 
 #endif /* HAL_TIMER_H */
\ No newline at end of file
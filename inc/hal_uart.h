@@ -11,12 +11,7 @@
     typedef HAL_UART_TYPEDEF uart_t;
 #endif
 
-typedef enum {
-    UART_CB_SRC_SEND_COMPLETE,
-    UART_CB_SRC_RECV_COMPLETE,
-    UART_CB_SRC_SEND_ERROR,
-    UART_CB_SRC_RECV_ERROR
-} uart_callback_src_t;
+/* `uart_callback_src_t` is defined in hal_core.h */
 
 /**
  * Send <size> bytes via UART
@@ -59,6 +54,14 @@ hal_status_t uart_send_it(uart_t uart, uint8_t* data, uint16_t size, uint16_t ti
  */
 hal_status_t uart_recv_it(uart_t uart, uint8_t* buff, uint16_t size, uint16_t timeout);
 
+/**
+ * Returns number of bytes received so far by the last `uart_recv_it`
+ * @note Lets the receiver use data before the whole <size> is received,
+ * once the operation completes it stays <size> until the next start
+ * @note Implement in hal_uart.c
+ */
+uint16_t uart_recv_it_count(uart_t uart);
+
 /**
  * Returns whether UART receive buffer is empty
  */
@@ -0,0 +1,177 @@
+#include "common/event.h"
+
+#if (EVENT_QUEUE_LEN & (EVENT_QUEUE_LEN - 1)) != 0
+#error "EVENT_QUEUE_LEN must be a power of two"
+#endif
+
+#if EVENT_PRIORITIES > 32
+#error "EVENT_PRIORITIES must fit the pending bitmap"
+#endif
+
+/**
+ * Set cell sequence numbers and clear the statistics
+*/
+status_t event_loop_init(event_loop_t* loop)
+{
+    for (uint8_t p = 0; p < EVENT_PRIORITIES; p++) {
+        event_queue_t* queue = &loop->queues[p];
+
+        for (unsigned int i = 0; i < EVENT_QUEUE_LEN; i++)
+            atomic_init(&queue->cells[i].seq, i);
+
+        atomic_init(&queue->enqueue_pos, 0);
+        atomic_init(&queue->dequeue_pos, 0);
+        atomic_init(&queue->max_depth, 0);
+        atomic_init(&queue->dropped, 0);
+        queue->dispatched = 0;
+        queue->max_latency = 0;
+    }
+    atomic_init(&loop->pending, 0);
+
+    return STATUS_OK;
+}
+
+/**
+ * Claim a cell with a CAS on the enqueue position and publish it through the cell sequence
+*/
+status_t event_post(event_loop_t* loop, uint8_t priority, event_handler_t handler, void* arg, uint32_t data)
+{
+    if (priority >= EVENT_PRIORITIES || handler == NULL)
+        return STATUS_ERROR;
+
+    event_queue_t* queue = &loop->queues[priority];
+    event_cell_t* cell;
+    unsigned int pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        cell = &queue->cells[pos & (EVENT_QUEUE_LEN - 1)];
+        unsigned int seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+            return STATUS_ERROR;
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->handler = handler;
+    cell->arg = arg;
+    cell->data = data;
+    cell->timestamp = (uint32_t)EVENT_TIMESTAMP();
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    /* Instrumentation only, a stale dequeue position can only overestimate the depth */
+    unsigned int depth = pos + 1 - atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    unsigned int max_depth = atomic_load_explicit(&queue->max_depth, memory_order_relaxed);
+    while (depth > max_depth && !atomic_compare_exchange_weak_explicit(&queue->max_depth, &max_depth, depth,
+        memory_order_relaxed, memory_order_relaxed)) {}
+
+    atomic_fetch_or_explicit(&loop->pending, 1u << priority, memory_order_seq_cst);
+
+    return STATUS_OK;
+}
+
+/**
+ * Take the oldest published event and free its cell
+ * @return 0 if there is none
+*/
+static uint8_t event_pop(event_queue_t* queue, event_cell_t* event)
+{
+    unsigned int pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    event_cell_t* cell = &queue->cells[pos & (EVENT_QUEUE_LEN - 1)];
+
+    if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1)
+        return 0;
+
+    event->handler = cell->handler;
+    event->arg = cell->arg;
+    event->data = cell->data;
+    event->timestamp = cell->timestamp;
+
+    atomic_store_explicit(&cell->seq, pos + EVENT_QUEUE_LEN, memory_order_release);
+    atomic_store_explicit(&queue->dequeue_pos, pos + 1, memory_order_relaxed);
+
+    return 1;
+}
+
+/**
+ * Take batches from the highest pending priority until no priority is pending
+*/
+size_t event_loop_poll(event_loop_t* loop)
+{
+    size_t count = 0;
+    unsigned int pending;
+
+    while ((pending = atomic_load_explicit(&loop->pending, memory_order_acquire)) != 0) {
+        uint8_t priority = (uint8_t)__builtin_ctz(pending);
+        event_queue_t* queue = &loop->queues[priority];
+        event_cell_t event;
+        uint8_t n = 0;
+
+        while (n < EVENT_BATCH && event_pop(queue, &event)) {
+            uint32_t latency = (uint32_t)EVENT_TIMESTAMP() - event.timestamp;
+            if (latency > queue->max_latency)
+                queue->max_latency = latency;
+
+            event.handler(event.arg, event.data);
+            queue->dispatched++;
+            n++;
+        }
+        count += n;
+
+        if (n < EVENT_BATCH) {
+            atomic_fetch_and_explicit(&loop->pending, ~(1u << priority), memory_order_seq_cst);
+
+            /* Event posted after the last pop but before the bit was cleared, or still being written */
+            if (atomic_load_explicit(&queue->enqueue_pos, memory_order_seq_cst) !=
+                atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed))
+                atomic_fetch_or_explicit(&loop->pending, 1u << priority, memory_order_relaxed);
+        }
+    }
+
+    return count;
+}
+
+void event_loop_run(event_loop_t* loop)
+{
+    for (;;) {
+        if (event_loop_poll(loop) == 0) {
+            EVENT_IDLE();
+        }
+    }
+}
+
+status_t event_loop_get_stats(event_loop_t* loop, uint8_t priority, event_stats_t* stats)
+{
+    if (priority >= EVENT_PRIORITIES)
+        return STATUS_ERROR;
+
+    event_queue_t* queue = &loop->queues[priority];
+
+    stats->depth = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed) -
+        atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    stats->max_depth = atomic_load_explicit(&queue->max_depth, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&queue->dropped, memory_order_relaxed);
+    stats->dispatched = queue->dispatched;
+    stats->max_latency = queue->max_latency;
+
+    return STATUS_OK;
+}
+
+void event_loop_reset_stats(event_loop_t* loop)
+{
+    for (uint8_t p = 0; p < EVENT_PRIORITIES; p++) {
+        event_queue_t* queue = &loop->queues[p];
+
+        atomic_store_explicit(&queue->max_depth, 0, memory_order_relaxed);
+        atomic_store_explicit(&queue->dropped, 0, memory_order_relaxed);
+        queue->dispatched = 0;
+        queue->max_latency = 0;
+    }
+}
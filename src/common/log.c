@@ -0,0 +1,222 @@
+#include <stdatomic.h>
+#include "common/log.h"
+#include "hal_io.h"
+
+/* Record id reserved for the dropped records notice, format ids start from 1 */
+#define LOG_ID_DROPPED          (0)
+
+/* Longest encoded record: id, timestamp and arguments as varints */
+#define LOG_RECORD_MAX_LEN      (5 * (2 + LOG_MAX_ARGS))
+/* COBS overhead and the frame delimiter */
+#define LOG_FRAME_MAX_LEN       (LOG_RECORD_MAX_LEN + 2)
+
+#if (LOG_RING_LEN & (LOG_RING_LEN - 1)) != 0
+#error "LOG_RING_LEN must be a power of two"
+#endif
+
+#if LOG_DRAIN_BUFFER_LEN < LOG_FRAME_MAX_LEN
+#error "LOG_DRAIN_BUFFER_LEN can not hold a single record"
+#endif
+
+/**
+ * Ring cell, `seq` tells whose turn it is: equal to the position when free for the
+ * producer, position + 1 when filled for the consumer
+*/
+typedef struct log_cell {
+    atomic_size_t seq;
+    uint32_t id;
+    uint32_t timestamp;
+    uint8_t nargs;
+    uint32_t args[LOG_MAX_ARGS];
+} log_cell_t;
+
+/* Start of the format section, provided by the linker */
+extern const char __start_log_fmt[];
+
+static log_cell_t log_cells[LOG_RING_LEN];
+static atomic_size_t log_enqueue_pos;
+static size_t log_dequeue_pos;
+static atomic_uint_fast32_t log_dropped;
+static atomic_flag log_initialized = ATOMIC_FLAG_INIT;
+static atomic_bool log_ready;
+
+/**
+ * Set cell sequence numbers on first use
+*/
+static void log_init(void)
+{
+    if (atomic_flag_test_and_set(&log_initialized)) {
+        /* Another context is initializing, ISRs preempting it drop the record */
+        return;
+    }
+
+    for (size_t i = 0; i < LOG_RING_LEN; i++)
+        atomic_init(&log_cells[i].seq, i);
+
+    atomic_store_explicit(&log_ready, 1, memory_order_release);
+}
+
+/**
+ * Claim a cell with a CAS on the enqueue position and publish it through the cell sequence
+*/
+status_t log_record(const char* fmt, uint8_t nargs, const uint32_t* args)
+{
+    if (!atomic_load_explicit(&log_ready, memory_order_acquire)) {
+        log_init();
+        if (!atomic_load_explicit(&log_ready, memory_order_acquire)) {
+            atomic_fetch_add_explicit(&log_dropped, 1, memory_order_relaxed);
+            return STATUS_ERROR;
+        }
+    }
+
+    log_cell_t* cell;
+    size_t pos = atomic_load_explicit(&log_enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        cell = &log_cells[pos & (LOG_RING_LEN - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&log_enqueue_pos, &pos, pos + 1,
+                memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&log_dropped, 1, memory_order_relaxed);
+            return STATUS_ERROR;
+        } else {
+            pos = atomic_load_explicit(&log_enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    if (nargs > LOG_MAX_ARGS)
+        nargs = LOG_MAX_ARGS;
+
+    cell->id = (uint32_t)(fmt - __start_log_fmt) + 1;
+    cell->timestamp = (uint32_t)LOG_TIMESTAMP();
+    cell->nargs = nargs;
+    for (uint8_t i = 0; i < nargs; i++)
+        cell->args[i] = args[i];
+
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    return STATUS_OK;
+}
+
+/**
+ * Append `value` as a little endian base 128 varint
+*/
+static size_t log_put_varint(uint8_t* out, uint32_t value)
+{
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        out[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+
+    return len;
+}
+
+/**
+ * COBS encode the record and terminate the frame with a zero byte
+ *
+ * @note Zero bytes only appear as frame delimiters, so the decoder can resynchronize
+*/
+static size_t log_put_frame(uint8_t* out, const uint8_t* record, size_t len)
+{
+    size_t code_pos = 0;
+    size_t pos = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (record[i] == 0) {
+            out[code_pos] = code;
+            code_pos = pos++;
+            code = 1;
+        } else {
+            out[pos++] = record[i];
+            code++;
+        }
+    }
+    out[code_pos] = code;
+    out[pos++] = 0;
+
+    return pos;
+}
+
+/**
+ * Encode the record as id, timestamp and arguments
+*/
+static size_t log_encode(uint8_t* out, uint32_t id, uint32_t timestamp, uint8_t nargs, const uint32_t* args)
+{
+    uint8_t record[LOG_RECORD_MAX_LEN];
+    size_t len = 0;
+
+    len += log_put_varint(&record[len], id);
+    len += log_put_varint(&record[len], timestamp);
+    for (uint8_t i = 0; i < nargs; i++)
+        len += log_put_varint(&record[len], args[i]);
+
+    return log_put_frame(out, record, len);
+}
+
+/**
+ * Pop records and send them in buffers of `LOG_DRAIN_BUFFER_LEN`
+*/
+status_t log_drain(void)
+{
+    uint8_t buffer[LOG_DRAIN_BUFFER_LEN];
+    size_t len = 0;
+    /* Records which are lost if the buffer can not be sent, the reported drops included */
+    uint32_t pending;
+
+    if (!atomic_load_explicit(&log_ready, memory_order_acquire))
+        return STATUS_OK;
+
+    uint32_t dropped = (uint32_t)atomic_exchange_explicit(&log_dropped, 0, memory_order_relaxed);
+    if (dropped != 0)
+        len += log_encode(buffer, LOG_ID_DROPPED, (uint32_t)LOG_TIMESTAMP(), 1, &dropped);
+    pending = dropped;
+
+    for (;;) {
+        log_cell_t* cell = &log_cells[log_dequeue_pos & (LOG_RING_LEN - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+
+        /* Empty, or the next record is still being written */
+        if (seq != log_dequeue_pos + 1)
+            break;
+
+        if (len + LOG_FRAME_MAX_LEN > LOG_DRAIN_BUFFER_LEN) {
+            if (io_putdata(buffer, (uint16_t)len) != HAL_STATUS_OK) {
+                /* Reported with the next drain instead */
+                atomic_fetch_add_explicit(&log_dropped, pending, memory_order_relaxed);
+                return STATUS_ERROR;
+            }
+            len = 0;
+            pending = 0;
+        }
+
+        len += log_encode(&buffer[len], cell->id, cell->timestamp, cell->nargs, cell->args);
+        pending++;
+
+        atomic_store_explicit(&cell->seq, log_dequeue_pos + LOG_RING_LEN, memory_order_release);
+        log_dequeue_pos++;
+    }
+
+    if (len != 0 && io_putdata(buffer, (uint16_t)len) != HAL_STATUS_OK) {
+        atomic_fetch_add_explicit(&log_dropped, pending, memory_order_relaxed);
+        return STATUS_ERROR;
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * Records dropped since the last drain
+*/
+uint32_t log_get_dropped(void)
+{
+    return (uint32_t)atomic_load_explicit(&log_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,78 @@
+#include "common/pool.h"
+
+/**
+ * Take a block from the free list, or the next never used block from storage
+*/
+void* pool_alloc(pool_t* pool)
+{
+    void* block = NULL;
+
+    POOL_LOCK();
+
+    if (pool->free_list != NULL) {
+        block = pool->free_list;
+        pool->free_list = *(void**)block;
+    } else if (pool->reserved < pool->capacity) {
+        block = pool->storage + pool->reserved * pool->block_size;
+        pool->reserved++;
+    }
+
+    if (block != NULL) {
+        pool->used++;
+        if (pool->used > pool->high_water)
+            pool->high_water = pool->used;
+    } else {
+        pool->failed++;
+    }
+
+    POOL_UNLOCK();
+
+    return block;
+}
+
+/**
+ * Push the block to the free list
+*/
+status_t pool_free(pool_t* pool, void* block)
+{
+    if (!pool_owns(pool, block))
+        return STATUS_ERROR;
+
+    POOL_LOCK();
+
+    *(void**)block = pool->free_list;
+    pool->free_list = block;
+    pool->used--;
+
+    POOL_UNLOCK();
+
+    return STATUS_OK;
+}
+
+/**
+ * Check if the pointer is within the handed out part of storage and block aligned
+*/
+int pool_owns(const pool_t* pool, const void* block)
+{
+    const uint8_t* ptr = (const uint8_t*)block;
+
+    if (ptr < pool->storage || ptr >= pool->storage + pool->reserved * pool->block_size)
+        return 0;
+
+    return ((size_t)(ptr - pool->storage) % pool->block_size) == 0;
+}
+
+/**
+ * Copy the pool counters
+*/
+void pool_get_stats(const pool_t* pool, pool_stats_t* stats)
+{
+    POOL_LOCK();
+
+    stats->capacity = pool->capacity;
+    stats->used = pool->used;
+    stats->high_water = pool->high_water;
+    stats->failed = pool->failed;
+
+    POOL_UNLOCK();
+}
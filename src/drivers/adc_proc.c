@@ -0,0 +1,346 @@
+#include <string.h>
+#include "drivers/adc_proc.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#endif
+
+/**
+ * Integer square root
+*/
+static uint32_t adc_proc_isqrt(uint64_t x)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ull << 62;
+
+    while (bit > x)
+        bit >>= 2;
+
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+/**
+ * Split interleaved channels
+*/
+void adc_proc_deinterleave(const uint16_t* in, size_t frames, uint8_t channels, uint16_t* const* out)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    if (channels == 2) {
+        /* 8 frames per iteration, even and odd samples gathered into the low and high halves */
+        for (; i + 8 <= frames; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*)&in[2 * i]);
+            __m128i b = _mm_loadu_si128((const __m128i*)&in[2 * i + 8]);
+
+            a = _mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 1, 2, 0));
+            a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 1, 2, 0));
+            a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shufflelo_epi16(b, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shufflehi_epi16(b, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0));
+
+            _mm_storeu_si128((__m128i*)&out[0][i], _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128((__m128i*)&out[1][i], _mm_unpackhi_epi64(a, b));
+        }
+    }
+#endif
+
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        uint16_t* restrict dst = out[ch];
+        const uint16_t* restrict src = &in[ch];
+
+        for (size_t f = i; f < frames; f++)
+            dst[f] = src[f * channels];
+    }
+}
+
+/**
+ * Sum `count` groups of `factor` samples
+*/
+static inline void adc_proc_sum_groups(const uint16_t* restrict in, size_t count, uint16_t factor,
+    uint8_t shift, uint16_t* restrict out)
+{
+    for (size_t o = 0; o < count; o++) {
+        const uint16_t* src = &in[o * factor];
+        uint32_t sum = 0;
+
+        for (uint16_t k = 0; k < factor; k++)
+            sum += src[k];
+
+        sum >>= shift;
+        out[o] = sum > UINT16_MAX ? UINT16_MAX : (uint16_t)sum;
+    }
+}
+
+/**
+ * Sum groups of samples
+ *
+ * @note With a variable factor the compiler vectorises the short inner loop, which is slower
+ * than scalar code for small groups, so those are unrolled with a constant factor
+*/
+size_t adc_proc_oversample(const uint16_t* in, size_t n, uint16_t factor, uint8_t shift, uint16_t* out)
+{
+    if (factor == 0)
+        return 0;
+
+    size_t count = n / factor;
+
+    switch (factor) {
+    case 2:
+        adc_proc_sum_groups(in, count, 2, shift, out);
+        break;
+    case 4:
+        adc_proc_sum_groups(in, count, 4, shift, out);
+        break;
+    default:
+        adc_proc_sum_groups(in, count, factor, shift, out);
+        break;
+    }
+
+    return count;
+}
+
+/**
+ * Subtract the offset
+*/
+void adc_proc_to_signed(const uint16_t* in, size_t n, uint16_t offset, int16_t* out)
+{
+    const uint16_t* restrict src = in;
+    int16_t* restrict dst = out;
+
+    for (size_t i = 0; i < n; i++)
+        dst[i] = (int16_t)(src[i] - offset);
+}
+
+/**
+ * Block statistics, sums are exact for any `n` below 2^32
+*/
+status_t adc_proc_get_stats(const uint16_t* in, size_t n, adc_proc_stats_t* stats)
+{
+    if (n == 0)
+        return STATUS_ERROR;
+
+    uint16_t min = UINT16_MAX;
+    uint16_t max = 0;
+    uint64_t sum = 0;
+    uint64_t sum_sq = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    /* SSE2 only has signed 16-bit min/max and multiply-add, so samples are biased by -0x8000 */
+    const __m128i bias = _mm_set1_epi16((int16_t)0x8000);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmin = _mm_set1_epi16(INT16_MAX);
+    __m128i vmax = _mm_set1_epi16(INT16_MIN);
+    __m128i vsum = zero;
+    __m128i vsq = zero;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)&in[i]);
+        __m128i s = _mm_xor_si128(x, bias);
+
+        vmin = _mm_min_epi16(vmin, s);
+        vmax = _mm_max_epi16(vmax, s);
+
+        /* Sum of the unsigned samples in 64-bit lanes */
+        __m128i lo = _mm_unpacklo_epi16(x, zero);
+        __m128i hi = _mm_unpackhi_epi16(x, zero);
+        __m128i s32 = _mm_add_epi32(lo, hi);
+        vsum = _mm_add_epi64(vsum, _mm_add_epi64(_mm_unpacklo_epi32(s32, zero), _mm_unpackhi_epi32(s32, zero)));
+
+        /* Pairs of squares of biased samples are at most 2^31, unsigned in 32 bits */
+        __m128i sq = _mm_madd_epi16(s, s);
+        vsq = _mm_add_epi64(vsq, _mm_add_epi64(_mm_unpacklo_epi32(sq, zero), _mm_unpackhi_epi32(sq, zero)));
+    }
+
+    if (i != 0) {
+        int16_t lanes_min[8], lanes_max[8];
+        uint64_t lanes_sum[2], lanes_sq[2];
+
+        _mm_storeu_si128((__m128i*)lanes_min, vmin);
+        _mm_storeu_si128((__m128i*)lanes_max, vmax);
+        _mm_storeu_si128((__m128i*)lanes_sum, vsum);
+        _mm_storeu_si128((__m128i*)lanes_sq, vsq);
+
+        for (uint8_t k = 0; k < 8; k++) {
+            uint16_t lmin = (uint16_t)(lanes_min[k] ^ 0x8000);
+            uint16_t lmax = (uint16_t)(lanes_max[k] ^ 0x8000);
+            min = lmin < min ? lmin : min;
+            max = lmax > max ? lmax : max;
+        }
+        sum = lanes_sum[0] + lanes_sum[1];
+
+        /* sum(x^2) = sum((x - c)^2) + 2c * sum(x) - i * c^2, c = 0x8000 */
+        sum_sq = lanes_sq[0] + lanes_sq[1] + (sum << 16) - ((uint64_t)i << 30);
+    }
+#endif
+
+    for (; i < n; i++) {
+        uint16_t x = in[i];
+
+        min = x < min ? x : min;
+        max = x > max ? x : max;
+        sum += x;
+        sum_sq += (uint32_t)x * x;
+    }
+
+    stats->min = min;
+    stats->max = max;
+    stats->mean = (uint16_t)((sum + n / 2) / n);
+    stats->rms = (uint16_t)adc_proc_isqrt((sum_sq + n / 2) / n);
+
+    return STATUS_OK;
+}
+
+/**
+ * Q15 dot product
+*/
+int32_t adc_proc_dot_q15(const int16_t* a, const int16_t* b, size_t n)
+{
+    int32_t acc = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i vacc = _mm_setzero_si128();
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i va = _mm_loadu_si128((const __m128i*)&a[i]);
+        __m128i vb = _mm_loadu_si128((const __m128i*)&b[i]);
+        vacc = _mm_add_epi32(vacc, _mm_madd_epi16(va, vb));
+    }
+
+    vacc = _mm_add_epi32(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(1, 0, 3, 2)));
+    vacc = _mm_add_epi32(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(2, 3, 0, 1)));
+    acc = _mm_cvtsi128_si32(vacc);
+#elif defined(__ARM_FEATURE_DSP)
+    /* Two 16-bit multiply-accumulates per instruction */
+    for (; i + 2 <= n; i += 2) {
+        int16x2_t va, vb;
+
+        memcpy(&va, &a[i], sizeof(va));
+        memcpy(&vb, &b[i], sizeof(vb));
+        acc = __smlad(va, vb, acc);
+    }
+#endif
+
+    for (; i < n; i++)
+        acc += (int32_t)a[i] * b[i];
+
+    return acc;
+}
+
+/**
+ * Initialize CIC state
+*/
+status_t adc_proc_cic_init(adc_proc_cic_t* cic, uint8_t order, uint16_t decimation, uint8_t shift)
+{
+    if (order == 0 || order > ADC_PROC_CIC_MAX_ORDER || decimation == 0 || shift > 31)
+        return STATUS_ERROR;
+
+    cic->order = order;
+    cic->decimation = decimation;
+    cic->shift = shift;
+    cic->phase = 0;
+    memset(cic->integrator, 0, sizeof(cic->integrator));
+    memset(cic->comb, 0, sizeof(cic->comb));
+
+    return STATUS_OK;
+}
+
+/**
+ * Integrate every sample, run the combs on every `decimation`-th one
+*/
+size_t adc_proc_cic_run(adc_proc_cic_t* cic, const uint16_t* in, size_t n, uint16_t* out)
+{
+    uint32_t integrator[ADC_PROC_CIC_MAX_ORDER];
+    uint8_t order = cic->order;
+    uint16_t phase = cic->phase;
+    size_t count = 0;
+
+    memcpy(integrator, cic->integrator, sizeof(integrator));
+
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = in[i];
+
+        for (uint8_t k = 0; k < order; k++) {
+            integrator[k] += x;
+            x = integrator[k];
+        }
+
+        if (++phase < cic->decimation)
+            continue;
+        phase = 0;
+
+        for (uint8_t k = 0; k < order; k++) {
+            uint32_t prev = cic->comb[k];
+            cic->comb[k] = x;
+            x -= prev;
+        }
+
+        x >>= cic->shift;
+        out[count++] = x > UINT16_MAX ? UINT16_MAX : (uint16_t)x;
+    }
+
+    memcpy(cic->integrator, integrator, sizeof(integrator));
+    cic->phase = phase;
+
+    return count;
+}
+
+/**
+ * Initialize FIR state
+*/
+status_t adc_proc_fir_init(adc_proc_fir_t* fir, const int16_t* taps, uint16_t ntaps,
+    uint16_t decimation, int16_t* state)
+{
+    if (taps == NULL || state == NULL || ntaps == 0 || decimation == 0)
+        return STATUS_ERROR;
+
+    fir->taps = taps;
+    fir->delay = state;
+    fir->ntaps = ntaps;
+    fir->decimation = decimation;
+    fir->pos = 0;
+    fir->phase = 0;
+    memset(state, 0, 2 * ntaps * sizeof(int16_t));
+
+    return STATUS_OK;
+}
+
+/**
+ * Push samples into the delay line, compute the output only for every `decimation`-th one
+*/
+size_t adc_proc_fir_run(adc_proc_fir_t* fir, const int16_t* in, size_t n, int16_t* out)
+{
+    uint16_t ntaps = fir->ntaps;
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        fir->pos = (fir->pos == 0 ? ntaps : fir->pos) - 1;
+        fir->delay[fir->pos] = in[i];
+        fir->delay[fir->pos + ntaps] = in[i];
+
+        if (++fir->phase < fir->decimation)
+            continue;
+        fir->phase = 0;
+
+        int32_t acc = adc_proc_dot_q15(fir->taps, &fir->delay[fir->pos], ntaps);
+        acc = (acc + (1 << 14)) >> 15;
+        out[count++] = acc > INT16_MAX ? INT16_MAX : acc < INT16_MIN ? INT16_MIN : (int16_t)acc;
+    }
+
+    return count;
+}
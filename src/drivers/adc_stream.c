@@ -0,0 +1,159 @@
+#include "drivers/adc_stream.h"
+
+/**
+ * Current DMA write position as a free running sample counter
+ *
+ * @note Lap count comes from the ISRs, position within the lap from the DMA counter,
+ * correct even if the DMA passed a half boundary whose ISR is still pending
+*/
+static uint32_t adc_stream_write_pos(adc_stream_t* stream)
+{
+    uint32_t written = (uint32_t)atomic_load_explicit(&stream->written, memory_order_acquire);
+    uint32_t dma = adc_dma_get_counter(stream->adc);
+
+    return written + (dma + stream->length - written % stream->length) % stream->length;
+}
+
+/**
+ * Initialize the stream structure
+*/
+status_t adc_stream_open(adc_stream_t* stream, adc_t adc, uint16_t* buffer, uint32_t length)
+{
+    /* Power of two keeps the offsets of the free running counters continuous across their wrap */
+    if (buffer == NULL || length < 2 || (length & (length - 1)) != 0)
+        return STATUS_ERROR;
+
+    stream->adc = adc;
+    stream->buffer = buffer;
+    stream->length = length;
+    atomic_init(&stream->written, 0);
+    stream->read_pos = 0;
+    stream->callback = NULL;
+    stream->arg = NULL;
+    atomic_init(&stream->lost, 0);
+    atomic_init(&stream->errors, 0);
+
+    return STATUS_OK;
+}
+
+/**
+ * Set the half buffer callback
+*/
+status_t adc_stream_set_callback(adc_stream_t* stream, adc_stream_callback_t callback, void* arg)
+{
+    stream->arg = arg;
+    stream->callback = callback;
+
+    return STATUS_OK;
+}
+
+/**
+ * Reset positions and start the circular DMA
+*/
+status_t adc_stream_start(adc_stream_t* stream)
+{
+    atomic_store(&stream->written, 0);
+    stream->read_pos = 0;
+
+    return STATUS_FROM_BOOL(adc_start_dma(stream->adc, (uint8_t*)stream->buffer, stream->length) == HAL_STATUS_OK);
+}
+
+/**
+ * Stop the DMA
+*/
+status_t adc_stream_stop(adc_stream_t* stream)
+{
+    return STATUS_FROM_BOOL(adc_stop_dma(stream->adc) == HAL_STATUS_OK);
+}
+
+/**
+ * Return the completed samples in place, skipping the ones the DMA already overwrote
+*/
+size_t adc_stream_read_span(adc_stream_t* stream, const uint16_t** samples)
+{
+    uint32_t write = adc_stream_write_pos(stream);
+    uint32_t used = write - stream->read_pos;
+
+    /* Oldest sample is being overwritten, keep only the last half to give the consumer time */
+    if (used >= stream->length) {
+        uint32_t skip = used - stream->length / 2;
+        atomic_fetch_add_explicit(&stream->lost, skip, memory_order_relaxed);
+        stream->read_pos += skip;
+        used -= skip;
+    }
+
+    uint32_t offset = stream->read_pos % stream->length;
+    uint32_t to_end = stream->length - offset;
+
+    *samples = &stream->buffer[offset];
+    return used < to_end ? used : to_end;
+}
+
+/**
+ * Advance the read position, checking the DMA did not lap the released samples
+*/
+status_t adc_stream_release(adc_stream_t* stream, size_t count)
+{
+    uint32_t write = adc_stream_write_pos(stream);
+    status_t status = STATUS_OK;
+
+    if (write - stream->read_pos >= stream->length) {
+        atomic_fetch_add_explicit(&stream->lost, count, memory_order_relaxed);
+        status = STATUS_ERROR;
+    }
+    stream->read_pos += count;
+
+    return status;
+}
+
+/**
+ * Lost samples counter
+*/
+uint32_t adc_stream_get_lost(adc_stream_t* stream)
+{
+    return (uint32_t)atomic_load_explicit(&stream->lost, memory_order_relaxed);
+}
+
+/**
+ * Error counter
+*/
+uint32_t adc_stream_get_errors(adc_stream_t* stream)
+{
+    return (uint32_t)atomic_load_explicit(&stream->errors, memory_order_relaxed);
+}
+
+/**
+ * Count the filled half and pass it to the callback
+*/
+static void adc_stream_half_filled(adc_stream_t* stream, uint32_t offset)
+{
+    uint32_t half = stream->length / 2;
+
+    atomic_fetch_add_explicit(&stream->written, half, memory_order_release);
+    if (stream->callback != NULL)
+        stream->callback(stream->arg, &stream->buffer[offset], half);
+}
+
+/**
+ * First half filled
+*/
+void adc_stream_half_isr(adc_stream_t* stream)
+{
+    adc_stream_half_filled(stream, 0);
+}
+
+/**
+ * Second half filled
+*/
+void adc_stream_full_isr(adc_stream_t* stream)
+{
+    adc_stream_half_filled(stream, stream->length / 2);
+}
+
+/**
+ * Count the error, sampling continues in circular mode
+*/
+void adc_stream_error_isr(adc_stream_t* stream)
+{
+    atomic_fetch_add_explicit(&stream->errors, 1, memory_order_relaxed);
+}
@@ -0,0 +1,169 @@
+#include "drivers/board.h"
+
+/**
+ * Find the root bus of a bus by walking up through the multiplexer channels
+*/
+static i2c_t* board_root_bus(const board_t* board, i2c_t* bus)
+{
+    /* Bounded by the number of channels in case of a cycle in the tables */
+    for (size_t depth = 0; depth <= board->n_channels; depth++) {
+        size_t i;
+
+        for (i = 0; i < board->n_channels; i++) {
+            if (board->channels[i].bus == bus)
+                break;
+        }
+        if (i == board->n_channels)
+            return bus;
+
+        bus = i2c_mux_get_in_bus(board->channels[i].mux);
+    }
+
+    return NULL;
+}
+
+/**
+ * Probe and initialize a device
+*/
+static void board_bring_up(board_t* board, size_t index)
+{
+    const board_device_t* dev = &board->devices[index];
+
+    status_t status = sdev_test(dev->device);
+    if (status == STATUS_OK && dev->init != NULL)
+        status = dev->init(dev->driver, dev->device);
+
+    board->results[index] = status;
+}
+
+/**
+ * Bring up the devices of a root bus, first the ones connected directly and then
+ * the ones behind each multiplexer channel, so every channel is selected once.
+ * Yields after each device so coroutine lanes take turns, the bring-up itself blocks.
+*/
+static coro_status_t board_lane_run(coro_task_t* task)
+{
+    board_lane_t* lane = CORO_TASK_ENTRY(task, board_lane_t, task);
+    board_t* board = lane->board;
+
+    CORO_BEGIN(&task->coro);
+    lane->bus = lane->root;
+    lane->channel = 0;
+
+    for (;;) {
+        for (lane->device = 0; lane->device < board->n_devices; lane->device++) {
+            if (board->devices[lane->device].bus != lane->bus)
+                continue;
+
+            board_bring_up(board, lane->device);
+            CORO_YIELD(&task->coro);
+        }
+
+        while (lane->channel < board->n_channels &&
+            board_root_bus(board, board->channels[lane->channel].bus) != lane->root)
+            lane->channel++;
+
+        if (lane->channel == board->n_channels)
+            break;
+        lane->bus = board->channels[lane->channel++].bus;
+    }
+
+    atomic_fetch_sub_explicit(&board->running, 1, memory_order_release);
+    CORO_END(&task->coro);
+}
+
+#ifdef BOARD_LANE_START
+/**
+ * Lane thread, runs the lane coroutine to the end
+*/
+static void* board_lane_thread(void* arg)
+{
+    board_lane_t* lane = (board_lane_t*)arg;
+
+    while (board_lane_run(&lane->task) != CORO_DONE)
+        ;
+
+    return NULL;
+}
+#endif
+
+/**
+ * Open the whole tree without any bus transactions, then start one lane per root bus
+ * and wait for all of them
+*/
+status_t board_init(board_t* board)
+{
+    for (size_t i = 0; i < board->n_buses; i++) {
+        const board_bus_t* entry = &board->buses[i];
+
+        if (i2c_open(entry->bus, entry->ops, entry->context) != STATUS_OK)
+            return STATUS_ERROR;
+    }
+
+    for (size_t i = 0; i < board->n_muxes; i++) {
+        const board_mux_t* entry = &board->muxes[i];
+
+        if (entry->open == NULL || entry->open(entry->mux, entry->in_bus) != STATUS_OK)
+            return STATUS_ERROR;
+    }
+
+    for (size_t i = 0; i < board->n_channels; i++) {
+        const board_mux_channel_t* entry = &board->channels[i];
+
+        if (i2c_mux_ch_as_bus(entry->mux, entry->bus, entry->ch) != STATUS_OK)
+            return STATUS_ERROR;
+    }
+
+    for (size_t i = 0; i < board->n_devices; i++) {
+        const board_device_t* entry = &board->devices[i];
+
+        /* Devices outside of the tree are never brought up */
+        board->results[i] = STATUS_ERROR;
+        if (i2c_sdev_open(entry->bus, entry->device, entry->context, entry->addr) != STATUS_OK)
+            return STATUS_ERROR;
+    }
+
+    atomic_store_explicit(&board->running, (unsigned int)board->n_buses, memory_order_relaxed);
+#ifndef BOARD_LANE_START
+    coro_sched_init(&board->sched, NULL);
+#endif
+
+    for (size_t i = 0; i < board->n_buses; i++) {
+        board_lane_t* lane = &board->lanes[i];
+
+        lane->board = board;
+        lane->root = board->buses[i].bus;
+#ifdef BOARD_LANE_START
+        CORO_INIT(&lane->task.coro);
+        if (BOARD_LANE_START(board_lane_thread, lane) != 0)
+            board_lane_thread(lane);
+#else
+        coro_task_start(&board->sched, &lane->task, board_lane_run);
+#endif
+    }
+
+    while (atomic_load_explicit(&board->running, memory_order_acquire) != 0) {
+#ifdef BOARD_LANE_START
+        BOARD_LANE_WAIT();
+#else
+        coro_sched_poll(&board->sched);
+#endif
+    }
+
+    for (size_t i = 0; i < board->n_devices; i++) {
+        if (board->results[i] != STATUS_OK)
+            return STATUS_ERROR;
+    }
+
+    return STATUS_OK;
+}
+
+status_t board_get_status(board_t* board, sdev_t* device)
+{
+    for (size_t i = 0; i < board->n_devices; i++) {
+        if (board->devices[i].device == device)
+            return board->results[i];
+    }
+
+    return STATUS_ERROR;
+}
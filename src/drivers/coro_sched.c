@@ -0,0 +1,142 @@
+#include "drivers/coro_sched.h"
+
+status_t coro_sched_init(coro_sched_t* sched, swtimer_wheel_t* wheel)
+{
+    mpsc_init(&sched->ready);
+    sched->marker_queued = 0;
+    sched->wheel = wheel;
+
+    return STATUS_OK;
+}
+
+/**
+ * The queued flag is cleared before the task runs, so a wake during the run queues it again.
+ * Wakes are pushed behind the marker, the poll ends when it pops the marker.
+*/
+size_t coro_sched_poll(coro_sched_t* sched)
+{
+    mpsc_node_t* node;
+    size_t count = 0;
+
+    /* Still queued if the last poll stopped at a producer in the middle of a push */
+    if (!sched->marker_queued) {
+        sched->marker_queued = 1;
+        mpsc_push(&sched->ready, &sched->marker);
+    }
+
+    while ((node = mpsc_pop(&sched->ready)) != NULL) {
+        if (node == &sched->marker) {
+            sched->marker_queued = 0;
+            break;
+        }
+
+        coro_task_t* task = MPSC_ENTRY(node, coro_task_t, node);
+
+        atomic_store_explicit(&task->queued, 0, memory_order_seq_cst);
+        count++;
+
+        if (task->done)
+            continue;
+
+        switch (task->fn(task)) {
+        case CORO_DONE:
+            task->done = 1;
+            break;
+        case CORO_YIELDED:
+            coro_task_wake(task);
+            break;
+        case CORO_WAITING:
+            break;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Timer callback, runs in the wheel ISR
+*/
+static void coro_task_timer_expired(void* arg)
+{
+    coro_task_t* task = (coro_task_t*)arg;
+
+    atomic_store_explicit(&task->timer_expired, 1, memory_order_release);
+    coro_task_wake(task);
+}
+
+status_t coro_task_start(coro_sched_t* sched, coro_task_t* task, coro_fn_t fn)
+{
+    if (fn == NULL)
+        return STATUS_ERROR;
+
+    CORO_INIT(&task->coro);
+    task->fn = fn;
+    task->sched = sched;
+    task->done = 0;
+    atomic_init(&task->queued, 0);
+    atomic_init(&task->timer_expired, 0);
+    swtimer_init(&task->timer, coro_task_timer_expired, task);
+
+    coro_task_wake(task);
+
+    return STATUS_OK;
+}
+
+void coro_task_wake(coro_task_t* task)
+{
+    if (!atomic_exchange_explicit(&task->queued, 1, memory_order_acq_rel))
+        mpsc_push(&task->sched->ready, &task->node);
+}
+
+uint8_t coro_task_done(coro_task_t* task)
+{
+    return task->done;
+}
+
+void coro_task_sleep(coro_task_t* task, uint32_t ticks)
+{
+    atomic_store_explicit(&task->timer_expired, 0, memory_order_relaxed);
+
+    if (ticks == 0 || task->sched->wheel == NULL ||
+        swtimer_start(task->sched->wheel, &task->timer, ticks, 0) != STATUS_OK) {
+        /* Nothing to wait for, continue on the next poll */
+        atomic_store_explicit(&task->timer_expired, 1, memory_order_relaxed);
+        coro_task_wake(task);
+    }
+}
+
+uint8_t coro_task_slept(coro_task_t* task)
+{
+    return atomic_load_explicit(&task->timer_expired, memory_order_acquire);
+}
+
+void coro_completion_arm(coro_completion_t* completion, coro_task_t* task)
+{
+    completion->waiter = task;
+    completion->status = STATUS_OK;
+    atomic_store_explicit(&completion->done, 0, memory_order_relaxed);
+}
+
+void coro_completion_signal(coro_completion_t* completion, status_t status)
+{
+    completion->status = status;
+    atomic_store_explicit(&completion->done, 1, memory_order_release);
+
+    if (completion->waiter != NULL)
+        coro_task_wake(completion->waiter);
+}
+
+void coro_completion_callback(status_t status, void* arg)
+{
+    coro_completion_signal((coro_completion_t*)arg, status);
+}
+
+uint8_t coro_completion_done(coro_completion_t* completion)
+{
+    return atomic_load_explicit(&completion->done, memory_order_acquire);
+}
+
+status_t coro_completion_status(coro_completion_t* completion)
+{
+    return completion->status;
+}
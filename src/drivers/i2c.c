@@ -1,13 +1,353 @@
+#include <string.h>
 #include "drivers/i2c.h"
 #include "drivers/sdev.h"
 
 /**
- * I2C driver structure
+ * Bus handlers, called directly if bound statically (see `DRIVERS_BINDING_HEADER`)
 */
-typedef struct i2c {
-    i2c_ops_t* ops;
-    void* context;
-} i2c_t;
+#ifdef I2C_BIND_WRITE
+#define I2C_BUS_WRITE(i2c, addr, data, nbyte)   I2C_BIND_WRITE((i2c)->context, addr, data, nbyte)
+#else
+#define I2C_BUS_WRITE(i2c, addr, data, nbyte)   (i2c)->ops->write((i2c)->context, addr, data, nbyte)
+#endif
+
+#ifdef I2C_BIND_READ
+#define I2C_BUS_READ(i2c, addr, data, nbyte)    I2C_BIND_READ((i2c)->context, addr, data, nbyte)
+#else
+#define I2C_BUS_READ(i2c, addr, data, nbyte)    (i2c)->ops->read((i2c)->context, addr, data, nbyte)
+#endif
+
+#ifdef I2C_BIND_DEV_PROBE
+#define I2C_BUS_DEV_PROBE(i2c, addr)            I2C_BIND_DEV_PROBE((i2c)->context, addr)
+#else
+#define I2C_BUS_DEV_PROBE(i2c, addr)            (i2c)->ops->dev_probe((i2c)->context, addr)
+#endif
+
+/**
+ * Clear the retry state, `seed` only has to differ between buses
+*/
+static void i2c_retry_init(i2c_retry_t* retry, uint32_t seed)
+{
+    retry->policy = NULL;
+    retry->stats = (i2c_retry_stats_t){0};
+    retry->streak = 0;
+    retry->seed = seed | 1;
+}
+
+/**
+ * Xorshift step for the backoff jitter
+*/
+static uint32_t i2c_retry_random(i2c_retry_t* retry)
+{
+    uint32_t x = retry->seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    retry->seed = x;
+
+    return x;
+}
+
+/**
+ * Add the counts of one transaction to the statistics
+*/
+static void i2c_retry_add(i2c_retry_stats_t* stats, const i2c_retry_stats_t* delta)
+{
+    stats->transactions += delta->transactions;
+    stats->retries += delta->retries;
+    stats->failures += delta->failures;
+    stats->fail_fast += delta->fail_fast;
+    stats->backoff_us += delta->backoff_us;
+}
+
+/**
+ * Vectored write for buses without a writev handler, gathers the segments into one transaction
+*/
+static status_t i2c_writev_gather(i2c_t* i2c, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    uint8_t bounce[SDEV_IOV_BOUNCE_LEN];
+    size_t total = 0;
+
+    if (iovcnt == 1)
+        return I2C_BUS_WRITE(i2c, addr, iov[0].data, iov[0].nbyte);
+
+    for (size_t i = 0; i < iovcnt; i++) {
+        if (iov[i].nbyte > SDEV_IOV_BOUNCE_LEN - total)
+            return STATUS_ERROR;
+        memcpy(bounce + total, iov[i].data, iov[i].nbyte);
+        total += iov[i].nbyte;
+    }
+
+    return I2C_BUS_WRITE(i2c, addr, bounce, total);
+}
+
+/**
+ * Vectored read for buses without a readv handler, scatters one transaction to the segments
+*/
+static status_t i2c_readv_scatter(i2c_t* i2c, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    uint8_t bounce[SDEV_IOV_BOUNCE_LEN];
+    size_t total = 0;
+
+    if (iovcnt == 1)
+        return I2C_BUS_READ(i2c, addr, iov[0].data, iov[0].nbyte);
+
+    for (size_t i = 0; i < iovcnt; i++) {
+        if (iov[i].nbyte > SDEV_IOV_BOUNCE_LEN - total)
+            return STATUS_ERROR;
+        total += iov[i].nbyte;
+    }
+
+    if (I2C_BUS_READ(i2c, addr, bounce, total) != STATUS_OK)
+        return STATUS_ERROR;
+
+    total = 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        memcpy(iov[i].data, bounce + total, iov[i].nbyte);
+        total += iov[i].nbyte;
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * Single attempt using the implementation specific handler
+*/
+static status_t i2c_attempt(i2c_t* i2c, i2c_op_t op, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    const sdev_iovec_t* iov = (const sdev_iovec_t*)data;
+
+    switch (op) {
+    case I2C_OP_WRITE:
+        return I2C_BUS_WRITE(i2c, addr, data, nbyte);
+    case I2C_OP_READ:
+        return I2C_BUS_READ(i2c, addr, data, nbyte);
+    case I2C_OP_DEV_PROBE:
+        return I2C_BUS_DEV_PROBE(i2c, addr);
+    case I2C_OP_WRITEV:
+        if (i2c->ops->writev != NULL)
+            return i2c->ops->writev(i2c->context, addr, iov, nbyte);
+        return i2c_writev_gather(i2c, addr, iov, nbyte);
+    case I2C_OP_READV:
+        if (i2c->ops->readv != NULL)
+            return i2c->ops->readv(i2c->context, addr, iov, nbyte);
+        return i2c_readv_scatter(i2c, addr, iov, nbyte);
+    default:
+        return STATUS_ERROR;
+    }
+}
+
+/**
+ * Attempt the transaction until it succeeds, the tries run out or the target
+ * is failing fast, backing off exponentially between the attempts
+*/
+status_t i2c_transfer(i2c_t* i2c, i2c_retry_t* device, i2c_op_t op, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    i2c_retry_t* target = device != NULL ? device : &i2c->retry;
+    const i2c_retry_policy_t* policy = target->policy != NULL ? target->policy : i2c->retry.policy;
+    i2c_retry_stats_t delta = { .transactions = 1 };
+    status_t status = STATUS_ERROR;
+    uint8_t tries = 1;
+    uint32_t backoff = 0;
+    uint16_t timeout = 0;
+
+    if (policy != NULL) {
+        if (policy->tries > 1)
+            tries = policy->tries;
+        backoff = policy->backoff_us;
+
+        if (policy->fail_fast_after != 0 && target->streak >= policy->fail_fast_after && tries > 1) {
+            tries = 1;
+            delta.fail_fast = 1;
+        }
+
+        timeout = policy->timeout_ms;
+    }
+
+    /* Timeout of a device policy must not stay for the transactions of other devices */
+    if (timeout == 0 && i2c->retry.policy != NULL)
+        timeout = i2c->retry.policy->timeout_ms;
+    if (timeout != i2c->timeout_ms && i2c->ops->set_timeout != NULL
+        && i2c->ops->set_timeout(i2c->context, timeout) == STATUS_OK)
+        i2c->timeout_ms = timeout;
+
+    for (uint8_t attempt = 1;; attempt++) {
+        status = i2c_attempt(i2c, op, addr, data, nbyte);
+
+        if (status == STATUS_OK || attempt >= tries)
+            break;
+
+        uint32_t wait = backoff;
+        if (policy->jitter && wait > 1)
+            wait = wait / 2 + i2c_retry_random(&i2c->retry) % (wait - wait / 2 + 1);
+
+        I2C_RETRY_BACKOFF(wait);
+        delta.retries++;
+        delta.backoff_us += wait;
+
+        backoff = backoff > policy->backoff_max_us / 2 ? policy->backoff_max_us : backoff * 2;
+    }
+
+    if (status == STATUS_OK) {
+        target->streak = 0;
+    } else {
+        if (target->streak < UINT8_MAX)
+            target->streak++;
+        delta.failures = 1;
+    }
+
+    i2c_retry_add(&i2c->retry.stats, &delta);
+    if (device != NULL)
+        i2c_retry_add(&device->stats, &delta);
+
+    return status;
+}
+
+/**
+ * Without the backoff hook retries would be immediate, so backoff delays can not be honoured
+*/
+static status_t i2c_retry_policy_check(const i2c_retry_policy_t* policy)
+{
+    if (policy != NULL && policy->backoff_us != 0 && !I2C_RETRY_HAS_BACKOFF)
+        return STATUS_ERROR;
+
+    return STATUS_OK;
+}
+
+status_t i2c_set_retry_policy(i2c_t* i2c, const i2c_retry_policy_t* policy)
+{
+    if (i2c_retry_policy_check(policy) != STATUS_OK)
+        return STATUS_ERROR;
+
+    i2c->retry.policy = policy;
+    i2c->retry.streak = 0;
+
+    return STATUS_OK;
+}
+
+void i2c_get_retry_stats(i2c_t* i2c, i2c_retry_stats_t* stats)
+{
+    *stats = i2c->retry.stats;
+}
+
+status_t i2c_sdev_set_retry_policy(i2c_sdev_context_t* context, const i2c_retry_policy_t* policy)
+{
+    if (i2c_retry_policy_check(policy) != STATUS_OK)
+        return STATUS_ERROR;
+
+    context->retry.policy = policy;
+    context->retry.streak = 0;
+
+    return STATUS_OK;
+}
+
+void i2c_sdev_get_retry_stats(i2c_sdev_context_t* context, i2c_retry_stats_t* stats)
+{
+    *stats = context->retry.stats;
+}
+
+/**
+ * Step a moving average towards `sample`
+*/
+static uint32_t i2c_health_ewma(uint32_t average, uint32_t sample)
+{
+    if (sample >= average)
+        return average + ((sample - average) >> I2C_HEALTH_EWMA_SHIFT);
+
+    return average - ((average - sample) >> I2C_HEALTH_EWMA_SHIFT);
+}
+
+/**
+ * Update the averages with a finished transaction and move the device between states
+*/
+static void i2c_health_record(i2c_health_t* health, status_t status, uint32_t latency, uint32_t now)
+{
+    const i2c_health_policy_t* policy = health->policy;
+    i2c_health_stats_t* stats = &health->stats;
+
+    stats->error_rate = i2c_health_ewma(stats->error_rate, status == STATUS_OK ? 0 : 65536u);
+    stats->latency = i2c_health_ewma(stats->latency, latency);
+
+    if (policy == NULL)
+        return;
+
+    if (stats->error_rate >= policy->error_rate_quarantine ||
+        (policy->latency_quarantine != 0 && stats->latency >= policy->latency_quarantine)) {
+        if (stats->state != I2C_HEALTH_QUARANTINED) {
+            stats->state = I2C_HEALTH_QUARANTINED;
+            stats->quarantines++;
+            health->last_probe = now;
+        }
+    } else if (stats->error_rate >= policy->error_rate_degraded ||
+        (policy->latency_degraded != 0 && stats->latency >= policy->latency_degraded)) {
+        stats->state = I2C_HEALTH_DEGRADED;
+    } else {
+        stats->state = I2C_HEALTH_OK;
+    }
+}
+
+/**
+ * Current time of the health tracker
+*/
+static uint32_t i2c_health_now(i2c_health_t* health)
+{
+#if I2C_HEALTH_HAS_TIMESTAMP
+    UNUSED(health);
+    return (uint32_t)I2C_HEALTH_TIMESTAMP();
+#else
+    return health->operations;
+#endif
+}
+
+/**
+ * Fail quarantined devices right away, except for a periodic probe which releases them.
+ * A released device starts at the degraded threshold, so it is quarantined again
+ * quickly if it keeps failing.
+*/
+status_t i2c_sdev_transfer(i2c_sdev_context_t* context, i2c_op_t op, uint8_t* data, size_t nbyte)
+{
+    i2c_health_t* health = &context->health;
+
+    health->operations++;
+    uint32_t start = i2c_health_now(health);
+
+    if (health->stats.state == I2C_HEALTH_QUARANTINED) {
+        if (start - health->last_probe < health->policy->reprobe_interval) {
+            health->stats.rejected++;
+            return STATUS_ERROR;
+        }
+
+        health->last_probe = start;
+        if (i2c_dev_probe(context->bus, context->addr) != STATUS_OK) {
+            health->stats.rejected++;
+            return STATUS_ERROR;
+        }
+
+        health->stats.state = I2C_HEALTH_DEGRADED;
+        health->stats.error_rate = health->policy->error_rate_degraded;
+        health->stats.latency = 0;
+        start = i2c_health_now(health);
+    }
+
+    status_t status = i2c_transfer(context->bus, &context->retry, op, context->addr, data, nbyte);
+    uint32_t end = i2c_health_now(health);
+
+    i2c_health_record(health, status, end - start, end);
+
+    return status;
+}
+
+void i2c_sdev_set_health_policy(i2c_sdev_context_t* context, const i2c_health_policy_t* policy)
+{
+    context->health.policy = policy;
+    context->health.stats.state = I2C_HEALTH_OK;
+}
+
+void i2c_sdev_get_health(i2c_sdev_context_t* context, i2c_health_stats_t* stats)
+{
+    *stats = context->health.stats;
+}
 
 /**
  * Initialize i2c structure
@@ -19,74 +359,121 @@ status_t i2c_open(i2c_t* i2c, i2c_ops_t* ops, void* context)
     /* Can check here which ops are implemented and set flags accordingly if needed */
     i2c->ops = ops;
     i2c->context = context;
+    i2c_retry_init(&i2c->retry, (uint32_t)(uintptr_t)i2c);
+    i2c->timeout_ms = 0;
 
     return STATUS_OK;
 }
 
+#ifdef DRIVERS_USE_POOL
+POOL_DEFINE(static, i2c_pool, i2c_t, I2C_POOL_SIZE);
+POOL_DEFINE(static, i2c_sdev_pool, i2c_sdev_context_t, I2C_SDEV_POOL_SIZE);
+
 /**
- * Call the implementation specific write handler
- * @todo Maybe can be implemented as `#define` or `static inline`
+ * Allocate and initialize an I2C structure
 */
-status_t i2c_write(i2c_t* i2c, uint8_t addr, uint8_t* data, size_t nbyte)
+i2c_t* i2c_open_dynamic(i2c_ops_t* ops, void* context)
 {
-    return i2c->ops->write(i2c->context, addr, data, nbyte);
+    i2c_t* i2c = (i2c_t*)pool_alloc(&i2c_pool);
+
+    if (i2c == NULL)
+        return NULL;
+
+    if (i2c_open(i2c, ops, context) != STATUS_OK) {
+        pool_free(&i2c_pool, i2c);
+        return NULL;
+    }
+
+    return i2c;
 }
 
 /**
- * Call the implementation specific read handler
- * @todo Maybe can be implemented as `#define` or `static inline`
+ * Return the I2C structure to the pool
 */
-status_t i2c_read(i2c_t* i2c, uint8_t addr, uint8_t* data, size_t nbyte)
+status_t i2c_close(i2c_t* i2c)
 {
-    return i2c->ops->read(i2c->context, addr, data, nbyte);
+    return pool_free(&i2c_pool, i2c);
 }
 
 /**
- * Call the implementation specific dev_probe handler
- * @todo Maybe can be implemented as `#define` or `static inline`
+ * Get usage statistics of the I2C pool
 */
-status_t i2c_dev_probe(i2c_t* i2c, uint8_t addr)
+void i2c_pool_get_stats(pool_stats_t* stats)
 {
-    return i2c->ops->dev_probe(i2c->context, addr);
+    pool_get_stats(&i2c_pool, stats);
 }
 
+/**
+ * Get usage statistics of the I2C serial device context pool
+*/
+void i2c_sdev_pool_get_stats(pool_stats_t* stats)
+{
+    pool_get_stats(&i2c_sdev_pool, stats);
+}
+#endif
 
 /**
- * Additional data for serial devices connected to an I2C
+ * Call the implementation specific write handler with the retry policy of the bus
 */
-typedef struct i2c_sdev_context {
-    i2c_t* bus;
-    uint8_t addr;
-} i2c_sdev_context_t;
+status_t i2c_write(i2c_t* i2c, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    return i2c_transfer(i2c, NULL, I2C_OP_WRITE, addr, data, nbyte);
+}
 
 /**
- * Serial device write handler for a device connected to an I2C
+ * Call the implementation specific read handler with the retry policy of the bus
 */
-static status_t i2c_sdev_write(void* context, uint8_t* data, size_t len)
+status_t i2c_read(i2c_t* i2c, uint8_t addr, uint8_t* data, size_t nbyte)
 {
-    i2c_sdev_context_t* params = (i2c_sdev_context_t*)context;
+    return i2c_transfer(i2c, NULL, I2C_OP_READ, addr, data, nbyte);
+}
 
-    return i2c_write(params->bus, params->addr, data, len);
+/**
+ * Call the implementation specific writev handler with the retry policy of the bus
+*/
+status_t i2c_writev(i2c_t* i2c, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    return i2c_transfer(i2c, NULL, I2C_OP_WRITEV, addr, (uint8_t*)iov, iovcnt);
 }
 
 /**
- * Serial device read handler for a device connected to an I2C
+ * Call the implementation specific readv handler with the retry policy of the bus
 */
-static status_t i2c_sdev_read(void* context, uint8_t* data, size_t len)
+status_t i2c_readv(i2c_t* i2c, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
 {
-    i2c_sdev_context_t* params = (i2c_sdev_context_t*)context;
+    return i2c_transfer(i2c, NULL, I2C_OP_READV, addr, (uint8_t*)iov, iovcnt);
+}
 
-    return i2c_read(params->bus, params->addr, data, len);
+/**
+ * Call the implementation specific dev_probe handler with the retry policy of the bus
+*/
+status_t i2c_dev_probe(i2c_t* i2c, uint8_t addr)
+{
+    return i2c_transfer(i2c, NULL, I2C_OP_DEV_PROBE, addr, NULL, 0);
 }
 
 /**
- * Serial device test handler for a device connected to an I2C
+ * Single attempt, a poll which is not acknowledged yet is not a failure of the bus
 */
-static status_t i2c_sdev_test(void* context)
+status_t i2c_dev_poll(i2c_t* i2c, uint8_t addr)
 {
-    i2c_sdev_context_t* params = (i2c_sdev_context_t*)context;
+    return i2c_attempt(i2c, I2C_OP_DEV_PROBE, addr, NULL, 0);
+}
 
-    return i2c_dev_probe(params->bus, params->addr);
+/**
+ * Serial device writev handler for a device connected to an I2C
+*/
+static status_t i2c_sdev_writev(void* context, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    return i2c_sdev_transfer((i2c_sdev_context_t*)context, I2C_OP_WRITEV, (uint8_t*)iov, iovcnt);
+}
+
+/**
+ * Serial device readv handler for a device connected to an I2C
+*/
+static status_t i2c_sdev_readv(void* context, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    return i2c_sdev_transfer((i2c_sdev_context_t*)context, I2C_OP_READV, (uint8_t*)iov, iovcnt);
 }
 
 /**
@@ -94,12 +481,13 @@ static status_t i2c_sdev_test(void* context)
 */
 static status_t i2c_sdev_close(void* context)
 {
-    i2c_sdev_context_t* params = (i2c_sdev_context_t*)context;
-    
-    /** 
-     * @todo Rename this function to `i2c_sdev_close_static` once added separate functions
-     * `i2c_sdev_open_static` and `i2c_sdev_open`, so that `i2c_sdev_close` for dynamic allocation can free the memory
-     */
+    /* Statically allocated contexts are left to the user */
+#ifdef DRIVERS_USE_POOL
+    if (pool_owns(&i2c_sdev_pool, context))
+        pool_free(&i2c_sdev_pool, context);
+#else
+    UNUSED(context);
+#endif
 
     return STATUS_OK;
 }
@@ -115,6 +503,8 @@ status_t i2c_sdev_open(i2c_t* i2c, sdev_t* device, i2c_sdev_context_t* context,
         .test = &i2c_sdev_test,
         .write = &i2c_sdev_write,
         .read = &i2c_sdev_read,
+        .writev = &i2c_sdev_writev,
+        .readv = &i2c_sdev_readv,
         .close = &i2c_sdev_close,
         .ioctl = NULL
     };
@@ -123,6 +513,36 @@ status_t i2c_sdev_open(i2c_t* i2c, sdev_t* device, i2c_sdev_context_t* context,
         return STATUS_ERROR;
     context->bus = i2c;
     context->addr = addr;
+    i2c_retry_init(&context->retry, addr);
+    context->health.policy = NULL;
+    context->health.stats = (i2c_health_stats_t){0};
+    context->health.last_probe = 0;
+    context->health.operations = 0;
 
     return sdev_open(device, &i2c_sdev_ops, context);
-}
\ No newline at end of file
+}
+
+#ifdef DRIVERS_USE_POOL
+/**
+ * Allocate the device and its context and initialize them for a device with the given address
+*/
+sdev_t* i2c_sdev_open_dynamic(i2c_t* i2c, uint8_t addr)
+{
+    i2c_sdev_context_t* context = (i2c_sdev_context_t*)pool_alloc(&i2c_sdev_pool);
+
+    if (context == NULL)
+        return NULL;
+
+    /* Ops are set by i2c_sdev_open below, this only reserves the structure */
+    sdev_t* device = sdev_open_dynamic(NULL, NULL);
+
+    if (device == NULL) {
+        pool_free(&i2c_sdev_pool, context);
+        return NULL;
+    }
+
+    i2c_sdev_open(i2c, device, context, addr);
+
+    return device;
+}
+#endif
\ No newline at end of file
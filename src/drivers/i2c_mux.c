@@ -1,23 +1,12 @@
 #include "drivers/i2c_mux.h"
 #include "drivers/i2c.h"
 
-/**
- * I2C multiplexer driver structure
-*/
-typedef struct i2c_mux {
-    i2c_mux_ch_t selected;
-    i2c_t* in_bus;
-    uint8_t n_out_bus;
-    i2c_mux_ops_t* ops;
-    void* context;
-} i2c_mux_t;
-
 /**
  * Initialize i2c_mux structure
 */
 status_t i2c_mux_open(i2c_mux_t* mux, i2c_t* in, uint8_t nout, i2c_mux_ops_t* ops, void* context)
 {
-    if (ops == NULL)
+    if (ops == NULL || nout > I2C_MUX_CH_NONE)
         return STATUS_ERROR;
 
     mux->selected = I2C_MUX_CH_NONE;
@@ -30,6 +19,44 @@ status_t i2c_mux_open(i2c_mux_t* mux, i2c_t* in, uint8_t nout, i2c_mux_ops_t* op
     return STATUS_OK;
 }
 
+#ifdef DRIVERS_USE_POOL
+POOL_DEFINE(static, i2c_mux_pool, i2c_mux_t, I2C_MUX_POOL_SIZE);
+
+/**
+ * Allocate and initialize an i2c_mux structure
+*/
+i2c_mux_t* i2c_mux_open_dynamic(i2c_t* in, uint8_t nout, i2c_mux_ops_t* ops, void* context)
+{
+    i2c_mux_t* mux = (i2c_mux_t*)pool_alloc(&i2c_mux_pool);
+
+    if (mux == NULL)
+        return NULL;
+
+    if (i2c_mux_open(mux, in, nout, ops, context) != STATUS_OK) {
+        pool_free(&i2c_mux_pool, mux);
+        return NULL;
+    }
+
+    return mux;
+}
+
+/**
+ * Return the i2c_mux structure to the pool
+*/
+status_t i2c_mux_close(i2c_mux_t* mux)
+{
+    return pool_free(&i2c_mux_pool, mux);
+}
+
+/**
+ * Get usage statistics of the I2C multiplexer pool
+*/
+void i2c_mux_pool_get_stats(pool_stats_t* stats)
+{
+    pool_get_stats(&i2c_mux_pool, stats);
+}
+#endif
+
 /**
  * Select output channel (if different then currently selected)
 */
@@ -47,4 +74,84 @@ status_t i2c_mux_ch_select(i2c_mux_t* mux, i2c_mux_ch_t ch)
     }
 
     return STATUS_ERROR;
-}
\ No newline at end of file
+}
+
+/**
+ * Get input bus reference
+*/
+i2c_t* i2c_mux_get_in_bus(i2c_mux_t* mux)
+{
+    return mux->in_bus;
+}
+
+static status_t i2c_mux_bus_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    i2c_mux_bus_context_t* params = (i2c_mux_bus_context_t*)context;
+
+    if (i2c_mux_ch_select(params->mux, params->ch) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return i2c_write(params->mux->in_bus, addr, data, nbyte);
+}
+
+static status_t i2c_mux_bus_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    i2c_mux_bus_context_t* params = (i2c_mux_bus_context_t*)context;
+
+    if (i2c_mux_ch_select(params->mux, params->ch) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return i2c_read(params->mux->in_bus, addr, data, nbyte);
+}
+
+static status_t i2c_mux_bus_writev(void* context, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    i2c_mux_bus_context_t* params = (i2c_mux_bus_context_t*)context;
+
+    if (i2c_mux_ch_select(params->mux, params->ch) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return i2c_writev(params->mux->in_bus, addr, iov, iovcnt);
+}
+
+static status_t i2c_mux_bus_readv(void* context, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    i2c_mux_bus_context_t* params = (i2c_mux_bus_context_t*)context;
+
+    if (i2c_mux_ch_select(params->mux, params->ch) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return i2c_readv(params->mux->in_bus, addr, iov, iovcnt);
+}
+
+static status_t i2c_mux_bus_dev_probe(void* context, uint8_t addr)
+{
+    i2c_mux_bus_context_t* params = (i2c_mux_bus_context_t*)context;
+
+    if (i2c_mux_ch_select(params->mux, params->ch) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return i2c_dev_probe(params->mux->in_bus, addr);
+}
+
+/**
+ * Open an I2C which selects the channel before each transaction
+*/
+status_t i2c_mux_ch_as_bus(i2c_mux_t* mux, i2c_t* bus, i2c_mux_ch_t ch)
+{
+    static i2c_ops_t i2c_mux_bus_ops = {
+        .write = &i2c_mux_bus_write,
+        .read = &i2c_mux_bus_read,
+        .dev_probe = &i2c_mux_bus_dev_probe,
+        .writev = &i2c_mux_bus_writev,
+        .readv = &i2c_mux_bus_readv
+    };
+
+    if (ch >= mux->n_out_bus)
+        return STATUS_ERROR;
+
+    mux->out_bus[ch].mux = mux;
+    mux->out_bus[ch].ch = ch;
+
+    return i2c_open(bus, &i2c_mux_bus_ops, &mux->out_bus[ch]);
+}
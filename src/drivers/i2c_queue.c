@@ -0,0 +1,319 @@
+#include <stdbool.h>
+#include "drivers/i2c_queue.h"
+#include "drivers/i2c.h"
+
+typedef enum i2c_queue_op {
+    I2C_QUEUE_OP_WRITE,
+    I2C_QUEUE_OP_READ,
+    I2C_QUEUE_OP_DEV_PROBE
+} i2c_queue_op_t;
+
+/**
+ * Single queued transaction
+ *
+ * @note Allocated on the stack of the submitting thread, valid until `done` is set
+*/
+typedef struct i2c_queue_req {
+    mpsc_node_t node;
+    i2c_queue_op_t op;
+    uint8_t addr;
+    uint8_t* data;
+    size_t nbyte;
+    /* Reads longer than this are split, 0 to never split */
+    size_t chunk;
+    /* Single attempt retry state of the chunks */
+    i2c_retry_t* retry;
+    /* Bytes of a split read already transferred */
+    size_t offset;
+    uint32_t submitted;
+    status_t status;
+    atomic_bool done;
+} i2c_queue_req_t;
+
+/**
+ * Initialize the queue
+*/
+status_t i2c_queue_open(i2c_queue_t* queue, i2c_t* bus)
+{
+    if (bus == NULL)
+        return STATUS_ERROR;
+
+    queue->bus = bus;
+    for (uint8_t p = 0; p < I2C_QUEUE_PRIORITIES; p++) {
+        i2c_queue_class_t* cls = &queue->classes[p];
+
+        cls->queue = queue;
+        mpsc_init(&cls->pending);
+        cls->current = NULL;
+        cls->stats = (i2c_queue_stats_t){0};
+    }
+    atomic_flag_clear(&queue->owner);
+
+    return STATUS_OK;
+}
+
+/**
+ * Execute a transaction, or the next chunk of a split read, on the underlying bus
+ *
+ * @return Nonzero if the transaction is complete
+*/
+static uint8_t i2c_queue_execute(i2c_queue_class_t* cls, i2c_queue_req_t* req)
+{
+    i2c_t* bus = cls->queue->bus;
+
+    switch (req->op) {
+    case I2C_QUEUE_OP_WRITE:
+        req->status = i2c_write(bus, req->addr, req->data, req->nbyte);
+        break;
+    case I2C_QUEUE_OP_READ: {
+        size_t n = req->nbyte - req->offset;
+
+        if (req->chunk == 0 || req->nbyte <= req->chunk) {
+            req->status = i2c_read(bus, req->addr, req->data, req->nbyte);
+            break;
+        }
+
+        /* Retrying would read the bytes after the failed chunk, the device already moved on */
+        if (n > req->chunk)
+            n = req->chunk;
+        cls->stats.chunks++;
+        req->status = i2c_transfer(bus, req->retry, I2C_OP_READ, req->addr, req->data + req->offset, n);
+        req->offset += n;
+
+        if (req->status == STATUS_OK && req->offset < req->nbyte)
+            return 0;
+        break;
+    }
+    case I2C_QUEUE_OP_DEV_PROBE:
+        req->status = i2c_dev_probe(bus, req->addr);
+        break;
+    default:
+        req->status = STATUS_ERROR;
+        break;
+    }
+
+    return 1;
+}
+
+/**
+ * Take the transaction to execute next: the split read in progress or the oldest
+ * pending transaction of the highest priority class which has one
+*/
+static i2c_queue_req_t* i2c_queue_next(i2c_queue_t* queue, i2c_queue_class_t** cls_out)
+{
+    for (uint8_t p = 0; p < I2C_QUEUE_PRIORITIES; p++) {
+        i2c_queue_class_t* cls = &queue->classes[p];
+        i2c_queue_req_t* req = cls->current;
+
+        if (req == NULL) {
+            mpsc_node_t* node = mpsc_pop(&cls->pending);
+            if (node == NULL)
+                continue;
+
+            req = MPSC_ENTRY(node, i2c_queue_req_t, node);
+            uint32_t wait = (uint32_t)I2C_QUEUE_TIMESTAMP() - req->submitted;
+            if (wait > cls->stats.max_wait)
+                cls->stats.max_wait = wait;
+        }
+
+        *cls_out = cls;
+        return req;
+    }
+
+    return NULL;
+}
+
+/**
+ * Claim the queue and drain it, checking the higher priorities again after every bus transaction
+*/
+status_t i2c_queue_process(i2c_queue_t* queue)
+{
+    if (atomic_flag_test_and_set_explicit(&queue->owner, memory_order_acquire))
+        return STATUS_ERROR;
+
+    i2c_queue_class_t* cls;
+    i2c_queue_req_t* req;
+
+    while ((req = i2c_queue_next(queue, &cls)) != NULL) {
+        if (!i2c_queue_execute(cls, req)) {
+            cls->current = req;
+            continue;
+        }
+        cls->current = NULL;
+
+        uint32_t latency = (uint32_t)I2C_QUEUE_TIMESTAMP() - req->submitted;
+        if (latency > cls->stats.max_latency)
+            cls->stats.max_latency = latency;
+        cls->stats.transactions++;
+
+        /* Request must not be accessed after this since the submitter can return */
+        atomic_store_explicit(&req->done, true, memory_order_release);
+    }
+
+    atomic_flag_clear_explicit(&queue->owner, memory_order_release);
+
+    return STATUS_OK;
+}
+
+/**
+ * Push the request and wait until it is executed
+*/
+static status_t i2c_queue_submit(i2c_queue_class_t* cls, i2c_queue_req_t* req)
+{
+    req->submitted = (uint32_t)I2C_QUEUE_TIMESTAMP();
+    atomic_init(&req->done, false);
+    mpsc_push(&cls->pending, &req->node);
+
+    /* Waiters keep trying to claim the queue, so a request is never left behind */
+    while (!atomic_load_explicit(&req->done, memory_order_acquire)) {
+#ifndef I2C_QUEUE_DEDICATED_OWNER
+        if (i2c_queue_process(cls->queue) == STATUS_OK)
+            continue;
+#endif
+        I2C_QUEUE_WAIT();
+    }
+
+    return req->status;
+}
+
+/**
+ * I2C write handler for the queued bus
+*/
+static status_t i2c_queue_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    i2c_queue_req_t req = {
+        .op = I2C_QUEUE_OP_WRITE,
+        .addr = addr,
+        .data = data,
+        .nbyte = nbyte
+    };
+
+    return i2c_queue_submit((i2c_queue_class_t*)context, &req);
+}
+
+/**
+ * I2C read handler for the queued bus
+*/
+static status_t i2c_queue_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    i2c_queue_req_t req = {
+        .op = I2C_QUEUE_OP_READ,
+        .addr = addr,
+        .data = data,
+        .nbyte = nbyte
+    };
+
+    return i2c_queue_submit((i2c_queue_class_t*)context, &req);
+}
+
+/**
+ * I2C write handler for the chunked queued bus
+*/
+static status_t i2c_queue_chunked_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    return i2c_queue_write(((i2c_queue_chunked_t*)context)->cls, addr, data, nbyte);
+}
+
+/**
+ * I2C read handler for the chunked queued bus
+*/
+static status_t i2c_queue_chunked_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    i2c_queue_chunked_t* chunked = (i2c_queue_chunked_t*)context;
+    i2c_queue_req_t req = {
+        .op = I2C_QUEUE_OP_READ,
+        .addr = addr,
+        .data = data,
+        .nbyte = nbyte,
+        .chunk = chunked->chunk,
+        .retry = &chunked->retry
+    };
+
+    return i2c_queue_submit(chunked->cls, &req);
+}
+
+/**
+ * I2C dev_probe handler for the queued bus
+*/
+static status_t i2c_queue_dev_probe(void* context, uint8_t addr)
+{
+    i2c_queue_req_t req = {
+        .op = I2C_QUEUE_OP_DEV_PROBE,
+        .addr = addr
+    };
+
+    return i2c_queue_submit((i2c_queue_class_t*)context, &req);
+}
+
+/**
+ * Initialize the I2C structure so that it submits transactions to the queue of the priority
+*/
+status_t i2c_queue_bus_open_priority(i2c_queue_t* queue, i2c_t* shared, uint8_t priority)
+{
+    static i2c_ops_t i2c_queue_ops = {
+        .write = &i2c_queue_write,
+        .read = &i2c_queue_read,
+        .dev_probe = &i2c_queue_dev_probe
+    };
+
+    if (queue == NULL || priority >= I2C_QUEUE_PRIORITIES)
+        return STATUS_ERROR;
+
+    return i2c_open(shared, &i2c_queue_ops, &queue->classes[priority]);
+}
+
+/**
+ * I2C dev_probe handler for the chunked queued bus
+*/
+static status_t i2c_queue_chunked_dev_probe(void* context, uint8_t addr)
+{
+    return i2c_queue_dev_probe(((i2c_queue_chunked_t*)context)->cls, addr);
+}
+
+/**
+ * Initialize the I2C structure so that it submits transactions to the queue of the priority
+ * and splits its reads
+*/
+status_t i2c_queue_bus_open_chunked(i2c_queue_t* queue, i2c_t* shared, uint8_t priority,
+    i2c_queue_chunked_t* chunked, size_t chunk)
+{
+    static i2c_ops_t i2c_queue_chunked_ops = {
+        .write = &i2c_queue_chunked_write,
+        .read = &i2c_queue_chunked_read,
+        .dev_probe = &i2c_queue_chunked_dev_probe
+    };
+    static const i2c_retry_policy_t i2c_queue_chunk_policy = { .tries = 1 };
+
+    if (queue == NULL || chunked == NULL || priority >= I2C_QUEUE_PRIORITIES)
+        return STATUS_ERROR;
+
+    chunked->cls = &queue->classes[priority];
+    chunked->chunk = chunk;
+    chunked->retry = (i2c_retry_t){ .policy = &i2c_queue_chunk_policy };
+
+    return i2c_open(shared, &i2c_queue_chunked_ops, chunked);
+}
+
+/**
+ * Initialize the I2C structure so that it submits transactions to the lowest priority queue
+*/
+status_t i2c_queue_bus_open(i2c_queue_t* queue, i2c_t* shared)
+{
+    return i2c_queue_bus_open_priority(queue, shared, I2C_QUEUE_PRIORITIES - 1);
+}
+
+status_t i2c_queue_get_stats(i2c_queue_t* queue, uint8_t priority, i2c_queue_stats_t* stats)
+{
+    if (priority >= I2C_QUEUE_PRIORITIES)
+        return STATUS_ERROR;
+
+    *stats = queue->classes[priority].stats;
+
+    return STATUS_OK;
+}
+
+void i2c_queue_reset_stats(i2c_queue_t* queue)
+{
+    for (uint8_t p = 0; p < I2C_QUEUE_PRIORITIES; p++)
+        queue->classes[p].stats = (i2c_queue_stats_t){0};
+}
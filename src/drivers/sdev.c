@@ -1,10 +1,6 @@
+#include <string.h>
 #include "drivers/sdev.h"
 
-typedef struct sdev {
-    sdev_ops_t* ops;
-    void* context;
-} sdev_t;
-
 /**
  * Open handler
 */
@@ -18,15 +14,48 @@ status_t sdev_open(sdev_t* sdev, sdev_ops_t* ops, void* context)
     return STATUS_OK;
 }
 
+#ifdef DRIVERS_USE_POOL
+POOL_DEFINE(static, sdev_pool, sdev_t, SDEV_POOL_SIZE);
+
+/**
+ * Allocate and initialize a serial device structure
+*/
+sdev_t* sdev_open_dynamic(sdev_ops_t* ops, void* context)
+{
+    sdev_t* sdev = (sdev_t*)pool_alloc(&sdev_pool);
+
+    if (sdev == NULL)
+        return NULL;
+
+    if (sdev_open(sdev, ops, context) != STATUS_OK) {
+        pool_free(&sdev_pool, sdev);
+        return NULL;
+    }
+
+    return sdev;
+}
+
+/**
+ * Get usage statistics of the serial device pool
+*/
+void sdev_pool_get_stats(pool_stats_t* stats)
+{
+    pool_get_stats(&sdev_pool, stats);
+}
+#endif
+
+#ifndef SDEV_BIND_TEST
 /**
  * Call the implementation specific test handler
- * @todo Maybe can be implemented as `#define` or `static inline`
+ * @note Replaced by a direct call if bound statically (see `DRIVERS_BINDING_HEADER`)
 */
 status_t sdev_test(sdev_t* sdev)
 {
     return sdev->ops->test(sdev->context);
 }
+#endif
 
+#ifndef SDEV_BIND_WRITE
 /**
  * Call the implementation specific write handler
 */
@@ -34,7 +63,9 @@ status_t sdev_write(sdev_t* sdev, uint8_t* data, size_t nbyte)
 {
     return sdev->ops->write(sdev->context, data, nbyte);
 }
+#endif
 
+#ifndef SDEV_BIND_READ
 /**
  * Call the implementation specific read handler
 */
@@ -42,7 +73,119 @@ status_t sdev_read(sdev_t* sdev, uint8_t* data, size_t nbyte)
 {
     return sdev->ops->read(sdev->context, data, nbyte);
 }
+#endif
 
+/**
+ * Sum of the segment lengths
+*/
+static size_t sdev_iov_len(const sdev_iovec_t* iov, size_t iovcnt)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < iovcnt; i++)
+        total += iov[i].nbyte;
+
+    return total;
+}
+
+/**
+ * Call the implementation specific writev handler,
+ * or gather the segments and write them in a single transaction
+ * @note Gathering is limited to `SDEV_IOV_BOUNCE_LEN`, a transaction can not be split,
+ * so devices with longer vectored writes need a writev handler (I2C and UART devices have one)
+*/
+status_t sdev_writev(sdev_t* sdev, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    if (sdev->ops->writev != NULL)
+        return sdev->ops->writev(sdev->context, iov, iovcnt);
+
+    if (iovcnt == 1)
+        return sdev_write(sdev, iov[0].data, iov[0].nbyte);
+
+    uint8_t bounce[SDEV_IOV_BOUNCE_LEN];
+    size_t total = sdev_iov_len(iov, iovcnt);
+
+    if (total > SDEV_IOV_BOUNCE_LEN)
+        return STATUS_ERROR;
+
+    size_t pos = 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        memcpy(bounce + pos, iov[i].data, iov[i].nbyte);
+        pos += iov[i].nbyte;
+    }
+
+    return sdev_write(sdev, bounce, total);
+}
+
+/**
+ * Call the implementation specific readv handler,
+ * or read in a single transaction and scatter to the segments
+ * @note Limited to `SDEV_IOV_BOUNCE_LEN` like the writev emulation
+*/
+status_t sdev_readv(sdev_t* sdev, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    if (sdev->ops->readv != NULL)
+        return sdev->ops->readv(sdev->context, iov, iovcnt);
+
+    if (iovcnt == 1)
+        return sdev_read(sdev, iov[0].data, iov[0].nbyte);
+
+    uint8_t bounce[SDEV_IOV_BOUNCE_LEN];
+    size_t total = sdev_iov_len(iov, iovcnt);
+
+    if (total > SDEV_IOV_BOUNCE_LEN)
+        return STATUS_ERROR;
+
+    if (sdev_read(sdev, bounce, total) != STATUS_OK)
+        return STATUS_ERROR;
+
+    size_t pos = 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        memcpy(iov[i].data, bounce + pos, iov[i].nbyte);
+        pos += iov[i].nbyte;
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * Call the implementation specific write_async handler,
+ * or write blocking and call the callback immediately
+ * @note Emulation completes synchronously: the callback runs in the calling context before
+ * this returns, a callback which starts the next operation recurses into it
+*/
+status_t sdev_write_async(sdev_t* sdev, uint8_t* data, size_t nbyte, sdev_callback_t callback, void* arg)
+{
+    if (sdev->ops->write_async != NULL)
+        return sdev->ops->write_async(sdev->context, data, nbyte, callback, arg);
+
+    status_t status = sdev_write(sdev, data, nbyte);
+
+    if (callback != NULL)
+        callback(status, arg);
+
+    return STATUS_OK;
+}
+
+/**
+ * Call the implementation specific read_async handler,
+ * or read blocking and call the callback immediately
+ * @note Emulation completes synchronously like the write_async one
+*/
+status_t sdev_read_async(sdev_t* sdev, uint8_t* data, size_t nbyte, sdev_callback_t callback, void* arg)
+{
+    if (sdev->ops->read_async != NULL)
+        return sdev->ops->read_async(sdev->context, data, nbyte, callback, arg);
+
+    status_t status = sdev_read(sdev, data, nbyte);
+
+    if (callback != NULL)
+        callback(status, arg);
+
+    return STATUS_OK;
+}
+
+#ifndef SDEV_BIND_IOCTL
 /**
  * Call the implementation specific ioctl handler
 */
@@ -50,7 +193,9 @@ status_t sdev_ioctl(sdev_t* sdev, int ctl_type, void* arg)
 {
     return sdev->ops->ioctl(sdev->context, ctl_type, arg);
 }
+#endif
 
+#ifndef SDEV_BIND_CLOSE
 /**
  * Call the implementation specific close handler
 */
@@ -58,5 +203,13 @@ status_t sdev_close(sdev_t* sdev)
 {
     /** @todo Deinit struct members here if needed */
 
-    return sdev->ops->close(sdev->context);
-}
\ No newline at end of file
+    status_t status = sdev->ops->close(sdev->context);
+
+#ifdef DRIVERS_USE_POOL
+    if (pool_owns(&sdev_pool, sdev))
+        pool_free(&sdev_pool, sdev);
+#endif
+
+    return status;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "drivers/sdev_sched.h"
+
+/* Tick comparison which is correct across counter wrap */
+#define TICK_AFTER_EQ(a, b)     ((int32_t)((uint32_t)(a) - (uint32_t)(b)) >= 0)
+#define TICK_AFTER(a, b)        ((int32_t)((uint32_t)(a) - (uint32_t)(b)) > 0)
+
+/**
+ * Initialize scheduler structure
+*/
+status_t sdev_sched_open(sdev_sched_t* sched)
+{
+    sched->entries = NULL;
+    atomic_init(&sched->now, 0);
+
+    return STATUS_OK;
+}
+
+/**
+ * Initialize the entry and insert it next to the entries on the same bus
+*/
+status_t sdev_sched_register(sdev_sched_t* sched, sdev_sched_entry_t* entry, sdev_t* device,
+    const void* bus, uint32_t period, sdev_sched_read_t read, void* arg)
+{
+    if (entry == NULL || read == NULL || period == 0)
+        return STATUS_ERROR;
+
+    uint32_t now = (uint32_t)atomic_load(&sched->now);
+
+    entry->device = device;
+    entry->bus = bus;
+    entry->period = period;
+    entry->read = read;
+    entry->arg = arg;
+    entry->next_release = (now / period + 1) * period;
+    entry->release = 0;
+    entry->deadline = 0;
+    entry->pending = 0;
+    entry->runs = 0;
+    entry->missed = 0;
+    entry->errors = 0;
+    entry->last_jitter = 0;
+    entry->max_jitter = 0;
+
+    /* Keep entries of the same bus contiguous */
+    sdev_sched_entry_t** link = &sched->entries;
+    sdev_sched_entry_t** after_bus = NULL;
+    while (*link != NULL) {
+        if ((*link)->bus == bus)
+            after_bus = &(*link)->next;
+        link = &(*link)->next;
+    }
+    if (after_bus != NULL)
+        link = after_bus;
+
+    entry->next = *link;
+    *link = entry;
+
+    return STATUS_OK;
+}
+
+/**
+ * Unlink the entry
+*/
+status_t sdev_sched_unregister(sdev_sched_t* sched, sdev_sched_entry_t* entry)
+{
+    for (sdev_sched_entry_t** link = &sched->entries; *link != NULL; link = &(*link)->next) {
+        if (*link == entry) {
+            *link = entry->next;
+            return STATUS_OK;
+        }
+    }
+
+    return STATUS_ERROR;
+}
+
+/**
+ * Increment the tick counter
+*/
+void sdev_sched_tick(sdev_sched_t* sched)
+{
+    atomic_fetch_add_explicit(&sched->now, 1, memory_order_relaxed);
+}
+
+/**
+ * Release reads whose period elapsed, counting the ones that can not be made in time
+*/
+static void sdev_sched_release(sdev_sched_t* sched, uint32_t now)
+{
+    for (sdev_sched_entry_t* e = sched->entries; e != NULL; e = e->next) {
+        if (!TICK_AFTER_EQ(now, e->next_release))
+            continue;
+
+        uint32_t releases = (now - e->next_release) / e->period + 1;
+
+        /* A still pending read missed its deadline, older releases are skipped */
+        e->missed += e->pending ? releases : releases - 1;
+
+        e->release = e->next_release + (releases - 1) * e->period;
+        e->deadline = e->release + e->period;
+        e->next_release = e->deadline;
+        e->pending = 1;
+    }
+}
+
+/**
+ * Execute the read and complete all pending entries of the bus which it serves
+*/
+static status_t sdev_sched_execute(sdev_sched_t* sched, sdev_sched_entry_t* bus_first, sdev_sched_entry_t* entry)
+{
+    uint32_t start = (uint32_t)atomic_load(&sched->now);
+    status_t status = entry->read(entry->device, entry->arg);
+    uint32_t end = (uint32_t)atomic_load(&sched->now);
+
+    for (sdev_sched_entry_t* e = bus_first; e != NULL && e->bus == bus_first->bus; e = e->next) {
+        if (!e->pending || e->device != entry->device ||
+            e->read != entry->read || e->arg != entry->arg)
+            continue;
+
+        e->pending = 0;
+        e->runs++;
+        e->last_jitter = start - e->release;
+        if (e->last_jitter > e->max_jitter)
+            e->max_jitter = e->last_jitter;
+        if (status != STATUS_OK)
+            e->errors++;
+        if (TICK_AFTER(end, e->deadline))
+            e->missed++;
+    }
+
+    return status;
+}
+
+/**
+ * Release due reads and execute them, one per bus per pass in deadline order
+*/
+status_t sdev_sched_run(sdev_sched_t* sched)
+{
+    status_t ret_status = STATUS_OK;
+    uint8_t executed;
+
+    sdev_sched_release(sched, (uint32_t)atomic_load(&sched->now));
+
+    do {
+        executed = 0;
+
+        sdev_sched_entry_t* bus_first = sched->entries;
+        while (bus_first != NULL) {
+            sdev_sched_entry_t* earliest = NULL;
+            sdev_sched_entry_t* e = bus_first;
+
+            for (; e != NULL && e->bus == bus_first->bus; e = e->next) {
+                if (e->pending && (earliest == NULL || TICK_AFTER(earliest->deadline, e->deadline)))
+                    earliest = e;
+            }
+
+            if (earliest != NULL) {
+                if (sdev_sched_execute(sched, bus_first, earliest) != STATUS_OK)
+                    ret_status = STATUS_ERROR;
+                executed = 1;
+            }
+
+            bus_first = e;
+        }
+    } while (executed);
+
+    return ret_status;
+}
+
+/**
+ * Copy the entry statistics
+*/
+void sdev_sched_get_stats(sdev_sched_entry_t* entry, sdev_sched_stats_t* stats)
+{
+    stats->runs = entry->runs;
+    stats->missed = entry->missed;
+    stats->errors = entry->errors;
+    stats->last_jitter = entry->last_jitter;
+    stats->max_jitter = entry->max_jitter;
+}
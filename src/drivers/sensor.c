@@ -0,0 +1,166 @@
+#include "drivers/sensor.h"
+
+/**
+ * Initialize sensor structure
+*/
+status_t sensor_open(sensor_t* sensor, sensor_ops_t* ops, void* context)
+{
+    if (ops == NULL)
+        return STATUS_ERROR;
+
+    sensor->ops = ops;
+    sensor->context = context;
+    sensor->bus = NULL;
+    sensor->channel = I2C_MUX_CH_NONE;
+    sensor->snapshot = NULL;
+
+    return STATUS_OK;
+}
+
+/**
+ * Set the sampling group
+*/
+void sensor_set_group(sensor_t* sensor, const void* bus, i2c_mux_ch_t channel)
+{
+    sensor->bus = bus;
+    sensor->channel = channel;
+}
+
+void sensor_set_snapshot(sensor_t* sensor, snapshot_t* snapshot)
+{
+    sensor->snapshot = snapshot;
+}
+
+snapshot_t* sensor_get_snapshot(sensor_t* sensor)
+{
+    return sensor->snapshot;
+}
+
+/**
+ * Call the implementation specific sample handler
+*/
+status_t sensor_sample(sensor_t* sensor)
+{
+    return sensor->ops->sample(sensor->context);
+}
+
+/**
+ * Call the implementation specific temperature getter
+*/
+status_t sensor_temperature_get(sensor_temperature_t* temp, int32_t* centi_celsius)
+{
+    return temp->get(temp->sensor->context, centi_celsius);
+}
+
+/**
+ * Sample and call the implementation specific temperature getter
+*/
+status_t sensor_temperature_read(sensor_temperature_t* temp, int32_t* centi_celsius)
+{
+    if (sensor_sample(temp->sensor) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return sensor_temperature_get(temp, centi_celsius);
+}
+
+/**
+ * Call the implementation specific pressure getter
+*/
+status_t sensor_pressure_get(sensor_pressure_t* press, uint32_t* pascal_q8)
+{
+    return press->get(press->sensor->context, pascal_q8);
+}
+
+/**
+ * Sample and call the implementation specific pressure getter
+*/
+status_t sensor_pressure_read(sensor_pressure_t* press, uint32_t* pascal_q8)
+{
+    if (sensor_sample(press->sensor) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return sensor_pressure_get(press, pascal_q8);
+}
+
+/**
+ * Call the implementation specific humidity getter
+*/
+status_t sensor_humidity_get(sensor_humidity_t* hum, uint32_t* percent_q10)
+{
+    return hum->get(hum->sensor->context, percent_q10);
+}
+
+/**
+ * Sample and call the implementation specific humidity getter
+*/
+status_t sensor_humidity_read(sensor_humidity_t* hum, uint32_t* percent_q10)
+{
+    if (sensor_sample(hum->sensor) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return sensor_humidity_get(hum, percent_q10);
+}
+
+/**
+ * Initialize sampler structure
+*/
+status_t sensor_sampler_open(sensor_sampler_t* sampler, sensor_t** storage, size_t capacity)
+{
+    if (storage == NULL)
+        return STATUS_ERROR;
+
+    sampler->sensors = storage;
+    sampler->capacity = capacity;
+    sampler->count = 0;
+    sampler->errors = 0;
+
+    return STATUS_OK;
+}
+
+/**
+ * Order of sampling groups, returns non-zero if `a` should be sampled after `b`
+*/
+static int sensor_group_after(const sensor_t* a, const sensor_t* b)
+{
+    if ((uintptr_t)a->bus != (uintptr_t)b->bus)
+        return (uintptr_t)a->bus > (uintptr_t)b->bus;
+
+    return a->channel > b->channel;
+}
+
+/**
+ * Insert the sensor keeping the list ordered by group
+*/
+status_t sensor_sampler_add(sensor_sampler_t* sampler, sensor_t* sensor)
+{
+    if (sampler->count >= sampler->capacity)
+        return STATUS_ERROR;
+
+    size_t i = sampler->count;
+    while (i > 0 && sensor_group_after(sampler->sensors[i - 1], sensor)) {
+        sampler->sensors[i] = sampler->sensors[i - 1];
+        i--;
+    }
+
+    sampler->sensors[i] = sensor;
+    sampler->count++;
+
+    return STATUS_OK;
+}
+
+/**
+ * Sample every sensor in group order
+*/
+status_t sensor_sampler_run(sensor_sampler_t* sampler)
+{
+    status_t ret_status = STATUS_OK;
+
+    for (size_t i = 0; i < sampler->count; i++) {
+        if (sensor_sample(sampler->sensors[i]) != STATUS_OK) {
+            sampler->errors++;
+            ret_status = STATUS_ERROR;
+        }
+    }
+
+    return ret_status;
+}
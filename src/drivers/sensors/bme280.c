@@ -0,0 +1,295 @@
+#include "drivers/sensors/bme280.h"
+#include "drivers/sensor.h"
+#include "drivers/sdev.h"
+
+#define BME280_REG_CALIB_00     (0x88)
+#define BME280_REG_CHIP_ID      (0xd0)
+#define BME280_REG_CALIB_26     (0xe1)
+#define BME280_REG_CTRL_HUM     (0xf2)
+#define BME280_REG_CTRL_MEAS    (0xf4)
+#define BME280_REG_CONFIG       (0xf5)
+#define BME280_REG_DATA         (0xf7)
+
+#define BME280_CHIP_ID          (0x60)
+
+#define BME280_CALIB_00_LEN     (26)
+#define BME280_CALIB_26_LEN     (7)
+#define BME280_DATA_LEN         (8)
+
+/* Oversampling x1 for all channels, normal mode, 0.5 ms standby */
+#define BME280_CTRL_HUM_VALUE   (0x01)
+#define BME280_CTRL_MEAS_VALUE  (0x27)
+#define BME280_CONFIG_VALUE     (0x00)
+
+#define LE16(buf, i)            ((uint16_t)((buf)[i] | ((buf)[(i) + 1] << 8)))
+
+/**
+ * Select the register and read `len` bytes starting from it
+*/
+static status_t bme280_read_regs(bme280_t* bme, uint8_t reg, uint8_t* data, size_t len)
+{
+    if (sdev_write(bme->device, &reg, 1) != STATUS_OK)
+        return STATUS_ERROR;
+
+    return sdev_read(bme->device, data, len);
+}
+
+/**
+ * Write a single register
+*/
+static status_t bme280_write_reg(bme280_t* bme, uint8_t reg, uint8_t value)
+{
+    uint8_t data[2] = {reg, value};
+
+    return sdev_write(bme->device, data, 2);
+}
+
+/**
+ * Read and unpack the factory calibration
+*/
+static status_t bme280_read_calib(bme280_t* bme)
+{
+    uint8_t c0[BME280_CALIB_00_LEN];
+    uint8_t c1[BME280_CALIB_26_LEN];
+    bme280_calib_t* calib = &bme->calib;
+
+    if (bme280_read_regs(bme, BME280_REG_CALIB_00, c0, BME280_CALIB_00_LEN) != STATUS_OK)
+        return STATUS_ERROR;
+    if (bme280_read_regs(bme, BME280_REG_CALIB_26, c1, BME280_CALIB_26_LEN) != STATUS_OK)
+        return STATUS_ERROR;
+
+    calib->dig_t1 = LE16(c0, 0);
+    calib->dig_t2 = (int16_t)LE16(c0, 2);
+    calib->dig_t3 = (int16_t)LE16(c0, 4);
+    calib->dig_p1 = LE16(c0, 6);
+    calib->dig_p2 = (int16_t)LE16(c0, 8);
+    calib->dig_p3 = (int16_t)LE16(c0, 10);
+    calib->dig_p4 = (int16_t)LE16(c0, 12);
+    calib->dig_p5 = (int16_t)LE16(c0, 14);
+    calib->dig_p6 = (int16_t)LE16(c0, 16);
+    calib->dig_p7 = (int16_t)LE16(c0, 18);
+    calib->dig_p8 = (int16_t)LE16(c0, 20);
+    calib->dig_p9 = (int16_t)LE16(c0, 22);
+    calib->dig_h1 = c0[25];
+
+    calib->dig_h2 = (int16_t)LE16(c1, 0);
+    calib->dig_h3 = c1[2];
+    calib->dig_h4 = (int16_t)(((int8_t)c1[3] * 16) | (c1[4] & 0x0f));
+    calib->dig_h5 = (int16_t)(((int8_t)c1[5] * 16) | (c1[4] >> 4));
+    calib->dig_h6 = (int8_t)c1[6];
+
+    return STATUS_OK;
+}
+
+/**
+ * Temperature compensation from the datasheet, also returns `t_fine` used by other channels
+ *
+ * @return Temperature in hundredths of a degree Celsius
+*/
+static int32_t bme280_compensate_t(const bme280_calib_t* calib, int32_t adc_t, int32_t* t_fine)
+{
+    int32_t var1 = ((((adc_t >> 3) - ((int32_t)calib->dig_t1 << 1))) * ((int32_t)calib->dig_t2)) >> 11;
+    int32_t var2 = (((((adc_t >> 4) - ((int32_t)calib->dig_t1)) *
+        ((adc_t >> 4) - ((int32_t)calib->dig_t1))) >> 12) * ((int32_t)calib->dig_t3)) >> 14;
+
+    *t_fine = var1 + var2;
+    return (*t_fine * 5 + 128) >> 8;
+}
+
+/**
+ * Pressure compensation from the datasheet (64-bit version)
+ *
+ * @return Pressure in Pascal as Q24.8
+*/
+static uint32_t bme280_compensate_p(const bme280_calib_t* calib, int32_t adc_p, int32_t t_fine)
+{
+    int64_t var1 = ((int64_t)t_fine) - 128000;
+    int64_t var2 = var1 * var1 * (int64_t)calib->dig_p6;
+    var2 = var2 + ((var1 * (int64_t)calib->dig_p5) * 131072);
+    var2 = var2 + (((int64_t)calib->dig_p4) * 34359738368);
+    var1 = ((var1 * var1 * (int64_t)calib->dig_p3) >> 8) + ((var1 * (int64_t)calib->dig_p2) * 4096);
+    var1 = ((((int64_t)1) << 47) + var1) * ((int64_t)calib->dig_p1) >> 33;
+
+    /* Avoid division by zero */
+    if (var1 == 0)
+        return 0;
+
+    int64_t p = 1048576 - adc_p;
+    p = (((p * 2147483648) - var2) * 3125) / var1;
+    var1 = (((int64_t)calib->dig_p9) * (p >> 13) * (p >> 13)) >> 25;
+    var2 = (((int64_t)calib->dig_p8) * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + (((int64_t)calib->dig_p7) * 16);
+
+    return (uint32_t)p;
+}
+
+/**
+ * Humidity compensation from the datasheet
+ *
+ * @return Relative humidity in percent as Q22.10
+*/
+static uint32_t bme280_compensate_h(const bme280_calib_t* calib, int32_t adc_h, int32_t t_fine)
+{
+    int32_t v = t_fine - ((int32_t)76800);
+
+    v = (((((adc_h << 14) - (((int32_t)calib->dig_h4) << 20) - (((int32_t)calib->dig_h5) * v)) +
+        ((int32_t)16384)) >> 15) * (((((((v * ((int32_t)calib->dig_h6)) >> 10) *
+        (((v * ((int32_t)calib->dig_h3)) >> 11) + ((int32_t)32768))) >> 10) +
+        ((int32_t)2097152)) * ((int32_t)calib->dig_h2) + 8192) >> 14));
+    v = v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)calib->dig_h1)) >> 4);
+    v = v < 0 ? 0 : v;
+    v = v > 419430400 ? 419430400 : v;
+
+    return (uint32_t)(v >> 12);
+}
+
+/**
+ * Sensor sample handler, reads all channels in one burst
+*/
+static status_t bme280_sample(void* context)
+{
+    bme280_t* bme = (bme280_t*)context;
+    uint8_t data[BME280_DATA_LEN];
+
+    if (bme280_read_regs(bme, BME280_REG_DATA, data, BME280_DATA_LEN) != STATUS_OK)
+        return STATUS_ERROR;
+
+    int32_t adc_p = ((int32_t)data[0] << 12) | ((int32_t)data[1] << 4) | (data[2] >> 4);
+    int32_t adc_t = ((int32_t)data[3] << 12) | ((int32_t)data[4] << 4) | (data[5] >> 4);
+    int32_t adc_h = ((int32_t)data[6] << 8) | data[7];
+    int32_t t_fine;
+    bme280_reading_t reading;
+
+    reading.temperature = bme280_compensate_t(&bme->calib, adc_t, &t_fine);
+    reading.pressure = bme280_compensate_p(&bme->calib, adc_p, t_fine);
+    reading.humidity = bme280_compensate_h(&bme->calib, adc_h, t_fine);
+
+    /*
+     * Samplers can preempt each other (an ISR and a thread), the sample loses to the one
+     * being published concurrently. That one is just as new, so the read still succeeded
+     */
+    snapshot_try_publish(&bme->snapshot, &reading);
+    return STATUS_OK;
+}
+
+/**
+ * Temperature getter
+*/
+static status_t bme280_get_temperature(void* context, int32_t* centi_celsius)
+{
+    bme280_reading_t reading;
+
+    bme280_get_reading((bme280_t*)context, &reading);
+    *centi_celsius = reading.temperature;
+    return STATUS_OK;
+}
+
+/**
+ * Pressure getter
+*/
+static status_t bme280_get_pressure(void* context, uint32_t* pascal_q8)
+{
+    bme280_reading_t reading;
+
+    bme280_get_reading((bme280_t*)context, &reading);
+    *pascal_q8 = reading.pressure;
+    return STATUS_OK;
+}
+
+/**
+ * Humidity getter
+*/
+static status_t bme280_get_humidity(void* context, uint32_t* percent_q10)
+{
+    bme280_reading_t reading;
+
+    bme280_get_reading((bme280_t*)context, &reading);
+    *percent_q10 = reading.humidity;
+    return STATUS_OK;
+}
+
+/**
+ * Initialize the device and the bme280 structure
+*/
+status_t bme280_open(bme280_t* bme, sdev_t* device)
+{
+    static sensor_ops_t bme280_sensor_ops = {
+        .sample = &bme280_sample
+    };
+
+    uint8_t chip_id;
+
+    if (device == NULL)
+        return STATUS_ERROR;
+    bme->device = device;
+    bme->reading = (bme280_reading_t){0};
+    snapshot_init(&bme->snapshot, &bme->reading, sizeof(bme->reading));
+
+    if (bme280_read_regs(bme, BME280_REG_CHIP_ID, &chip_id, 1) != STATUS_OK || chip_id != BME280_CHIP_ID)
+        return STATUS_ERROR;
+
+    if (bme280_read_calib(bme) != STATUS_OK)
+        return STATUS_ERROR;
+
+    /* Humidity control is applied only after writing ctrl_meas */
+    if (bme280_write_reg(bme, BME280_REG_CTRL_HUM, BME280_CTRL_HUM_VALUE) != STATUS_OK ||
+        bme280_write_reg(bme, BME280_REG_CONFIG, BME280_CONFIG_VALUE) != STATUS_OK ||
+        bme280_write_reg(bme, BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS_VALUE) != STATUS_OK)
+        return STATUS_ERROR;
+
+    if (sensor_open(&bme->sensor, &bme280_sensor_ops, bme) != STATUS_OK)
+        return STATUS_ERROR;
+
+    sensor_set_snapshot(&bme->sensor, &bme->snapshot);
+
+    return STATUS_OK;
+}
+
+/**
+ * Get the generic sensor of the device
+*/
+sensor_t* bme280_get_sensor(bme280_t* bme)
+{
+    return &bme->sensor;
+}
+
+/**
+ * Copy the last sample from the snapshot
+*/
+unsigned int bme280_get_reading(bme280_t* bme, bme280_reading_t* reading)
+{
+    return snapshot_read(&bme->snapshot, reading);
+}
+
+/**
+ * Initialize the temperature interface
+*/
+status_t bme280_sensor_temperature_open(sensor_temperature_t* temp, bme280_t* bme)
+{
+    temp->sensor = &bme->sensor;
+    temp->get = &bme280_get_temperature;
+
+    return STATUS_OK;
+}
+
+/**
+ * Initialize the pressure interface
+*/
+status_t bme280_sensor_pressure_open(sensor_pressure_t* press, bme280_t* bme)
+{
+    press->sensor = &bme->sensor;
+    press->get = &bme280_get_pressure;
+
+    return STATUS_OK;
+}
+
+/**
+ * Initialize the humidity interface
+*/
+status_t bme280_sensor_humidity_open(sensor_humidity_t* hum, bme280_t* bme)
+{
+    hum->sensor = &bme->sensor;
+    hum->get = &bme280_get_humidity;
+
+    return STATUS_OK;
+}
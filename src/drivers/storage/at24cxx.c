@@ -0,0 +1,149 @@
+#include <string.h>
+#include "drivers/storage/at24cxx.h"
+#include "drivers/i2c.h"
+#include "drivers/sdev.h"
+
+#define AT24CXX_BLOCK_SIZE      (256)
+#define AT24CXX_ADDR_MAX        (2)
+
+const at24cxx_model_t at24c01 = { .size = 128, .page_size = 8, .addr_len = 1 };
+const at24cxx_model_t at24c02 = { .size = 256, .page_size = 8, .addr_len = 1 };
+const at24cxx_model_t at24c04 = { .size = 512, .page_size = 16, .addr_len = 1 };
+const at24cxx_model_t at24c08 = { .size = 1024, .page_size = 16, .addr_len = 1 };
+const at24cxx_model_t at24c16 = { .size = 2048, .page_size = 16, .addr_len = 1 };
+const at24cxx_model_t at24c32 = { .size = 4096, .page_size = 32, .addr_len = 2 };
+const at24cxx_model_t at24c64 = { .size = 8192, .page_size = 32, .addr_len = 2 };
+const at24cxx_model_t at24c128 = { .size = 16384, .page_size = 64, .addr_len = 2 };
+const at24cxx_model_t at24c256 = { .size = 32768, .page_size = 64, .addr_len = 2 };
+const at24cxx_model_t at24c512 = { .size = 65536, .page_size = 128, .addr_len = 2 };
+
+/**
+ * Point the device at the block of `mem_addr` and encode the memory address bytes
+ *
+ * @return Number of address bytes
+*/
+static uint8_t at24cxx_address(at24cxx_t* eeprom, uint32_t mem_addr, uint8_t* buf)
+{
+    if (eeprom->model->addr_len == 1) {
+        eeprom->context.addr = (uint8_t)(eeprom->addr | (mem_addr / AT24CXX_BLOCK_SIZE));
+        buf[0] = (uint8_t)mem_addr;
+        return 1;
+    }
+
+    eeprom->context.addr = eeprom->addr;
+    buf[0] = (uint8_t)(mem_addr >> 8);
+    buf[1] = (uint8_t)mem_addr;
+    return 2;
+}
+
+/**
+ * Largest transfer from `mem_addr` which stays inside `unit` (a power of two)
+*/
+static size_t at24cxx_span(uint32_t mem_addr, uint32_t unit, size_t nbyte)
+{
+    size_t left = unit - (mem_addr & (unit - 1));
+
+    return nbyte < left ? nbyte : left;
+}
+
+status_t at24cxx_open(at24cxx_t* eeprom, i2c_t* bus, uint8_t addr, const at24cxx_model_t* model)
+{
+    if (model == NULL || model->addr_len > AT24CXX_ADDR_MAX || model->page_size > AT24CXX_PAGE_MAX)
+        return STATUS_ERROR;
+
+    eeprom->model = model;
+    eeprom->bus = bus;
+    eeprom->addr = addr;
+    eeprom->busy = 0;
+
+    return i2c_sdev_open(bus, &eeprom->device, &eeprom->context, addr);
+}
+
+/**
+ * ACK polling, the device does not acknowledge its address until the write cycle is complete.
+ * Polls the block which was written since parts with block select only answer on those addresses.
+ * Each poll is a single attempt which leaves the retry policy and failure streak of the bus alone.
+*/
+status_t at24cxx_sync(at24cxx_t* eeprom)
+{
+    if (!eeprom->busy)
+        return STATUS_OK;
+
+    for (uint32_t i = 0; i < AT24CXX_POLL_LIMIT; i++) {
+        if (i2c_dev_poll(eeprom->bus, eeprom->context.addr) == STATUS_OK) {
+            eeprom->busy = 0;
+            return STATUS_OK;
+        }
+        AT24CXX_POLL_WAIT();
+    }
+
+    return STATUS_ERROR;
+}
+
+/**
+ * Set the address counter and read sequentially, split only at the blocks of block select parts
+*/
+status_t at24cxx_read(at24cxx_t* eeprom, uint32_t mem_addr, uint8_t* data, size_t nbyte)
+{
+    const at24cxx_model_t* model = eeprom->model;
+
+    if (mem_addr > model->size || nbyte > model->size - mem_addr)
+        return STATUS_ERROR;
+
+    if (at24cxx_sync(eeprom) != STATUS_OK)
+        return STATUS_ERROR;
+
+    while (nbyte > 0) {
+        uint8_t header[2];
+        uint8_t header_len = at24cxx_address(eeprom, mem_addr, header);
+        size_t n = model->addr_len == 1 ? at24cxx_span(mem_addr, AT24CXX_BLOCK_SIZE, nbyte) : nbyte;
+
+        if (sdev_write(&eeprom->device, header, header_len) != STATUS_OK)
+            return STATUS_ERROR;
+        if (sdev_read(&eeprom->device, data, n) != STATUS_OK)
+            return STATUS_ERROR;
+
+        mem_addr += n;
+        data += n;
+        nbyte -= n;
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * Send one burst per page (address and data gathered into a single transaction),
+ * polling for the previous write cycle before each one
+*/
+status_t at24cxx_write(at24cxx_t* eeprom, uint32_t mem_addr, const uint8_t* data, size_t nbyte)
+{
+    const at24cxx_model_t* model = eeprom->model;
+
+    if (mem_addr > model->size || nbyte > model->size - mem_addr)
+        return STATUS_ERROR;
+
+    while (nbyte > 0) {
+        if (at24cxx_sync(eeprom) != STATUS_OK)
+            return STATUS_ERROR;
+
+        uint8_t burst[AT24CXX_ADDR_MAX + AT24CXX_PAGE_MAX];
+        uint8_t header_len = at24cxx_address(eeprom, mem_addr, burst);
+        size_t n = at24cxx_span(mem_addr, model->page_size, nbyte);
+
+        memcpy(&burst[header_len], data, n);
+        if (sdev_write(&eeprom->device, burst, header_len + n) != STATUS_OK)
+            return STATUS_ERROR;
+        eeprom->busy = 1;
+
+        mem_addr += n;
+        data += n;
+        nbyte -= n;
+    }
+
+    return STATUS_OK;
+}
+
+i2c_sdev_context_t* at24cxx_get_context(at24cxx_t* eeprom)
+{
+    return &eeprom->context;
+}
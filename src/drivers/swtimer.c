@@ -0,0 +1,285 @@
+#include "drivers/swtimer.h"
+
+#define SWTIMER_SLOT_MASK       (SWTIMER_SLOTS - 1)
+#define SWTIMER_SHIFT(level)    ((level) * SWTIMER_SLOT_BITS)
+#define TIMER_COUNT_MAX         ((timer_count_t)~(timer_count_t)0)
+
+/**
+ * Rotate right, used to start the bitmap search after the current slot
+*/
+static inline uint64_t swtimer_rotr(uint64_t x, uint8_t n)
+{
+    n &= 63;
+    return n != 0 ? (x >> n) | (x << (64 - n)) : x;
+}
+
+static void swtimer_link(swtimer_wheel_t* wheel, swtimer_t* timer, uint8_t level, uint8_t slot)
+{
+    swtimer_t** head = &wheel->slots[level][slot];
+
+    timer->level = level;
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = *head;
+    if (*head != NULL)
+        (*head)->prev = timer;
+    *head = timer;
+
+    wheel->occupied[level] |= 1ull << slot;
+    timer->active = 1;
+}
+
+static void swtimer_unlink(swtimer_wheel_t* wheel, swtimer_t* timer)
+{
+    swtimer_t** head = &wheel->slots[timer->level][timer->slot];
+
+    if (timer->prev != NULL)
+        timer->prev->next = timer->next;
+    else
+        *head = timer->next;
+    if (timer->next != NULL)
+        timer->next->prev = timer->prev;
+
+    if (*head == NULL)
+        wheel->occupied[timer->level] &= ~(1ull << timer->slot);
+    timer->active = 0;
+}
+
+/**
+ * Put the timer into the lowest level whose slots still reach its expiry
+ *
+ * @note Expiry equal to the current tick lands in the slot which is being expired
+*/
+static void swtimer_insert(swtimer_wheel_t* wheel, swtimer_t* timer)
+{
+    uint32_t now = wheel->now;
+
+    for (uint8_t level = 0; level < SWTIMER_LEVELS; level++) {
+        uint8_t shift = SWTIMER_SHIFT(level);
+        /* Masked to the width of the shifted counter so the distance is correct across the wrap */
+        uint32_t distance = ((timer->expiry >> shift) - (now >> shift)) & (UINT32_MAX >> shift);
+
+        if (distance < SWTIMER_SLOTS) {
+            swtimer_link(wheel, timer, level, (timer->expiry >> shift) & SWTIMER_SLOT_MASK);
+            return;
+        }
+    }
+
+    /* Out of range, parked in the farthest slot and inserted again when it is reached */
+    uint8_t shift = SWTIMER_SHIFT(SWTIMER_LEVELS - 1);
+    swtimer_link(wheel, timer, SWTIMER_LEVELS - 1, ((now >> shift) + SWTIMER_SLOTS - 1) & SWTIMER_SLOT_MASK);
+}
+
+/**
+ * Ticks until the wheel has work to do: a level 0 slot expires or a higher level slot is reached
+ *
+ * @return 0 if there are no timers
+*/
+static uint32_t swtimer_next_delta(swtimer_wheel_t* wheel)
+{
+    uint32_t now = wheel->now;
+    uint32_t best = 0;
+
+    for (uint8_t level = 0; level < SWTIMER_LEVELS; level++) {
+        if (wheel->occupied[level] == 0)
+            continue;
+
+        uint8_t shift = SWTIMER_SHIFT(level);
+        uint32_t next = (now >> shift) + 1;
+        uint32_t offset = (uint32_t)__builtin_ctzll(swtimer_rotr(wheel->occupied[level], next & SWTIMER_SLOT_MASK));
+        uint32_t delta = ((next + offset) << shift) - now;
+
+        if (best == 0 || delta < best)
+            best = delta;
+    }
+
+    return best;
+}
+
+/**
+ * Move the timers of a reached higher level slot down
+*/
+static void swtimer_cascade(swtimer_wheel_t* wheel, uint8_t level, uint8_t slot)
+{
+    swtimer_t* timer;
+
+    while ((timer = wheel->slots[level][slot]) != NULL) {
+        swtimer_unlink(wheel, timer);
+        swtimer_insert(wheel, timer);
+    }
+}
+
+/**
+ * Cascade reached slots and expire the current level 0 slot
+*/
+static void swtimer_process(swtimer_wheel_t* wheel)
+{
+    uint32_t now = wheel->now;
+    uint8_t slot = now & SWTIMER_SLOT_MASK;
+    swtimer_t* timer;
+
+    /* Higher levels first, their timers can land in the lower level slots reached now */
+    for (uint8_t level = SWTIMER_LEVELS - 1; level > 0; level--) {
+        if ((now & ((1u << SWTIMER_SHIFT(level)) - 1)) == 0)
+            swtimer_cascade(wheel, level, (now >> SWTIMER_SHIFT(level)) & SWTIMER_SLOT_MASK);
+    }
+
+    /* One timer at a time, so callbacks can start and stop any timer */
+    while ((timer = wheel->slots[0][slot]) != NULL) {
+        swtimer_unlink(wheel, timer);
+
+        if (timer->period != 0) {
+            /* Periods missed because of a late tick are skipped, phase is kept */
+            uint32_t late = now - timer->expiry;
+            timer->expiry += (late / timer->period + 1) * timer->period;
+            swtimer_insert(wheel, timer);
+        }
+
+        timer->callback(timer->arg);
+    }
+}
+
+/**
+ * Advance by `ticks`, jumping directly between the ticks which have work to do
+*/
+static void swtimer_advance(swtimer_wheel_t* wheel, uint32_t ticks)
+{
+    while (ticks > 0) {
+        uint32_t delta = swtimer_next_delta(wheel);
+        uint32_t step = (delta == 0 || delta > ticks) ? ticks : delta;
+
+        wheel->now += step;
+        ticks -= step;
+        swtimer_process(wheel);
+    }
+}
+
+/**
+ * Set the hardware timer period to the next deadline
+*/
+static void swtimer_reprogram(swtimer_wheel_t* wheel, uint32_t delta)
+{
+    uint32_t max = TIMER_COUNT_MAX / wheel->tick_counts;
+
+    if (delta == 0 || delta > max)
+        delta = max;
+
+    wheel->programmed = delta;
+    timer_set_period(wheel->timer, (timer_count_t)(delta * wheel->tick_counts));
+}
+
+/**
+ * Initialize the wheel and start the hardware timer
+*/
+status_t swtimer_wheel_open(swtimer_wheel_t* wheel, hal_timer_t timer, timer_count_t tick_counts, uint8_t tickless)
+{
+    if (tick_counts == 0)
+        return STATUS_ERROR;
+
+    wheel->timer = timer;
+    wheel->now = 0;
+    wheel->tick_counts = tick_counts;
+    wheel->tickless = tickless;
+    wheel->programmed = 1;
+
+    for (uint8_t level = 0; level < SWTIMER_LEVELS; level++) {
+        wheel->occupied[level] = 0;
+        for (uint8_t slot = 0; slot < SWTIMER_SLOTS; slot++)
+            wheel->slots[level][slot] = NULL;
+    }
+
+    if (tickless)
+        swtimer_reprogram(wheel, 0);
+    else if (timer_set_period(timer, tick_counts) != HAL_STATUS_OK)
+        return STATUS_ERROR;
+
+    if (timer_clear(timer) != HAL_STATUS_OK || timer_start(timer) != HAL_STATUS_OK)
+        return STATUS_ERROR;
+
+    return STATUS_OK;
+}
+
+/**
+ * Current tick
+*/
+uint32_t swtimer_wheel_now(swtimer_wheel_t* wheel)
+{
+    return wheel->now;
+}
+
+/**
+ * Advance by one tick, or in tickless mode by the programmed ticks and program the next deadline
+*/
+void swtimer_wheel_isr(swtimer_wheel_t* wheel)
+{
+    if (!wheel->tickless) {
+        swtimer_advance(wheel, 1);
+        return;
+    }
+
+    swtimer_advance(wheel, wheel->programmed);
+    swtimer_reprogram(wheel, swtimer_next_delta(wheel));
+}
+
+/**
+ * Initialize the timer structure
+*/
+status_t swtimer_init(swtimer_t* timer, swtimer_callback_t callback, void* arg)
+{
+    if (callback == NULL)
+        return STATUS_ERROR;
+
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->active = 0;
+
+    return STATUS_OK;
+}
+
+/**
+ * Insert the timer, in tickless mode shorten the programmed period if it expires earlier
+*/
+status_t swtimer_start(swtimer_wheel_t* wheel, swtimer_t* timer, uint32_t delay, uint32_t period)
+{
+    uint32_t elapsed = 0;
+
+    if (delay == 0)
+        delay = 1;
+
+    SWTIMER_LOCK();
+
+    if (timer->active)
+        swtimer_unlink(wheel, timer);
+
+    /* Ticks passed since the last ISR are not yet counted in `now` */
+    if (wheel->tickless)
+        elapsed = timer_get_count(wheel->timer) / wheel->tick_counts;
+
+    timer->expiry = wheel->now + elapsed + delay;
+    timer->period = period;
+    swtimer_insert(wheel, timer);
+
+    if (wheel->tickless && elapsed + delay < wheel->programmed)
+        swtimer_reprogram(wheel, elapsed + delay);
+
+    SWTIMER_UNLOCK();
+
+    return STATUS_OK;
+}
+
+/**
+ * Unlink the timer
+*/
+status_t swtimer_stop(swtimer_wheel_t* wheel, swtimer_t* timer)
+{
+    SWTIMER_LOCK();
+
+    if (timer->active)
+        swtimer_unlink(wheel, timer);
+
+    SWTIMER_UNLOCK();
+
+    return STATUS_OK;
+}
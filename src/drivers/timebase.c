@@ -0,0 +1,109 @@
+#include "drivers/timebase.h"
+
+#define NS_PER_SEC  (1000000000ull)
+#define US_PER_SEC  (1000000ull)
+
+/**
+ * (`x` * `mult`) >> 32 using only 32x32 multiplications
+ *
+ * @note Result must fit in 64 bits
+*/
+static uint64_t timebase_mul_q32(uint64_t x, uint64_t mult)
+{
+    uint64_t x_hi = x >> 32, x_lo = (uint32_t)x;
+    uint64_t m_hi = mult >> 32, m_lo = (uint32_t)mult;
+
+    return ((x_hi * m_hi) << 32) + x_hi * m_lo + x_lo * m_hi + ((x_lo * m_lo) >> 32);
+}
+
+/**
+ * Set the timer period and start counting from 0
+*/
+status_t timebase_open(timebase_t* timebase, hal_timer_t timer, uint32_t frequency, timer_count_t period)
+{
+    if (frequency == 0)
+        return STATUS_ERROR;
+
+    timebase->timer = timer;
+    timebase->frequency = frequency;
+    timebase->period = period != 0 ? period : (uint64_t)(timer_count_t)~(timer_count_t)0 + 1;
+    atomic_init(&timebase->seq, 0);
+    timebase->base[0] = 0;
+    timebase->base[1] = 0;
+
+    timebase->ns_per_tick = (NS_PER_SEC << 32) / frequency;
+    timebase->us_per_tick = (US_PER_SEC << 32) / frequency;
+    timebase->ticks_per_us = ((uint64_t)frequency << 32) / US_PER_SEC;
+
+    if (timer_set_period(timer, period) != HAL_STATUS_OK || timer_clear(timer) != HAL_STATUS_OK ||
+        timer_start(timer) != HAL_STATUS_OK)
+        return STATUS_ERROR;
+
+    return STATUS_OK;
+}
+
+/**
+ * Only writer of the base, writes the slot readers do not use and then switches to it
+*/
+void timebase_isr(timebase_t* timebase)
+{
+    unsigned int seq = atomic_load_explicit(&timebase->seq, memory_order_relaxed);
+
+    timebase->base[(seq + 1) & 1] = timebase->base[seq & 1] + timebase->period;
+
+    atomic_store_explicit(&timebase->seq, seq + 1, memory_order_release);
+}
+
+/**
+ * Base and count read consistently
+ *
+ * @note Retries only if the ISR completed during the read, a reader which interrupts
+ * the ISR reads the slot it is not writing and never waits for it
+*/
+uint64_t timebase_now(timebase_t* timebase)
+{
+    unsigned int seq;
+    uint64_t base;
+    timer_count_t count;
+    uint8_t pending;
+
+    do {
+        seq = atomic_load_explicit(&timebase->seq, memory_order_acquire);
+        base = timebase->base[seq & 1];
+
+        count = timer_get_count(timebase->timer);
+        pending = TIMEBASE_PERIOD_PENDING(timebase->timer);
+        /* Count read before the pending check can still be from before the wrap */
+        if (pending)
+            count = timer_get_count(timebase->timer);
+
+        atomic_thread_fence(memory_order_acquire);
+    } while (seq != atomic_load_explicit(&timebase->seq, memory_order_relaxed));
+
+    return base + (pending ? timebase->period : 0) + count;
+}
+
+uint64_t timebase_ticks_to_ns(timebase_t* timebase, uint64_t ticks)
+{
+    return timebase_mul_q32(ticks, timebase->ns_per_tick);
+}
+
+uint64_t timebase_ticks_to_us(timebase_t* timebase, uint64_t ticks)
+{
+    return timebase_mul_q32(ticks, timebase->us_per_tick);
+}
+
+uint64_t timebase_us_to_ticks(timebase_t* timebase, uint64_t us)
+{
+    return timebase_mul_q32(us, timebase->ticks_per_us);
+}
+
+uint64_t timebase_now_ns(timebase_t* timebase)
+{
+    return timebase_ticks_to_ns(timebase, timebase_now(timebase));
+}
+
+uint64_t timebase_now_us(timebase_t* timebase)
+{
+    return timebase_ticks_to_us(timebase, timebase_now(timebase));
+}
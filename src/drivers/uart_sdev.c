@@ -0,0 +1,311 @@
+#include "drivers/uart_sdev.h"
+#include "drivers/sdev.h"
+
+/**
+ * Start receiving into the free span at the head of the receive ring
+*/
+static void uart_sdev_rx_arm(uart_sdev_context_t* context)
+{
+    uint8_t* slot;
+    size_t len = ring_write_span(&context->rx, &slot);
+
+    if (len == 0) {
+        /* Ring is full, rearmed once the reader frees some space */
+        atomic_store(&context->rx_stalled, true);
+        return;
+    }
+
+    if (len > UART_SDEV_RX_CHUNK_MAX)
+        len = UART_SDEV_RX_CHUNK_MAX;
+
+    /* Set before starting, a short span can complete before the start returns */
+    context->rx_len = len;
+    atomic_store(&context->rx_start, atomic_load_explicit(&context->rx.head, memory_order_relaxed));
+
+    if (uart_recv_it(context->uart, slot, (uint16_t)len, 0) != HAL_STATUS_OK) {
+        context->rx_errors++;
+        atomic_store(&context->rx_stalled, true);
+    }
+}
+
+/**
+ * Publish the bytes received so far, or restart the reception if it stalled
+ *
+ * @note The receive ISR can publish the same bytes, both publish up to ring positions
+ * so whichever comes last does nothing
+*/
+static void uart_sdev_rx_poll(uart_sdev_context_t* context)
+{
+    if (atomic_exchange(&context->rx_stalled, false)) {
+        uart_sdev_rx_arm(context);
+        return;
+    }
+
+    size_t start = atomic_load(&context->rx_start);
+    uint16_t count = uart_recv_it_count(context->uart);
+
+    /* Span completed and the next one was armed (or failed to) meanwhile, the count
+     * may belong to either span but the ISR already published the completed one */
+    if (atomic_load(&context->rx_start) != start || atomic_load(&context->rx_stalled))
+        return;
+
+    ring_commit_to(&context->rx, start + count);
+}
+
+/**
+ * Start sending the next chunk from the transmit ring if not already sending
+ *
+ * @note Safe to call from both the writer and the send ISR, only one of them claims the UART
+ *
+ * @return `STATUS_ERROR` if a chunk could not be started, it is kept in the ring
+*/
+static status_t uart_sdev_tx_kick(uart_sdev_context_t* context)
+{
+    while (ring_used(&context->tx) > 0) {
+        if (atomic_flag_test_and_set(&context->tx_active))
+            return STATUS_OK;
+
+        uint8_t* chunk;
+        size_t len = ring_read_span(&context->tx, &chunk);
+
+        /* Drained by the previous owner after the check above */
+        if (len == 0) {
+            atomic_flag_clear(&context->tx_active);
+            continue;
+        }
+
+        if (len > UART_SDEV_TX_CHUNK_MAX)
+            len = UART_SDEV_TX_CHUNK_MAX;
+
+        context->tx_inflight = len;
+        if (uart_send_it(context->uart, chunk, (uint16_t)len, 0) != HAL_STATUS_OK) {
+            /* Data is kept in the ring and retried on the next write */
+            context->tx_inflight = 0;
+            context->tx_errors++;
+            atomic_flag_clear(&context->tx_active);
+            return STATUS_ERROR;
+        }
+        return STATUS_OK;
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * Release the sent chunk and chain the next one
+*/
+void uart_sdev_send_isr(uart_sdev_context_t* context, hal_status_t status)
+{
+    /* On error the chunk is dropped, retrying could stall the line indefinitely */
+    if (status != HAL_STATUS_OK)
+        context->tx_errors++;
+
+    ring_consume(&context->tx, context->tx_inflight);
+    context->tx_inflight = 0;
+    atomic_flag_clear(&context->tx_active);
+
+    uart_sdev_tx_kick(context);
+}
+
+/**
+ * Publish the received span and rearm receiving
+*/
+void uart_sdev_recv_isr(uart_sdev_context_t* context, hal_status_t status)
+{
+    size_t start = atomic_load(&context->rx_start);
+
+    if (status == HAL_STATUS_OK) {
+        ring_commit_to(&context->rx, start + context->rx_len);
+    } else {
+        /* Keep what was received before the error */
+        context->rx_errors++;
+        ring_commit_to(&context->rx, start + uart_recv_it_count(context->uart));
+    }
+
+    uart_sdev_rx_arm(context);
+}
+
+/**
+ * Serial device write handler for a UART
+ *
+ * @note Non-blocking, fails without writing anything if the transmit ring can not fit all data
+*/
+static status_t uart_sdev_write(void* context, uint8_t* data, size_t nbyte)
+{
+    uart_sdev_context_t* params = (uart_sdev_context_t*)context;
+
+    if (ring_write(&params->tx, data, nbyte) != STATUS_OK)
+        return STATUS_ERROR;
+
+    uart_sdev_tx_kick(params);
+
+    return STATUS_OK;
+}
+
+/**
+ * Serial device read handler for a UART
+ *
+ * @note Non-blocking, fails without reading anything if less than `nbyte` bytes are buffered
+*/
+static status_t uart_sdev_read(void* context, uint8_t* data, size_t nbyte)
+{
+    uart_sdev_context_t* params = (uart_sdev_context_t*)context;
+
+    uart_sdev_rx_poll(params);
+
+    if (ring_used(&params->rx) < nbyte)
+        return STATUS_ERROR;
+
+    ring_read(&params->rx, data, nbyte);
+
+    /* Ring may have been full, restart with the freed space */
+    uart_sdev_rx_poll(params);
+
+    return STATUS_OK;
+}
+
+/**
+ * Serial device writev handler for a UART, the segments follow each other in the stream
+ *
+ * @note Non-blocking, fails without writing anything if the transmit ring can not fit all segments
+*/
+static status_t uart_sdev_writev(void* context, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    uart_sdev_context_t* params = (uart_sdev_context_t*)context;
+    size_t total = 0;
+
+    for (size_t i = 0; i < iovcnt; i++)
+        total += iov[i].nbyte;
+
+    if (ring_free(&params->tx) < total)
+        return STATUS_ERROR;
+
+    for (size_t i = 0; i < iovcnt; i++)
+        ring_write(&params->tx, iov[i].data, iov[i].nbyte);
+
+    uart_sdev_tx_kick(params);
+
+    return STATUS_OK;
+}
+
+/**
+ * Serial device readv handler for a UART
+ *
+ * @note Non-blocking, fails without reading anything if less than the total length is buffered
+*/
+static status_t uart_sdev_readv(void* context, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    uart_sdev_context_t* params = (uart_sdev_context_t*)context;
+    size_t total = 0;
+
+    for (size_t i = 0; i < iovcnt; i++)
+        total += iov[i].nbyte;
+
+    uart_sdev_rx_poll(params);
+
+    if (ring_used(&params->rx) < total)
+        return STATUS_ERROR;
+
+    for (size_t i = 0; i < iovcnt; i++)
+        ring_read(&params->rx, iov[i].data, iov[i].nbyte);
+
+    /* Ring may have been full, restart with the freed space */
+    uart_sdev_rx_poll(params);
+
+    return STATUS_OK;
+}
+
+/**
+ * Serial device test handler for a UART
+*/
+static status_t uart_sdev_test(void* context)
+{
+    UNUSED(context);
+
+    /* No way to detect the other side on a UART */
+    return STATUS_OK;
+}
+
+/**
+ * Serial device ioctl handler for a UART
+*/
+static status_t uart_sdev_ioctl(void* context, int ctl_type, void* arg)
+{
+    uart_sdev_context_t* params = (uart_sdev_context_t*)context;
+
+    switch (ctl_type) {
+    case UART_SDEV_IOCTL_RX_AVAILABLE:
+        uart_sdev_rx_poll(params);
+        *(size_t*)arg = ring_used(&params->rx);
+        return STATUS_OK;
+    case UART_SDEV_IOCTL_TX_FREE:
+        *(size_t*)arg = ring_free(&params->tx);
+        return STATUS_OK;
+    case UART_SDEV_IOCTL_FLUSH: {
+        uint32_t failures = 0;
+
+        /* Chunks in flight complete on their own, only failing starts are counted */
+        while (ring_used(&params->tx) > 0) {
+            if (uart_sdev_tx_kick(params) != STATUS_OK) {
+                if (++failures >= UART_SDEV_FLUSH_TRIES)
+                    return STATUS_ERROR;
+            } else {
+                failures = 0;
+            }
+            UART_SDEV_FLUSH_WAIT();
+        }
+        return STATUS_OK;
+    }
+    default:
+        return STATUS_NOT_IMPLEMENTED;
+    }
+}
+
+/**
+ * Serial device close handler for a UART
+*/
+static status_t uart_sdev_close(void* context)
+{
+    UNUSED(context);
+
+    return STATUS_OK;
+}
+
+/**
+ * Initialize the serial device object for the UART and start receiving
+ *
+ * @note Requires static context allocation
+*/
+status_t uart_sdev_open(uart_t uart, sdev_t* device, uart_sdev_context_t* context,
+    uint8_t* tx_buffer, size_t tx_len, uint8_t* rx_buffer, size_t rx_len)
+{
+    static sdev_ops_t uart_sdev_ops = {
+        .test = &uart_sdev_test,
+        .write = &uart_sdev_write,
+        .read = &uart_sdev_read,
+        .writev = &uart_sdev_writev,
+        .readv = &uart_sdev_readv,
+        .ioctl = &uart_sdev_ioctl,
+        .close = &uart_sdev_close
+    };
+
+    if (context == NULL)
+        return STATUS_ERROR;
+
+    if (ring_init(&context->tx, tx_buffer, tx_len) != STATUS_OK ||
+        ring_init(&context->rx, rx_buffer, rx_len) != STATUS_OK)
+        return STATUS_ERROR;
+
+    context->uart = uart;
+    context->tx_inflight = 0;
+    context->tx_errors = 0;
+    context->rx_errors = 0;
+    atomic_flag_clear(&context->tx_active);
+    atomic_init(&context->rx_start, 0);
+    context->rx_len = 0;
+    atomic_init(&context->rx_stalled, false);
+
+    uart_sdev_rx_arm(context);
+
+    return sdev_open(device, &uart_sdev_ops, context);
+}
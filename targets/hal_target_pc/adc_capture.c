@@ -0,0 +1,518 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "adc_capture.h"
+
+#define ADC_CAPTURE_PATH_LEN    (256)
+#define NS_PER_SEC              (1000000000ull)
+
+_Static_assert(sizeof(adc_capture_header_t) <= ADC_CAPTURE_HEADER_LEN, "Capture header too large");
+
+static uint64_t adc_capture_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Bytes of sample data in one file
+*/
+static size_t adc_capture_data_len(adc_capture_t* capture)
+{
+    size_t len = capture->config.file_samples * sizeof(uint16_t);
+
+    return (len + ADC_CAPTURE_BLOCK_LEN - 1) / ADC_CAPTURE_BLOCK_LEN * ADC_CAPTURE_BLOCK_LEN;
+}
+
+static adc_capture_header_t* adc_capture_header(adc_capture_file_t* file)
+{
+    return (adc_capture_header_t*)file->map;
+}
+
+/**
+ * Path of the file with the given index, files are reused in rotation if `max_files` is set
+*/
+static void adc_capture_path(adc_capture_t* capture, uint32_t index, char* path)
+{
+    uint32_t slot = capture->config.max_files != 0 ? index % capture->config.max_files : index;
+
+    snprintf(path, ADC_CAPTURE_PATH_LEN, "%s_%04u.adc", capture->config.path_prefix, slot);
+}
+
+/**
+ * Create, preallocate and map the file with the given index
+*/
+static status_t adc_capture_file_create(adc_capture_t* capture, adc_capture_file_t* file, uint32_t index)
+{
+    char path[ADC_CAPTURE_PATH_LEN];
+
+    adc_capture_path(capture, index, path);
+
+    file->size = ADC_CAPTURE_HEADER_LEN + adc_capture_data_len(capture);
+    file->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file->fd < 0)
+        return STATUS_ERROR;
+
+    /* Allocate all blocks now so writing never waits for the file system to extend the file */
+    if (posix_fallocate(file->fd, 0, (off_t)file->size) != 0) {
+        close(file->fd);
+        return STATUS_ERROR;
+    }
+
+    file->map = mmap(NULL, file->size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+    if (file->map == MAP_FAILED) {
+        close(file->fd);
+        return STATUS_ERROR;
+    }
+    madvise(file->map, file->size, MADV_SEQUENTIAL);
+
+    adc_capture_header_t* header = adc_capture_header(file);
+    memset(header, 0, ADC_CAPTURE_HEADER_LEN);
+    memcpy(header->magic, ADC_CAPTURE_MAGIC, sizeof(header->magic));
+    header->version = ADC_CAPTURE_VERSION;
+    header->header_len = ADC_CAPTURE_HEADER_LEN;
+    header->block_len = ADC_CAPTURE_BLOCK_LEN;
+    header->sample_rate = capture->config.sample_rate;
+    header->n_channels = capture->config.n_channels;
+    header->sample_bits = 16;
+    header->file_index = index;
+    memcpy(header->channels, capture->config.channels, capture->config.n_channels);
+
+    return STATUS_OK;
+}
+
+/**
+ * Write back the remaining data and the header, then unmap the file
+*/
+static status_t adc_capture_file_finish(adc_capture_file_t* file, uint8_t sync)
+{
+    status_t status = STATUS_OK;
+
+    if (file->map == NULL)
+        return STATUS_OK;
+
+    if (sync && msync(file->map, file->size, MS_SYNC) != 0)
+        status = STATUS_ERROR;
+    if (munmap(file->map, file->size) != 0 || close(file->fd) != 0)
+        status = STATUS_ERROR;
+    file->map = NULL;
+
+    return status;
+}
+
+/**
+ * Fill in the timing of the file which starts at the current total sample count
+*/
+static void adc_capture_file_start(adc_capture_t* capture)
+{
+    adc_capture_header_t* header = adc_capture_header(&capture->current);
+    uint64_t frames = capture->total / capture->config.n_channels;
+
+    header->first_sample = capture->total;
+    header->recording_start_ns = capture->start_ns;
+    header->file_start_ns = capture->start_ns;
+    /* Split so the product does not overflow for long recordings */
+    if (capture->config.sample_rate != 0)
+        header->file_start_ns += (frames / capture->config.sample_rate) * NS_PER_SEC
+            + (frames % capture->config.sample_rate) * NS_PER_SEC / capture->config.sample_rate;
+
+    capture->pos = 0;
+    capture->synced = 0;
+}
+
+/**
+ * Preparation thread, finishes the retired file and creates the one after the current file
+*/
+static void* adc_capture_thread(void* arg)
+{
+    adc_capture_t* capture = arg;
+
+    pthread_mutex_lock(&capture->lock);
+    for (;;) {
+        while (!capture->preparing && !capture->stop)
+            pthread_cond_wait(&capture->cond, &capture->lock);
+        if (!capture->preparing)
+            break;
+
+        adc_capture_file_t retired = capture->retired;
+        adc_capture_file_t next = { .fd = -1, .map = NULL, .size = 0 };
+        uint32_t index = capture->index + 1;
+        pthread_mutex_unlock(&capture->lock);
+
+        /* Write back is already started for all blocks, no need to wait for it */
+        status_t retire_status = adc_capture_file_finish(&retired, 0);
+        if (adc_capture_file_create(capture, &next, index) != STATUS_OK)
+            next.map = NULL;
+
+        pthread_mutex_lock(&capture->lock);
+        if (retire_status != STATUS_OK)
+            capture->retire_error = 1;
+        capture->retired.map = NULL;
+        capture->next = next;
+        capture->preparing = 0;
+        pthread_cond_broadcast(&capture->cond);
+    }
+    pthread_mutex_unlock(&capture->lock);
+
+    return NULL;
+}
+
+/**
+ * Hand the retired file and the preparation of the next one to the thread
+ *
+ * @note Called with the lock held
+*/
+static void adc_capture_prepare(adc_capture_t* capture)
+{
+    capture->preparing = 1;
+    pthread_cond_signal(&capture->cond);
+}
+
+/**
+ * Validate the configuration, create the first file and start preparing the next one
+*/
+status_t adc_capture_open(adc_capture_t* capture, const adc_capture_config_t* config)
+{
+    if (config->path_prefix == NULL || config->channels == NULL || config->n_channels == 0 ||
+        config->n_channels > ADC_CAPTURE_MAX_CHANNELS || config->file_samples == 0 ||
+        config->max_files == 1)
+        return STATUS_ERROR;
+
+    capture->config = *config;
+    capture->current.map = NULL;
+    capture->next.map = NULL;
+    capture->retired.map = NULL;
+    capture->index = 0;
+    capture->total = 0;
+    capture->start_ns = adc_capture_now_ns();
+    capture->preparing = 0;
+    capture->stop = 0;
+    capture->retire_error = 0;
+
+    if (adc_capture_file_create(capture, &capture->current, 0) != STATUS_OK)
+        return STATUS_ERROR;
+    adc_capture_file_start(capture);
+
+    pthread_mutex_init(&capture->lock, NULL);
+    pthread_cond_init(&capture->cond, NULL);
+    if (pthread_create(&capture->thread, NULL, &adc_capture_thread, capture) != 0) {
+        pthread_cond_destroy(&capture->cond);
+        pthread_mutex_destroy(&capture->lock);
+        adc_capture_file_finish(&capture->current, 0);
+        return STATUS_ERROR;
+    }
+
+    pthread_mutex_lock(&capture->lock);
+    adc_capture_prepare(capture);
+    pthread_mutex_unlock(&capture->lock);
+
+    return STATUS_OK;
+}
+
+/**
+ * Publish the completed blocks in the header and start their asynchronous write back
+*/
+static status_t adc_capture_sync_blocks(adc_capture_t* capture)
+{
+    size_t bytes = capture->pos * sizeof(uint16_t);
+    size_t end = bytes / ADC_CAPTURE_BLOCK_LEN * ADC_CAPTURE_BLOCK_LEN;
+    size_t start = capture->synced * sizeof(uint16_t);
+
+    if (end <= start)
+        return STATUS_OK;
+
+    uint8_t* data = capture->current.map + ADC_CAPTURE_HEADER_LEN;
+    if (msync(data + start, end - start, MS_ASYNC) != 0)
+        return STATUS_ERROR;
+
+    capture->synced = end / sizeof(uint16_t);
+    /* Readers of the running recording see the count only after the samples */
+    atomic_thread_fence(memory_order_release);
+    adc_capture_header(&capture->current)->sample_count = capture->synced;
+
+    return STATUS_OK;
+}
+
+/**
+ * Switch to the prepared file, the thread finishes the full one and prepares the next
+ *
+ * @note Waits only if the thread has not finished the previous preparation yet
+*/
+static status_t adc_capture_rotate(adc_capture_t* capture)
+{
+    status_t status = STATUS_OK;
+
+    pthread_mutex_lock(&capture->lock);
+    while (capture->preparing)
+        pthread_cond_wait(&capture->cond, &capture->lock);
+
+    /* Preparing the next file failed, retry now while the thread is idle */
+    if (capture->next.map == NULL &&
+        adc_capture_file_create(capture, &capture->next, capture->index + 1) != STATUS_OK) {
+        pthread_mutex_unlock(&capture->lock);
+        return STATUS_ERROR;
+    }
+
+    if (capture->retire_error) {
+        capture->retire_error = 0;
+        status = STATUS_ERROR;
+    }
+
+    adc_capture_header(&capture->current)->sample_count = capture->pos;
+    capture->retired = capture->current;
+    capture->current = capture->next;
+    capture->next.map = NULL;
+    capture->index++;
+    adc_capture_file_start(capture);
+    adc_capture_prepare(capture);
+    pthread_mutex_unlock(&capture->lock);
+
+    return status;
+}
+
+/**
+ * Copy the samples into the mapping
+*/
+status_t adc_capture_write(adc_capture_t* capture, const uint16_t* samples, size_t count)
+{
+    size_t capacity = adc_capture_data_len(capture) / sizeof(uint16_t);
+    status_t status = STATUS_OK;
+
+    if (capture->current.map == NULL)
+        return STATUS_ERROR;
+
+    while (count > 0) {
+        size_t n = capacity - capture->pos;
+        if (n > count)
+            n = count;
+
+        uint16_t* data = (uint16_t*)(capture->current.map + ADC_CAPTURE_HEADER_LEN);
+        memcpy(&data[capture->pos], samples, n * sizeof(uint16_t));
+        capture->pos += n;
+        capture->total += n;
+        samples += n;
+        count -= n;
+
+        if (adc_capture_sync_blocks(capture) != STATUS_OK)
+            status = STATUS_ERROR;
+
+        if (capture->pos == capacity && adc_capture_rotate(capture) != STATUS_OK) {
+            status = STATUS_ERROR;
+            /* No file to continue in, rest of the samples is dropped */
+            if (capture->pos == capacity)
+                break;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Stop the thread once it is idle and finish the recording
+*/
+status_t adc_capture_close(adc_capture_t* capture)
+{
+    status_t status = STATUS_OK;
+
+    if (capture->current.map == NULL)
+        return STATUS_ERROR;
+
+    pthread_mutex_lock(&capture->lock);
+    while (capture->preparing)
+        pthread_cond_wait(&capture->cond, &capture->lock);
+    capture->stop = 1;
+    pthread_cond_signal(&capture->cond);
+    pthread_mutex_unlock(&capture->lock);
+
+    pthread_join(capture->thread, NULL);
+    pthread_cond_destroy(&capture->cond);
+    pthread_mutex_destroy(&capture->lock);
+
+    if (capture->retire_error)
+        status = STATUS_ERROR;
+
+    adc_capture_header(&capture->current)->sample_count = capture->pos;
+    if (adc_capture_file_finish(&capture->current, 1) != STATUS_OK)
+        status = STATUS_ERROR;
+
+    /* Prepared file was never written */
+    if (capture->next.map != NULL) {
+        char path[ADC_CAPTURE_PATH_LEN];
+
+        if (adc_capture_file_finish(&capture->next, 0) != STATUS_OK)
+            status = STATUS_ERROR;
+        adc_capture_path(capture, capture->index + 1, path);
+        unlink(path);
+    }
+
+    return status;
+}
+
+/**
+ * Map an existing file of the recording read only and check its header
+*/
+static status_t adc_capture_file_open(const char* path, adc_capture_file_t* file)
+{
+    struct stat st;
+
+    file->fd = open(path, O_RDONLY);
+    if (file->fd < 0)
+        return STATUS_ERROR;
+
+    if (fstat(file->fd, &st) != 0 || (size_t)st.st_size < ADC_CAPTURE_HEADER_LEN) {
+        close(file->fd);
+        return STATUS_ERROR;
+    }
+    file->size = (size_t)st.st_size;
+
+    /* Shared mapping, so samples completed by a running recording become visible */
+    file->map = mmap(NULL, file->size, PROT_READ, MAP_SHARED, file->fd, 0);
+    if (file->map == MAP_FAILED) {
+        file->map = NULL;
+        close(file->fd);
+        return STATUS_ERROR;
+    }
+
+    adc_capture_header_t* header = adc_capture_header(file);
+    if (memcmp(header->magic, ADC_CAPTURE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ADC_CAPTURE_VERSION || header->header_len != ADC_CAPTURE_HEADER_LEN ||
+        header->n_channels == 0 || header->n_channels > ADC_CAPTURE_MAX_CHANNELS) {
+        adc_capture_file_finish(file, 0);
+        return STATUS_ERROR;
+    }
+    madvise(file->map, file->size, MADV_SEQUENTIAL);
+
+    return STATUS_OK;
+}
+
+/**
+ * Path of the file with the given index for the reader, same naming as the recorder
+*/
+static void adc_capture_reader_path(adc_capture_reader_t* reader, uint32_t index, char* path)
+{
+    uint32_t slot = reader->max_files != 0 ? index % reader->max_files : index;
+
+    snprintf(path, ADC_CAPTURE_PATH_LEN, "%s_%04u.adc", reader->path_prefix, slot);
+}
+
+/**
+ * Open the file with the given index, fails if its slot holds another file of the rotation
+*/
+static status_t adc_capture_reader_load(adc_capture_reader_t* reader, uint32_t index, adc_capture_file_t* file)
+{
+    char path[ADC_CAPTURE_PATH_LEN];
+
+    adc_capture_reader_path(reader, index, path);
+    if (adc_capture_file_open(path, file) != STATUS_OK)
+        return STATUS_ERROR;
+
+    if (adc_capture_header(file)->file_index != index) {
+        adc_capture_file_finish(file, 0);
+        return STATUS_ERROR;
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * Find the oldest file, with rotation it is the lowest index found in the slots
+*/
+status_t adc_capture_reader_open(adc_capture_reader_t* reader, const char* path_prefix, uint32_t max_files)
+{
+    uint32_t first = 0;
+    uint8_t found = 0;
+
+    if (path_prefix == NULL || max_files == 1)
+        return STATUS_ERROR;
+
+    reader->path_prefix = path_prefix;
+    reader->max_files = max_files;
+    reader->file.map = NULL;
+    reader->pos = 0;
+
+    for (uint32_t slot = 0; slot < max_files; slot++) {
+        char path[ADC_CAPTURE_PATH_LEN];
+        adc_capture_file_t file;
+
+        adc_capture_reader_path(reader, slot, path);
+        if (adc_capture_file_open(path, &file) != STATUS_OK)
+            continue;
+
+        uint32_t index = adc_capture_header(&file)->file_index;
+        adc_capture_file_finish(&file, 0);
+
+        if (!found || index < first) {
+            first = index;
+            found = 1;
+        }
+    }
+
+    reader->index = first;
+
+    return adc_capture_reader_load(reader, first, &reader->file);
+}
+
+const adc_capture_header_t* adc_capture_reader_header(adc_capture_reader_t* reader)
+{
+    return adc_capture_header(&reader->file);
+}
+
+/**
+ * Copy the completed samples, move to the next file once the current one is full
+*/
+size_t adc_capture_read(adc_capture_reader_t* reader, uint16_t* samples, size_t count)
+{
+    size_t total = 0;
+
+    if (reader->file.map == NULL)
+        return 0;
+
+    while (count > 0) {
+        const volatile adc_capture_header_t* header = adc_capture_header(&reader->file);
+        uint64_t capacity = (reader->file.size - ADC_CAPTURE_HEADER_LEN) / sizeof(uint16_t);
+        uint64_t available = header->sample_count;
+
+        /* Samples are written before the count which publishes them */
+        atomic_thread_fence(memory_order_acquire);
+        if (available > capacity)
+            available = capacity;
+
+        if (reader->pos < available) {
+            uint64_t n = available - reader->pos;
+            if (n > count)
+                n = count;
+
+            const uint16_t* data = (const uint16_t*)(reader->file.map + ADC_CAPTURE_HEADER_LEN);
+            memcpy(samples, &data[reader->pos], (size_t)n * sizeof(uint16_t));
+            reader->pos += n;
+            samples += n;
+            count -= (size_t)n;
+            total += (size_t)n;
+            continue;
+        }
+
+        /* Only a full file is followed by another one */
+        adc_capture_file_t next;
+        if (available < capacity || adc_capture_reader_load(reader, reader->index + 1, &next) != STATUS_OK)
+            break;
+
+        adc_capture_file_finish(&reader->file, 0);
+        reader->file = next;
+        reader->index++;
+        reader->pos = 0;
+    }
+
+    return total;
+}
+
+status_t adc_capture_reader_close(adc_capture_reader_t* reader)
+{
+    return adc_capture_file_finish(&reader->file, 0);
+}
@@ -0,0 +1,184 @@
+#ifndef HAL_TARGET_PC_ADC_CAPTURE_H
+#define HAL_TARGET_PC_ADC_CAPTURE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "common/types.h"
+
+/**
+ * Recorder of ADC samples to memory mapped capture files
+ *
+ * Files are preallocated and mapped, samples are copied into the mapping and completed
+ * blocks are written back asynchronously. When a file is full the recording continues in the
+ * next one. A background thread creates the next file in advance and finishes the full one,
+ * so rotating only swaps the mappings and does not stall the consumer.
+ *
+ * Typical use with drivers/adc_stream.h:
+ *
+ * @example
+ * const uint16_t* samples;
+ * size_t n = adc_stream_read_span(&stream, &samples);
+ * adc_capture_write(&capture, samples, n);
+ * adc_stream_release(&stream, n);
+ *
+ * Recordings are played back with `adc_capture_reader_t`, for example to feed captured
+ * signals into a simulation.
+ *
+ * @note Uses POSIX file mapping and threads, part of the PC target
+*/
+
+#define ADC_CAPTURE_MAGIC           "ADCCAP01"
+#define ADC_CAPTURE_VERSION         (1)
+#define ADC_CAPTURE_MAX_CHANNELS    (32)
+
+/**
+ * Size of the header and the alignment of the sample data
+*/
+#define ADC_CAPTURE_HEADER_LEN      (4096)
+
+/**
+ * Written back size, file data size is a multiple of it
+*/
+#ifndef ADC_CAPTURE_BLOCK_LEN
+#define ADC_CAPTURE_BLOCK_LEN       (64 * 1024)
+#endif
+
+/**
+ * File header, all values are little endian
+ *
+ * Samples follow at `header_len` as interleaved 16-bit values in the order of `channels`.
+*/
+typedef struct adc_capture_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_len;
+    uint32_t block_len;
+    uint32_t sample_rate;
+    uint8_t n_channels;
+    uint8_t sample_bits;
+    uint16_t reserved;
+    /* Position of the file in the recording */
+    uint32_t file_index;
+    uint8_t channels[ADC_CAPTURE_MAX_CHANNELS];
+    /* Index of the first sample of the file in the recording */
+    uint64_t first_sample;
+    /* Wall clock time of the first sample of the recording and of the file, in ns since the epoch */
+    uint64_t recording_start_ns;
+    uint64_t file_start_ns;
+    /* Number of valid samples, updated as blocks are completed */
+    uint64_t sample_count;
+} adc_capture_header_t;
+
+/**
+ * Recording parameters
+*/
+typedef struct adc_capture_config {
+    /* Files are named <path_prefix>_<index>.adc */
+    const char* path_prefix;
+    /* Channel list as passed to `adc_set_channels` */
+    const uint8_t* channels;
+    uint8_t n_channels;
+    uint32_t sample_rate;
+    /* Samples per file, rounded up to whole blocks */
+    size_t file_samples;
+    /* Number of files reused in rotation (at least 2, the next file is prepared in advance), 0 to keep all files */
+    uint32_t max_files;
+} adc_capture_config_t;
+
+/**
+ * Mapped capture file
+*/
+typedef struct adc_capture_file {
+    int fd;
+    uint8_t* map;
+    size_t size;
+} adc_capture_file_t;
+
+/**
+ * Recorder state
+ *
+ * @note Members should only be used through API functions starting with adc_capture_*
+*/
+typedef struct adc_capture {
+    adc_capture_config_t config;
+    adc_capture_file_t current;
+    uint32_t index;
+    /* Samples written to the current file and written back */
+    size_t pos;
+    size_t synced;
+    uint64_t total;
+    uint64_t start_ns;
+    /* Preparation thread, `next` and `retired` are owned by it while `preparing` is set */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    adc_capture_file_t next;
+    adc_capture_file_t retired;
+    uint8_t preparing;
+    uint8_t stop;
+    /* Finishing a retired file failed */
+    uint8_t retire_error;
+} adc_capture_t;
+
+/**
+ * Create the first file and start recording
+*/
+status_t adc_capture_open(adc_capture_t* capture, const adc_capture_config_t* config);
+
+/**
+ * Append `count` samples, rotating to the next file when the current one is full
+ *
+ * @note `count` should be a multiple of the number of channels
+*/
+status_t adc_capture_write(adc_capture_t* capture, const uint16_t* samples, size_t count);
+
+/**
+ * Finish the current file and release the prepared next one
+*/
+status_t adc_capture_close(adc_capture_t* capture);
+
+/**
+ * Player of a recording
+ *
+ * Follows the files of a recording in order and returns their samples. Reading can start
+ * while the recording is still written, samples are returned once their block is completed.
+ *
+ * @note Members should only be used through API functions starting with adc_capture_reader_*
+*/
+typedef struct adc_capture_reader {
+    const char* path_prefix;
+    uint32_t max_files;
+    adc_capture_file_t file;
+    uint32_t index;
+    /* Samples read from the current file */
+    uint64_t pos;
+} adc_capture_reader_t;
+
+/**
+ * Open the oldest file of the recording written with `path_prefix` and `max_files`
+ *
+ * @note With `max_files` set, the oldest files may already be overwritten, playback
+ * starts at the oldest file still present
+*/
+status_t adc_capture_reader_open(adc_capture_reader_t* reader, const char* path_prefix, uint32_t max_files);
+
+/**
+ * Header of the file being read, for the sample rate, channels and timing
+*/
+const adc_capture_header_t* adc_capture_reader_header(adc_capture_reader_t* reader);
+
+/**
+ * Read up to `count` samples, continuing in the next file when the current one is done
+ *
+ * @return Number of samples read, 0 at the end of the recording or if no more samples
+ * are completed yet
+*/
+size_t adc_capture_read(adc_capture_reader_t* reader, uint16_t* samples, size_t count);
+
+/**
+ * Close the file being read
+*/
+status_t adc_capture_reader_close(adc_capture_reader_t* reader);
+
+#endif
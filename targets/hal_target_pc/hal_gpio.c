@@ -48,9 +48,19 @@ inline void gpio_port_toggle(gpio_port_t port, gpio_pin_t pins)
  * @note Implement in hal_gpio.c
  * @note Multiple registrations should override the last one
 */
-inline hal_status_t gpio_register_callback(gpio_t gpio, gpio_pin_t pin, callback_t callback)
+inline hal_status_t gpio_register_callback(gpio_port_t port, gpio_pin_t pin, callback_t callback)
 {
-    #error "GPIO register callback not implemented"
+    if (pin == 0) {
+        return HAL_STATUS_ERROR;
+    }
+
+    for (uint8_t i = 0; i < 16; i++) {
+        if (pin & (1 << i)) {
+            port->callbacks[i] = callback;
+        }
+    }
+
+    return HAL_STATUS_OK;
 }
 #endif
 
@@ -80,7 +90,19 @@ void peripheral_socket_handle_gpio(hal_target_pc_gpio_t* port, uint8_t* message,
     port->in_reg &= ~(~values & pins);
 
     /* Interrupt callback */
+#ifdef HAL_GPIO_USE_REGISTER_CALLBACKS
+    /* Callback of each triggered pin, lowest pin first */
+    while (triggers != 0) {
+        uint8_t i = __builtin_ctz(triggers);
+        triggers &= triggers - 1;
+
+        if (port->callbacks[i] != NULL) {
+            port->callbacks[i](HAL_STATUS_OK);
+        }
+    }
+#else
     if (triggers != 0) {
         gpio_exti_isr(port, triggers);
     }
+#endif
 }
\ No newline at end of file
@@ -8,6 +8,23 @@
 #define I2C_ACK_BYTE        0xaa
 // #define SOCKET_I2C_NACK     0x55
 
+/**
+ * Route the end of an interrupt mode operation to the registered callback or the ISR
+*/
+static void i2c_dispatch(i2c_t i2c, i2c_callback_src_t src, hal_status_t status)
+{
+#ifdef HAL_I2C_USE_REGISTER_CALLBACKS
+    if (i2c->callbacks[src] != NULL) {
+        i2c->callbacks[src](status);
+    }
+#else
+    if (src == I2C_CB_SRC_MASTER_SEND_COMPLETE || src == I2C_CB_SRC_MASTER_SEND_ERROR) {
+        i2c_master_send_isr(i2c, status);
+    } else {
+        i2c_master_recv_isr(i2c, status);
+    }
+#endif
+}
 
 /**
  * Called on receive `SOCKET_I2C_ID` from the socket stream
@@ -49,8 +66,13 @@ void peripheral_socket_handle_i2c(hal_target_pc_i2c_t* i2c, uint8_t* msg, uint16
 
         /* If in interrupt mode, auto-reset I2C to be ready for next send */
         if (i2c->status != SP_SENDING && i2c->int_mode == 1) {
+            serial_port_status_t i2c_status = i2c->status;
             i2c->status = SP_READY;
-            i2c_master_send_isr(i2c, i2c->status == SP_FINISHED_OK ? HAL_STATUS_OK : HAL_STATUS_ERROR);
+            if (i2c_status == SP_FINISHED_OK) {
+                i2c_dispatch(i2c, I2C_CB_SRC_MASTER_SEND_COMPLETE, HAL_STATUS_OK);
+            } else {
+                i2c_dispatch(i2c, I2C_CB_SRC_MASTER_SEND_ERROR, HAL_STATUS_ERROR);
+            }
         }
     } else if (i2c->status == SP_RECEIVING) {
         if (i2c->wait_ack > 0) {
@@ -82,7 +104,11 @@ void peripheral_socket_handle_i2c(hal_target_pc_i2c_t* i2c, uint8_t* msg, uint16
         if (i2c->status != SP_RECEIVING && i2c->int_mode == 1) {
             serial_port_status_t i2c_status = i2c->status;
             i2c->status = SP_READY;
-            i2c_master_recv_isr(i2c, i2c_status == SP_FINISHED_OK ? HAL_STATUS_OK : HAL_STATUS_ERROR);
+            if (i2c_status == SP_FINISHED_OK) {
+                i2c_dispatch(i2c, I2C_CB_SRC_MASTER_RECV_COMPLETE, HAL_STATUS_OK);
+            } else {
+                i2c_dispatch(i2c, I2C_CB_SRC_MASTER_RECV_ERROR, HAL_STATUS_ERROR);
+            }
         }
     }
 }
@@ -237,11 +263,16 @@ inline hal_status_t i2c_master_recv_it(i2c_t i2c, uint16_t addr, uint8_t* buff,
  * @retval `HAL_STATUS_ERROR` callback registration failed
  * @note Implement in hal_i2c.c
  * @note Multiple registrations should override the last one
+ * @note Slave sources are rejected while slave mode is not implemented
 */
 inline hal_status_t i2c_register_callback(i2c_t i2c, callback_t callback, i2c_callback_src_t src)
 {
-    #error "I2C register callbacks not implemented"
-}
-#else
+    /* Slave mode is not simulated, its callbacks would never be called */
+    if (src > I2C_CB_SRC_MASTER_RECV_ERROR) {
+        return HAL_STATUS_ERROR;
+    }
 
-#endif
\ No newline at end of file
+    i2c->callbacks[src] = callback;
+    return HAL_STATUS_OK;
+}
+#endif
@@ -1,17 +1,391 @@
-#include "hal_io.h"
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal_io.h"
+
+#define HAL_IO_PRINTF_BUFFER_LEN    (512)
+
+/* Number of output cells, must be a power of two */
+#ifndef HAL_IO_TX_CELLS
+#define HAL_IO_TX_CELLS             (1024)
+#endif
+
+/* Data bytes in one output cell */
+#define HAL_IO_TX_CELL_LEN          (64)
+
+/* Size of the buffer the writer thread coalesces cells into */
+#define HAL_IO_TX_WRITE_LEN         (64 * 1024)
+
+/* Size of the receive ring, must be a power of two */
+#ifndef HAL_IO_RX_BUFFER_LEN
+#define HAL_IO_RX_BUFFER_LEN        (64 * 1024)
+#endif
+
+/* Size of a single read from stdin */
+#define HAL_IO_RX_READ_LEN          (4096)
+
+/* Longest the writer sleeps before checking the queue again */
+#define HAL_IO_TX_IDLE_NS           (10000000l)
+
+#if (HAL_IO_TX_CELLS & (HAL_IO_TX_CELLS - 1)) != 0
+#error "HAL_IO_TX_CELLS must be a power of two"
+#endif
+
+#if (HAL_IO_RX_BUFFER_LEN & (HAL_IO_RX_BUFFER_LEN - 1)) != 0
+#error "HAL_IO_RX_BUFFER_LEN must be a power of two"
+#endif
+
+/**
+ * Output cell, `seq` equals the position when free for producers
+ * and position + 1 when filled for the writer thread
+*/
+typedef struct io_tx_cell {
+    atomic_size_t seq;
+    uint8_t len;
+    uint8_t data[HAL_IO_TX_CELL_LEN];
+} io_tx_cell_t;
+
+/**
+ * Output queue
+ *
+ * Any thread can write, a message claims all of its cells with a single CAS so messages
+ * are never interleaved. Writer thread coalesces the cells into large `write` calls.
+*/
+static io_tx_cell_t io_tx_cells[HAL_IO_TX_CELLS];
+static atomic_size_t io_tx_enqueue_pos;
+static atomic_size_t io_tx_written_pos;
+static atomic_bool io_tx_sleeping;
+static pthread_mutex_t io_tx_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t io_tx_cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t io_tx_once = PTHREAD_ONCE_INIT;
+static atomic_bool io_tx_running;
+
+/**
+ * Input from stdin
+*/
+static uint8_t io_rx_buffer[HAL_IO_RX_BUFFER_LEN];
+static ring_t io_rx;
+static pthread_once_t io_rx_once = PTHREAD_ONCE_INIT;
+static atomic_bool io_rx_started;
+/* Set once stdin ended, all data read before is in the ring */
+static atomic_bool io_rx_eof;
+static atomic_uint_fast32_t io_rx_overruns;
+
+/**
+ * Callback for IO receive event
+ */
+static void (*_Atomic callback_assigned)(uint8_t*, uint16_t) = NULL;
+
+/**
+ * Write the whole buffer to stdout
+*/
+static void io_tx_write(const uint8_t* data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(STDOUT_FILENO, data, len);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            /* Output closed, data is discarded */
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+/**
+ * Drain the output queue, sleeping while it is empty
+*/
+static void* io_tx_thread(void* arg)
+{
+    static uint8_t buffer[HAL_IO_TX_WRITE_LEN];
+    size_t pos = 0;
+
+    UNUSED(arg);
+
+    for (;;) {
+        size_t len = 0;
+
+        /* Coalesce all filled cells which fit into the buffer */
+        while (len + HAL_IO_TX_CELL_LEN <= HAL_IO_TX_WRITE_LEN) {
+            io_tx_cell_t* cell = &io_tx_cells[pos & (HAL_IO_TX_CELLS - 1)];
+
+            if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1)
+                break;
+
+            memcpy(&buffer[len], cell->data, cell->len);
+            len += cell->len;
+            atomic_store_explicit(&cell->seq, pos + HAL_IO_TX_CELLS, memory_order_release);
+            pos++;
+        }
+
+        if (len != 0) {
+            io_tx_write(buffer, len);
+            atomic_store_explicit(&io_tx_written_pos, pos, memory_order_release);
+            continue;
+        }
+        atomic_store_explicit(&io_tx_written_pos, pos, memory_order_release);
+
+        /* Queue is empty, producers signal after pushing if the flag is set */
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += HAL_IO_TX_IDLE_NS;
+        if (ts.tv_nsec >= 1000000000l) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000l;
+        }
+
+        pthread_mutex_lock(&io_tx_mutex);
+        atomic_store(&io_tx_sleeping, 1);
+        io_tx_cell_t* cell = &io_tx_cells[pos & (HAL_IO_TX_CELLS - 1)];
+        if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1)
+            pthread_cond_timedwait(&io_tx_cond, &io_tx_mutex, &ts);
+        atomic_store(&io_tx_sleeping, 0);
+        pthread_mutex_unlock(&io_tx_mutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * Flush the queued output at exit
+*/
+static void io_tx_exit(void)
+{
+    io_flush();
+}
+
+/**
+ * Start the writer thread
+*/
+static void io_tx_init(void)
+{
+    pthread_t thread;
+
+    for (size_t i = 0; i < HAL_IO_TX_CELLS; i++)
+        atomic_init(&io_tx_cells[i].seq, i);
+
+    if (pthread_create(&thread, NULL, &io_tx_thread, NULL) != 0)
+        return;
+    pthread_detach(thread);
+    atomic_store(&io_tx_running, 1);
+    atexit(&io_tx_exit);
+}
+
+/**
+ * Claim `count` consecutive cells, waiting while the queue is full
+ *
+ * @return Position of the first cell
+*/
+static size_t io_tx_claim(size_t count)
+{
+    size_t pos = atomic_load_explicit(&io_tx_enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        /* Cells are freed in order, so if the last one is free all of them are */
+        size_t last = pos + count - 1;
+        io_tx_cell_t* cell = &io_tx_cells[last & (HAL_IO_TX_CELLS - 1)];
+        intptr_t diff = (intptr_t)atomic_load_explicit(&cell->seq, memory_order_acquire) - (intptr_t)last;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&io_tx_enqueue_pos, &pos, pos + count,
+                memory_order_relaxed, memory_order_relaxed))
+                return pos;
+        } else if (diff < 0) {
+            /* Queue is full, wait for the writer */
+            sched_yield();
+            pos = atomic_load_explicit(&io_tx_enqueue_pos, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&io_tx_enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * Wake the writer thread if it is waiting for data
+*/
+static void io_tx_notify(void)
+{
+    if (atomic_load(&io_tx_sleeping)) {
+        pthread_mutex_lock(&io_tx_mutex);
+        pthread_cond_signal(&io_tx_cond);
+        pthread_mutex_unlock(&io_tx_mutex);
+    }
+}
+
+/**
+ * Send `len` bytes of data starting from `buffer`
+ *
+ * @note Data is queued and written to stdout by the writer thread
+ * @note Blocks only while the output queue is full
+ * @retval `HAL_STATUS_OK` - message queued successfully
+ * @retval `HAL_STATUS_ERROR` - writer thread could not be started
+*/
+hal_status_t io_putdata(const uint8_t* buffer, uint16_t len)
+{
+    pthread_once(&io_tx_once, &io_tx_init);
+    if (!atomic_load(&io_tx_running))
+        return HAL_STATUS_ERROR;
+
+    while (len > 0) {
+        size_t count = (len + HAL_IO_TX_CELL_LEN - 1) / HAL_IO_TX_CELL_LEN;
+        if (count > HAL_IO_TX_CELLS)
+            count = HAL_IO_TX_CELLS;
+
+        size_t pos = io_tx_claim(count);
+        for (size_t i = 0; i < count; i++) {
+            io_tx_cell_t* cell = &io_tx_cells[(pos + i) & (HAL_IO_TX_CELLS - 1)];
+            uint8_t n = len < HAL_IO_TX_CELL_LEN ? (uint8_t)len : HAL_IO_TX_CELL_LEN;
+
+            memcpy(cell->data, buffer, n);
+            cell->len = n;
+            buffer += n;
+            len -= n;
+            atomic_store_explicit(&cell->seq, pos + i + 1, memory_order_release);
+        }
+        io_tx_notify();
+    }
+
+    return HAL_STATUS_OK;
+}
+
+/**
+ * Wait until all buffered data is sent
+*/
+hal_status_t io_flush(void)
+{
+    if (!atomic_load(&io_tx_running))
+        return HAL_STATUS_OK;
+
+    size_t pos = atomic_load(&io_tx_enqueue_pos);
+    while ((intptr_t)(atomic_load_explicit(&io_tx_written_pos, memory_order_acquire) - pos) < 0) {
+        io_tx_notify();
+        sched_yield();
+    }
+
+    return HAL_STATUS_OK;
+}
+
+/**
+ * Read stdin in chunks and pass them to the callback or the receive ring
+*/
+static void* io_rx_thread(void* arg)
+{
+    static uint8_t chunk[HAL_IO_RX_READ_LEN];
+
+    UNUSED(arg);
+
+    for (;;) {
+        ssize_t n = read(STDIN_FILENO, chunk, HAL_IO_RX_READ_LEN);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            atomic_store(&io_rx_eof, 1);
+            break;
+        }
+
+        void (*callback)(uint8_t*, uint16_t) = atomic_load(&callback_assigned);
+        if (callback != NULL) {
+            callback(chunk, (uint16_t)n);
+            continue;
+        }
+
+        size_t free = ring_free(&io_rx);
+        if ((size_t)n > free) {
+            atomic_fetch_add(&io_rx_overruns, (size_t)n - free);
+            n = (ssize_t)free;
+        }
+        ring_write(&io_rx, chunk, (size_t)n);
+    }
+
+    return NULL;
+}
+
+/**
+ * Start the input thread
+*/
+static void io_rx_init(void)
+{
+    pthread_t thread;
+
+    ring_init(&io_rx, io_rx_buffer, HAL_IO_RX_BUFFER_LEN);
+    if (pthread_create(&thread, NULL, &io_rx_thread, NULL) != 0)
+        return;
+    pthread_detach(thread);
+    atomic_store(&io_rx_started, 1);
+}
+
+/**
+ * Receive `len` bytes of data and store starting at `buffer`
+ *
+ * @note Blocking function
+ * @retval `HAL_STATUS_OK` - message received successfully
+ * @retval `HAL_STATUS_ERROR` - end of input, error during communication or the
+ * input is passed to a registered receive callback instead
+*/
+hal_status_t io_getdata(uint8_t* buffer, uint16_t len)
+{
+    if (atomic_load(&io_rx_started)) {
+        /* Receive callback consumes the input, it never collects in the ring */
+        if (atomic_load(&callback_assigned) != NULL)
+            return HAL_STATUS_ERROR;
+        /* Ring can not hold the whole request (only with a reduced `HAL_IO_RX_BUFFER_LEN`) */
+        if ((size_t)len > io_rx.mask + 1)
+            return HAL_STATUS_ERROR;
+
+        /* Input thread owns stdin, wait for the data in the ring */
+        while (ring_used(&io_rx) < len) {
+            /* Data read before the end is already in the ring, the rest never comes */
+            if (atomic_load(&io_rx_eof) && ring_used(&io_rx) < len)
+                return HAL_STATUS_ERROR;
+            sched_yield();
+        }
+        ring_read(&io_rx, buffer, len);
+        return HAL_STATUS_OK;
+    }
+
+    while (len > 0) {
+        ssize_t n = read(STDIN_FILENO, buffer, len);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return HAL_STATUS_ERROR;
+        buffer += n;
+        len -= (uint16_t)n;
+    }
+
+    return HAL_STATUS_OK;
+}
 
 /**
  * Replacement for stdio printf
 */
 hal_status_t io_printf(const char* format, ...)
 {
+    char buffer[HAL_IO_PRINTF_BUFFER_LEN];
+
     va_list args;
     va_start(args, format);
-    vprintf(format, args);
+    int len = vsnprintf(buffer, HAL_IO_PRINTF_BUFFER_LEN, format, args);
     va_end(args);
-    return HAL_STATUS_OK;
+
+    if (len < 0) {
+        return HAL_STATUS_ERROR;
+    }
+    if (len >= HAL_IO_PRINTF_BUFFER_LEN) {
+        len = HAL_IO_PRINTF_BUFFER_LEN - 1;
+    }
+    return io_putdata((const uint8_t*)buffer, (uint16_t)len);
 }
 
 /**
@@ -31,8 +405,7 @@ hal_status_t io_scanf(const char* format, ...)
 */
 hal_status_t io_putchar(const char c)
 {
-    putchar(c);
-    return HAL_STATUS_OK;
+    return io_putdata((const uint8_t*)&c, 1);
 }
 
 /**
@@ -40,6 +413,40 @@ hal_status_t io_putchar(const char c)
 */
 hal_status_t io_getchar(char* c)
 {
-    *c = getchar();
-    return HAL_STATUS_OK;
-}
\ No newline at end of file
+    return io_getdata((uint8_t*)c, 1);
+}
+
+/**
+ * Start continuous receiving into the IO receive ring
+*/
+hal_status_t io_rx_start(void)
+{
+    pthread_once(&io_rx_once, &io_rx_init);
+    return atomic_load(&io_rx_started) ? HAL_STATUS_OK : HAL_STATUS_ERROR;
+}
+
+/**
+ * Get the IO receive ring
+*/
+ring_t* io_rx_ring(void)
+{
+    return &io_rx;
+}
+
+/**
+ * Number of received bytes lost because the receive ring was full
+*/
+uint32_t io_rx_get_overruns(void)
+{
+    return (uint32_t)atomic_load(&io_rx_overruns);
+}
+
+/**
+ * Register a callback for when data is received over IO port
+ * @note Callback function is called from the input thread with chunks of up to 4096 bytes
+ */
+hal_status_t io_register_receive_callback(void (*callback)(uint8_t* data, uint16_t len))
+{
+    atomic_store(&callback_assigned, callback);
+    return io_rx_start();
+}
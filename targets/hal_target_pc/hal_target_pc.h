@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+/* For `callback_t`, this header is included first by the target sources */
+#include "hal_core.h"
 
 #define SOCKET_PORT     8080
 
@@ -22,6 +24,10 @@ typedef struct {
     uint16_t dir; /* not used currently since hal doesn't have options to set pin dir */
     uint16_t intr; /* used to check which pin triggers an interrupt */
     uint16_t intr_edge; /* which edge for each pin triggers an interrupt (0 - falling, 1 - rising) */
+#ifdef HAL_GPIO_USE_REGISTER_CALLBACKS
+    /* Registered callback of each pin */
+    callback_t callbacks[16];
+#endif
 } hal_target_pc_gpio_t;
 
 #define HAL_GPIO_PORT_TYPEDEF   hal_target_pc_gpio_t*
@@ -50,7 +56,10 @@ typedef struct {
     uint8_t wait_ack;
     /* Should ISR be called on complete or if error */
     uint8_t int_mode;
-    /** @todo Add registrable callbacks here */
+#ifdef HAL_I2C_USE_REGISTER_CALLBACKS
+    /* Registered callback of each master `i2c_callback_src_t`, slave mode is not simulated */
+    callback_t callbacks[I2C_CB_SRC_MASTER_RECV_ERROR + 1];
+#endif
 } hal_target_pc_i2c_t;
 /** @todo Could use one buffer pointer for both tx and rx */
 
@@ -76,14 +85,51 @@ typedef struct {
     uint8_t* rx_buf;
     /* Number of bytes left to be received */
     uint16_t rx_count;
+    /* Number of bytes of the ongoing receive */
+    uint16_t rx_size;
     /* Should ISR be called on complete or if error */
     uint8_t int_mode;
-    /** @todo Add registrable callbacks here*/
+#ifdef HAL_UART_USE_REGISTER_CALLBACKS
+    /* Registered callback of each `uart_callback_src_t` */
+    callback_t callbacks[UART_CB_SRC_RECV_ERROR + 1];
+#endif
 } hal_target_pc_uart_t;
 /** @note Currently implemented only 8-bit message */
 
 #define HAL_UART_TYPEDEF    hal_target_pc_uart_t*
 
+/**
+ * Timer simulated from the host monotonic clock
+ * 
+ * Count is computed from the elapsed host time, period ISR is called from a clock thread.
+ * Like a hardware counter, a new period counts from the last expiry.
+*/
+typedef struct {
+    periph_id_t id;
+    /* Counting frequency in Hz, set by the user before starting the timer */
+    uint32_t frequency;
+    /* Counts per period, 0 means full 32-bit range */
+    volatile uint32_t period;
+    /* Host time (ns) at which the count was 0 while running, the last expiry */
+    volatile uint64_t base_ns;
+    /* Count at the moment the timer was stopped */
+    volatile uint32_t stopped_count;
+    volatile uint8_t running;
+    /* Changed with the period, count or state, an expiry planned before the change is not signalled */
+    uint32_t generation;
+    /* Clock thread calling `timer_period_isr` is started on first `timer_start` */
+    uint8_t thread_started;
+#ifdef HAL_TIMER_USE_REGISTER_CALLBACKS
+    /* Registered callback of each `timer_callback_src_t` */
+    callback_t callbacks[TIMER_CB_SRC_PERIOD + 1];
+#endif
+} hal_target_pc_timer_t;
+
+#define HAL_TIMER_TYPEDEF   hal_target_pc_timer_t*
+/* POSIX headers define `timer_t`, the HAL timer type is only available as `hal_timer_t` */
+#define HAL_TIMER_NO_TIMER_T
+#define HAL_TIMER_32BIT
+
 // /**
 //  * Wait for `size` bytes to be received from the peripheral
 //  * @note Blocking
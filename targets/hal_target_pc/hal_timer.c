@@ -0,0 +1,255 @@
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include "hal_target_pc.h"
+#include "hal_timer.h"
+
+#define NS_PER_SEC                  (1000000000ull)
+#define TIMER_DEFAULT_FREQUENCY     (1000000ul)
+
+/* Protects the timer state shared with the clock threads, `timer_changed` wakes them on a change */
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_changed;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Current host monotonic time in nanoseconds
+*/
+static uint64_t timer_host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t timer_frequency(hal_timer_t timer)
+{
+    return timer->frequency != 0 ? timer->frequency : TIMER_DEFAULT_FREQUENCY;
+}
+
+static uint64_t timer_period_counts(hal_timer_t timer)
+{
+    return timer->period != 0 ? timer->period : (1ull << 32);
+}
+
+/**
+ * Convert host nanoseconds to timer counts (split to avoid overflow)
+*/
+static uint64_t timer_ns_to_counts(hal_timer_t timer, uint64_t ns)
+{
+    uint64_t freq = timer_frequency(timer);
+    return (ns / NS_PER_SEC) * freq + (ns % NS_PER_SEC) * freq / NS_PER_SEC;
+}
+
+/**
+ * Convert timer counts to host nanoseconds (split to avoid overflow)
+*/
+static uint64_t timer_counts_to_ns(hal_timer_t timer, uint64_t counts)
+{
+    uint64_t freq = timer_frequency(timer);
+    return (counts / freq) * NS_PER_SEC + (counts % freq) * NS_PER_SEC / freq;
+}
+
+/**
+ * Condition variable waits use the same clock as the timers
+*/
+static void timer_init_once(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer_changed, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * Lock the timer state, the condition variable is created on first use
+*/
+static void timer_lock_state(void)
+{
+    pthread_once(&timer_once, timer_init_once);
+    pthread_mutex_lock(&timer_lock);
+}
+
+/**
+ * Mark a change of the timer state and wake its clock thread to plan the next expiry again
+ * @note Called with `timer_lock` held
+*/
+static void timer_changed_locked(hal_timer_t timer)
+{
+    timer->generation++;
+    pthread_cond_broadcast(&timer_changed);
+}
+
+/**
+ * Calls the period ISR every time the count reaches the period
+*/
+static void* timer_clock_thread(void* arg)
+{
+    hal_timer_t timer = (hal_timer_t)arg;
+
+    pthread_mutex_lock(&timer_lock);
+    for (;;) {
+        if (!timer->running) {
+            pthread_cond_wait(&timer_changed, &timer_lock);
+            continue;
+        }
+
+        /* Period counts from the last expiry, a changed period restarts from it too */
+        uint32_t generation = timer->generation;
+        uint64_t next = timer->base_ns + timer_counts_to_ns(timer, timer_period_counts(timer));
+        struct timespec ts = { .tv_sec = (time_t)(next / NS_PER_SEC), .tv_nsec = (long)(next % NS_PER_SEC) };
+
+        /* Woken by a change (or spuriously), plan again */
+        if (pthread_cond_timedwait(&timer_changed, &timer_lock, &ts) != ETIMEDOUT
+            || timer->generation != generation || !timer->running)
+            continue;
+
+        timer->base_ns = next;
+        pthread_mutex_unlock(&timer_lock);
+
+#ifdef HAL_TIMER_USE_REGISTER_CALLBACKS
+        if (timer->callbacks[TIMER_CB_SRC_PERIOD] != NULL) {
+            timer->callbacks[TIMER_CB_SRC_PERIOD](HAL_STATUS_OK);
+        }
+#else
+        timer_period_isr(timer);
+#endif
+
+        pthread_mutex_lock(&timer_lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Set timer counting mode
+ * @note Can be used to stop the timer using `TIMER_COUNT_MODE_STOP`
+ * @note Up to implementation if can be called during timer running
+*/
+inline hal_status_t timer_set_mode(hal_timer_t timer, timer_count_mode_t timer_mode)
+{
+    if (timer_mode == TIMER_COUNT_MODE_STOP) {
+        return timer_stop(timer);
+    }
+
+    return timer_start(timer);
+}
+
+/**
+ * Set timer period
+ * @note By default should be max value (for 16-bit 0xffff)
+ * @note If enabled, triggers `timer_period_isr` when timer count hits `period`
+ * @note If set to value less than current count while timer is running, timer should trigger isr and reset to 0
+*/
+inline hal_status_t timer_set_period(hal_timer_t timer, timer_count_t period)
+{
+    timer_lock_state();
+    timer->period = period;
+    timer_changed_locked(timer);
+    pthread_mutex_unlock(&timer_lock);
+
+    return HAL_STATUS_OK;
+}
+
+/**
+ * Start the timer (enable counting)
+ * @retval `HAL_STATUS_OK` if timer started successfully
+ * @retval `HAL_STATUS_ERROR` if timer starting failed
+ * @note This should not reset the current value of the counter
+*/
+inline hal_status_t timer_start(hal_timer_t timer)
+{
+    hal_status_t status = HAL_STATUS_OK;
+
+    timer_lock_state();
+    if (!timer->running) {
+        timer->base_ns = timer_host_ns() - timer_counts_to_ns(timer, timer->stopped_count);
+        timer->running = 1;
+        timer_changed_locked(timer);
+    }
+
+    if (!timer->thread_started) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, &timer_clock_thread, timer) == 0) {
+            pthread_detach(thread);
+            timer->thread_started = 1;
+        } else {
+            status = HAL_STATUS_ERROR;
+        }
+    }
+    pthread_mutex_unlock(&timer_lock);
+
+    return status;
+}
+
+/**
+ * Stop the timer (disable counting)
+ * @retval `HAL_STATUS_OK` if timer stopped successfully
+ * @retval `HAL_STATUS_ERROR` if timer stopping failed
+ * @note This should not reset the current value of the counter
+*/
+inline hal_status_t timer_stop(hal_timer_t timer)
+{
+    timer_lock_state();
+    if (timer->running) {
+        timer->stopped_count = timer_get_count(timer);
+        timer->running = 0;
+        timer_changed_locked(timer);
+    }
+    pthread_mutex_unlock(&timer_lock);
+
+    return HAL_STATUS_OK;
+}
+
+/**
+ * Clear the timer count value (set to 0)
+ * @retval `HAL_STATUS_OK` if timer cleared successfully
+ * @retval `HAL_STATUS_ERROR` if timer clearing failed
+ * @note Should work and should not change if the timer is enabled or disabled
+*/
+inline hal_status_t timer_clear(hal_timer_t timer)
+{
+    timer_lock_state();
+    timer->base_ns = timer_host_ns();
+    timer->stopped_count = 0;
+    timer_changed_locked(timer);
+    pthread_mutex_unlock(&timer_lock);
+
+    return HAL_STATUS_OK;
+}
+
+/**
+ * Get current count of the timer
+ * @note This should just act as a macro for reading timer counter register
+*/
+inline timer_count_t timer_get_count(hal_timer_t timer)
+{
+    if (!timer->running) {
+        return timer->stopped_count;
+    }
+
+    uint64_t elapsed = timer_ns_to_counts(timer, timer_host_ns() - timer->base_ns);
+    return (timer_count_t)(elapsed % timer_period_counts(timer));
+}
+
+#ifdef HAL_TIMER_USE_REGISTER_CALLBACKS
+/**
+ * Register a callback for timer event
+ * @retval `HAL_STATUS_OK` callback registered successfully
+ * @retval `HAL_STATUS_ERROR` callback registration failed
+ * @note Implement in hal_timer.c
+ * @note Multiple registrations should override the last one
+*/
+inline hal_status_t timer_register_callback(hal_timer_t timer, callback_t callback, timer_callback_src_t src)
+{
+    if (src > TIMER_CB_SRC_PERIOD) {
+        return HAL_STATUS_ERROR;
+    }
+
+    timer->callbacks[src] = callback;
+    return HAL_STATUS_OK;
+}
+#endif
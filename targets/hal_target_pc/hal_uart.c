@@ -15,6 +15,24 @@
 
 #define MIN(a, b) ((a) <= (b) ? (a) : (b))
 
+/**
+ * Route the end of an interrupt mode operation to the registered callback or the ISR
+*/
+static void uart_dispatch(uart_t uart, uart_callback_src_t src, hal_status_t status)
+{
+#ifdef HAL_UART_USE_REGISTER_CALLBACKS
+    if (uart->callbacks[src] != NULL) {
+        uart->callbacks[src](status);
+    }
+#else
+    if (src == UART_CB_SRC_SEND_COMPLETE || src == UART_CB_SRC_SEND_ERROR) {
+        uart_send_isr(uart, status);
+    } else {
+        uart_recv_isr(uart, status);
+    }
+#endif
+}
+
 /**
  * Called on receive `SOCKET_UART_ID` from the socket stream
  * 
@@ -71,7 +89,7 @@ void peripheral_socket_handle_uart(hal_target_pc_uart_t* uart, uint8_t* msg, uin
         /* be busy when starting next receive from isr */
         if (uart->int_mode == 1) {
             uart->status = SP_READY;
-            uart_recv_isr(uart, HAL_STATUS_OK);
+            uart_dispatch(uart, UART_CB_SRC_RECV_COMPLETE, HAL_STATUS_OK);
         }
     }
     
@@ -135,6 +153,7 @@ inline hal_status_t uart_recv(uart_t uart, uint8_t* buff, uint16_t size, uint16_
     uart->status = SP_RECEIVING;
     uart->rx_buf = buff;
     uart->rx_count = size;
+    uart->rx_size = size;
     uart->int_mode = 0;
 
     /* Wait until received specified number of bytes which happens in another async thread */
@@ -191,7 +210,7 @@ inline hal_status_t uart_send_it(uart_t uart, uint8_t* data, uint16_t size, uint
     }
 
     /* Call interrupt when sending complete */
-    uart_send_isr(uart, HAL_STATUS_OK);
+    uart_dispatch(uart, UART_CB_SRC_SEND_COMPLETE, HAL_STATUS_OK);
     return HAL_STATUS_OK;
 }
 
@@ -214,6 +233,7 @@ inline hal_status_t uart_recv_it(uart_t uart, uint8_t* buff, uint16_t size, uint
     uart->status = SP_RECEIVING;
     uart->rx_buf = buff;
     uart->rx_count = size;
+    uart->rx_size = size;
     uart->int_mode = 1;
 
     /* Reset UART for next receive process */
@@ -221,6 +241,16 @@ inline hal_status_t uart_recv_it(uart_t uart, uint8_t* buff, uint16_t size, uint
     return HAL_STATUS_OK;
 }
 
+/**
+ * Returns number of bytes received so far by the last `uart_recv_it`
+ * @note Once the operation completes it stays <size> until the next start
+ * @note Implement in hal_uart.c
+ */
+inline uint16_t uart_recv_it_count(uart_t uart)
+{
+    return uart->rx_size - uart->rx_count;
+}
+
 #ifdef HAL_UART_USE_REGISTER_CALLBACKS
 /**
  * Register a callback for UART event
@@ -231,7 +261,11 @@ inline hal_status_t uart_recv_it(uart_t uart, uint8_t* buff, uint16_t size, uint
 */
 inline hal_status_t uart_register_callback(uart_t uart, callback_t callback, uart_callback_src_t src)
 {
-    #error "UART register callbacks not implemented"
+    if (src > UART_CB_SRC_RECV_ERROR) {
+        return HAL_STATUS_ERROR;
+    }
+
+    uart->callbacks[src] = callback;
+    return HAL_STATUS_OK;
 }
-#else
-#endif
\ No newline at end of file
+#endif
@@ -1,12 +1,57 @@
 #include "hal_target_stm32l4.h"
 #include "hal_adc.h"
 
+/* ADC1, ADC2 and ADC3 */
+#define ADC_MAX_INSTANCES   (3)
+#define ADC_CB_SRC_COUNT    (ADC_CB_SRC_ERROR + 1)
+
+/**
+ * State of one ADC instance
+*/
+typedef struct {
+    /* DMA buffer length, the DMA counter only holds the remaining count */
+    uint32_t dma_length;
+#ifdef HAL_ADC_USE_REGISTER_CALLBACKS
+    callback_t callbacks[ADC_CB_SRC_COUNT];
+#endif
+} adc_instance_t;
+
+static adc_instance_t adc_instances[ADC_MAX_INSTANCES];
+
+/**
+ * State of the instance of the handle
+ * @return NULL if the instance is not known
+*/
+static adc_instance_t* adc_get_instance(adc_t adc)
+{
+    switch ((uintptr_t)adc->Instance) {
+    case ADC1_BASE:
+        return &adc_instances[0];
+#ifdef ADC2
+    case ADC2_BASE:
+        return &adc_instances[1];
+#endif
+#ifdef ADC3
+    case ADC3_BASE:
+        return &adc_instances[2];
+#endif
+    default:
+        return NULL;
+    }
+}
+
 /**
  * Start the ADC in DMA mode
 */
 inline hal_status_t adc_start_dma(adc_t adc, uint8_t* buffer, uint32_t length)
 {
     hal_status_t ret_status = HAL_STATUS_OK;
+    adc_instance_t* instance = adc_get_instance(adc);
+
+    if (instance == NULL) {
+        return HAL_STATUS_ERROR;
+    }
+    instance->dma_length = length;
 
     if (HAL_ADC_Start_DMA(adc, (uint32_t*)buffer, length) != HAL_OK) {
         ret_status = HAL_STATUS_ERROR;
@@ -78,13 +123,18 @@ inline void adc_clear_eos_flag(adc_t adc)
 
 /**
  * Read the position of dma write pointer relative to start of the buffer
- * @note Currently returns number of samples until the end of the buffer
+ * @note Position is in samples, in range [0, length)
  */
 inline uint32_t adc_dma_get_counter(adc_t adc)
 {
     uint32_t rel_to_end = __HAL_DMA_GET_COUNTER(adc->DMA_Handle);
-    // uint32_t buffer_len = adc->DMA_Handle->Instance->
-    return rel_to_end;
+    adc_instance_t* instance = adc_get_instance(adc);
+
+    if (instance == NULL || rel_to_end == 0 || rel_to_end > instance->dma_length) {
+        return 0;
+    }
+    /* Counter is reloaded to length on wrap, so it is never 0 in circular mode */
+    return instance->dma_length - rel_to_end;
 }
 
 #ifdef HAL_ADC_USE_REGISTER_CALLBACKS
@@ -94,8 +144,43 @@ inline uint32_t adc_dma_get_counter(adc_t adc)
  * @retval `HAL_STATUS_ERROR` callback registration failed
  * @note Implement in hal_adc.c
  * @note Multiple registrations should override the last one
+ * @note `ADC_CB_SRC_EOS` is rejected, in DMA mode the HAL reports only the DMA transfer events
 */
-inline hal_status_t adc_register_callback(adc_t adc, callback_t callback);
+inline hal_status_t adc_register_callback(adc_t adc, callback_t callback, adc_callback_src_t src)
+{
+    adc_instance_t* instance = adc_get_instance(adc);
+
+    if (instance == NULL || src == ADC_CB_SRC_EOS || src >= ADC_CB_SRC_COUNT) {
+        return HAL_STATUS_ERROR;
+    }
+
+    instance->callbacks[src] = callback;
+    return HAL_STATUS_OK;
+}
+
+static void adc_dispatch(adc_t adc, adc_callback_src_t src, hal_status_t status)
+{
+    adc_instance_t* instance = adc_get_instance(adc);
+
+    if (instance != NULL && instance->callbacks[src] != NULL) {
+        instance->callbacks[src](status);
+    }
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    adc_dispatch(hadc, ADC_CB_SRC_DMA_BUFFER_FILLED, HAL_STATUS_OK);
+}
+
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    adc_dispatch(hadc, ADC_CB_SRC_DMA_BUFFER_HALF, HAL_STATUS_OK);
+}
+
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef* hadc)
+{
+    adc_dispatch(hadc, ADC_CB_SRC_ERROR, HAL_STATUS_ERROR);
+}
 #else
 /**
  * ADC end of sequence ISR
@@ -117,8 +202,36 @@ __weak void adc_dma_buffer_filled_isr(adc_t adc)
     UNUSED(adc);
 }
 
+/**
+ * ADC first half of the buffer filled by DMA ISR
+ * @note This function should be called from lower level (driver's) ISR in the hal_adc.c
+*/
+__weak void adc_dma_buffer_half_isr(adc_t adc)
+{
+    UNUSED(adc);
+}
+
+/**
+ * ADC overrun or DMA error ISR
+ * @note This function should be called from lower level (driver's) ISR in the hal_adc.c
+*/
+__weak void adc_error_isr(adc_t adc)
+{
+    UNUSED(adc);
+}
+
 inline void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
 {
     adc_dma_buffer_filled_isr(hadc);
 }
+
+inline void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    adc_dma_buffer_half_isr(hadc);
+}
+
+inline void HAL_ADC_ErrorCallback(ADC_HandleTypeDef* hadc)
+{
+    adc_error_isr(hadc);
+}
 #endif
\ No newline at end of file
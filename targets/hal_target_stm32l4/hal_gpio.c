@@ -38,6 +38,11 @@ inline void gpio_port_toggle(gpio_port_t port, gpio_pin_t pins)
 }
 
 #ifdef HAL_GPIO_USE_REGISTER_CALLBACKS
+/* EXTI line of each pin number, a line is connected to one port at a time */
+#define GPIO_EXTI_LINES     (16)
+
+static callback_t gpio_exti_callbacks[GPIO_EXTI_LINES];
+
 /**
  * Register a callback for GPIO external interrupt
  * @retval `HAL_STATUS_OK` callback registered successfully
@@ -45,9 +50,31 @@ inline void gpio_port_toggle(gpio_port_t port, gpio_pin_t pins)
  * @note Implement in hal_gpio.c
  * @note Multiple registrations should override the last one
 */
-inline hal_status_t gpio_register_callback(gpio_t gpio, gpio_pin_t pin, callback_t callback)
+inline hal_status_t gpio_register_callback(gpio_port_t port, gpio_pin_t pin, callback_t callback)
+{
+    UNUSED(port);
+
+    if (pin == 0) {
+        return HAL_STATUS_ERROR;
+    }
+
+    for (uint8_t line = 0; line < GPIO_EXTI_LINES; line++) {
+        if (pin & (1 << line)) {
+            gpio_exti_callbacks[line] = callback;
+        }
+    }
+
+    return HAL_STATUS_OK;
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
-    #error "GPIO register callback not implemented"
+    /* Called once per pending line */
+    callback_t callback = gpio_exti_callbacks[__builtin_ctz(GPIO_Pin)];
+
+    if (callback != NULL) {
+        callback(HAL_STATUS_OK);
+    }
 }
 #else
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
@@ -55,4 +82,4 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
     /** @todo Implement checking for which port EXTI is setup and passing it */
     gpio_exti_isr((gpio_port_t)0, (gpio_pin_t)GPIO_Pin);
 }
-#endif
\ No newline at end of file
+#endif
@@ -6,7 +6,72 @@ typedef enum {
     I2C_RECV
 } i2c_op_t;
 
-static i2c_op_t i2c_it_started_op;
+/* I2C1, I2C2 and I2C3 */
+#define I2C_MAX_INSTANCES   (3)
+/* Slave mode is not implemented, only the master sources can be registered */
+#define I2C_CB_SRC_COUNT    (I2C_CB_SRC_MASTER_RECV_ERROR + 1)
+
+/**
+ * Interrupt mode state of one I2C instance
+*/
+typedef struct {
+    /* Last started operation, errors are routed to it */
+    i2c_op_t started_op;
+#ifdef HAL_I2C_USE_REGISTER_CALLBACKS
+    callback_t callbacks[I2C_CB_SRC_COUNT];
+#endif
+} i2c_instance_t;
+
+static i2c_instance_t i2c_instances[I2C_MAX_INSTANCES];
+
+/**
+ * State of the instance of the handle
+ * @return NULL if the instance is not known
+*/
+static i2c_instance_t* i2c_get_instance(i2c_t i2c)
+{
+    switch ((uintptr_t)i2c->Instance) {
+    case I2C1_BASE:
+        return &i2c_instances[0];
+#ifdef I2C2
+    case I2C2_BASE:
+        return &i2c_instances[1];
+#endif
+#ifdef I2C3
+    case I2C3_BASE:
+        return &i2c_instances[2];
+#endif
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * Route the end of an interrupt mode operation to the registered callback or the ISR
+*/
+static void i2c_dispatch(i2c_t i2c, i2c_op_t op, hal_status_t status)
+{
+#ifdef HAL_I2C_USE_REGISTER_CALLBACKS
+    i2c_instance_t* instance = i2c_get_instance(i2c);
+    i2c_callback_src_t src;
+
+    if (op == I2C_SEND) {
+        src = status == HAL_STATUS_OK ? I2C_CB_SRC_MASTER_SEND_COMPLETE : I2C_CB_SRC_MASTER_SEND_ERROR;
+    } else {
+        src = status == HAL_STATUS_OK ? I2C_CB_SRC_MASTER_RECV_COMPLETE : I2C_CB_SRC_MASTER_RECV_ERROR;
+    }
+
+    if (instance != NULL && instance->callbacks[src] != NULL) {
+        instance->callbacks[src](status);
+    }
+#else
+    if (op == I2C_SEND) {
+        i2c_master_send_isr(i2c, status);
+    } else {
+        i2c_master_recv_isr(i2c, status);
+    }
+#endif
+}
 
 /**
  * Send <size> bytes via I2C to slave at address <addr>
@@ -65,14 +130,17 @@ inline hal_status_t i2c_master_send_it(i2c_t i2c, uint16_t addr, uint8_t* data,
     
     hal_status_t ret_status = HAL_STATUS_OK;
 
+    i2c_instance_t* instance = i2c_get_instance(i2c);
+
     /** @todo Check if i2c is busy and return HAL_STATUS_BUSY if true */
 
-    if (HAL_I2C_Master_Transmit_IT(i2c, addr << 1, data, size) != HAL_OK) {
-        ret_status = HAL_STATUS_ERROR;
+    /* Set before starting, the error interrupt can come before the start returns */
+    if (instance != NULL) {
+        instance->started_op = I2C_SEND;
     }
 
-    if (ret_status == HAL_STATUS_OK) {
-        i2c_it_started_op = I2C_SEND;
+    if (HAL_I2C_Master_Transmit_IT(i2c, addr << 1, data, size) != HAL_OK) {
+        ret_status = HAL_STATUS_ERROR;
     }
 
     return ret_status;
@@ -92,14 +160,17 @@ inline hal_status_t i2c_master_recv_it(i2c_t i2c, uint16_t addr, uint8_t* buff,
     
     hal_status_t ret_status = HAL_STATUS_OK;
 
+    i2c_instance_t* instance = i2c_get_instance(i2c);
+
     /** @todo Check if i2c is busy and return HAL_STATUS_BUSY if true */
 
-    if (HAL_I2C_Master_Receive_IT(i2c, addr << 1, buff, size) != HAL_OK) {
-        ret_status = HAL_STATUS_ERROR;
+    /* Set before starting, the error interrupt can come before the start returns */
+    if (instance != NULL) {
+        instance->started_op = I2C_RECV;
     }
 
-    if (ret_status == HAL_STATUS_OK) {
-        i2c_it_started_op = I2C_RECV;
+    if (HAL_I2C_Master_Receive_IT(i2c, addr << 1, buff, size) != HAL_OK) {
+        ret_status = HAL_STATUS_ERROR;
     }
 
     return ret_status;
@@ -112,30 +183,36 @@ inline hal_status_t i2c_master_recv_it(i2c_t i2c, uint16_t addr, uint8_t* buff,
  * @retval `HAL_STATUS_ERROR` callback registration failed
  * @note Implement in hal_i2c.c
  * @note Multiple registrations should override the last one
+ * @note Slave sources are rejected while slave mode is not implemented
 */
 inline hal_status_t i2c_register_callback(i2c_t i2c, callback_t callback, i2c_callback_src_t src)
 {
-    #error "I2C register callbacks not implemented"
+    i2c_instance_t* instance = i2c_get_instance(i2c);
+
+    if (instance == NULL || src >= I2C_CB_SRC_COUNT) {
+        return HAL_STATUS_ERROR;
+    }
+
+    instance->callbacks[src] = callback;
+    return HAL_STATUS_OK;
 }
-#else
+#endif
 
 void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c)
 {
-    i2c_master_send_isr(hi2c, HAL_STATUS_OK);
+    i2c_dispatch(hi2c, I2C_SEND, HAL_STATUS_OK);
 }
 
 void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c)
 {
-    i2c_master_recv_isr(hi2c, HAL_STATUS_OK);
+    i2c_dispatch(hi2c, I2C_RECV, HAL_STATUS_OK);
 }
 
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
 {
-    if (i2c_it_started_op == I2C_SEND) {
-        i2c_master_send_isr(hi2c, HAL_STATUS_ERROR);
-    } else {
-        i2c_master_recv_isr(hi2c, HAL_STATUS_ERROR);
+    i2c_instance_t* instance = i2c_get_instance(hi2c);
+
+    if (instance != NULL) {
+        i2c_dispatch(hi2c, instance->started_op, HAL_STATUS_ERROR);
     }
 }
-
-#endif
\ No newline at end of file
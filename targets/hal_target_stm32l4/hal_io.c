@@ -1,10 +1,36 @@
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include "hal_target_stm32l4.h"
 #include "hal_io.h"
 
 #define HAL_IO_PRINTF_BUFFER_LEN    (512)
-#define UART_RECV_BUFF_LEN          (512)
+
+/* Size of the receive ring, must be a power of two */
+#ifndef HAL_IO_RX_BUFFER_LEN
+#define HAL_IO_RX_BUFFER_LEN        (512)
+#endif
+
+#if (HAL_IO_RX_BUFFER_LEN & (HAL_IO_RX_BUFFER_LEN - 1)) != 0
+#error "HAL_IO_RX_BUFFER_LEN must be a power of two"
+#endif
+
+/* Longest wait of `io_getdata` for the data */
+#ifndef HAL_IO_RX_TIMEOUT_MS
+#define HAL_IO_RX_TIMEOUT_MS        (1000)
+#endif
+
+/* Size of each of the two transmit buffers */
+#ifndef HAL_IO_TX_BUFFER_LEN
+#define HAL_IO_TX_BUFFER_LEN        (256)
+#endif
+
+/* Transmit buffer is sent using DMA if defined, otherwise using interrupts */
+#ifdef HAL_IO_USE_DMA
+#define IO_UART_TRANSMIT(uart, data, len)   HAL_UART_Transmit_DMA(uart, data, len)
+#else
+#define IO_UART_TRANSMIT(uart, data, len)   HAL_UART_Transmit_IT(uart, data, len)
+#endif
 
 #if defined(HAL_IO_USE_USB)
     #include "usbd_cdc_if.h"
@@ -16,12 +42,118 @@
     #warning "Please set HAL_IO_USE_USB or HAL_IO_USE_UART to use IO"
 #endif
 
+/**
+ * Callback for IO receive event
+ */
+static void (*callback_assigned)(uint8_t*, uint16_t) = NULL;
+
+#if defined(HAL_IO_USE_UART)
+/**
+ * Double buffered transmit
+ *
+ * Writes are appended to the fill buffer while the other one is being sent,
+ * transmit complete interrupt swaps the buffers and starts sending the filled one.
+ * When the fill buffer is full the writer waits for the swap, or if `HAL_IO_TX_DROP`
+ * is defined (and always in ISR context) the rest of the data is dropped.
+*/
+static uint8_t io_tx_buffer[2][HAL_IO_TX_BUFFER_LEN];
+static volatile uint16_t io_tx_len[2];
+static volatile uint8_t io_tx_fill;
+static volatile uint8_t io_tx_busy;
+static volatile uint32_t io_tx_dropped;
+
+/**
+ * Continuous receive
+ *
+ * UART receives into the ring buffer in circular DMA mode (or re-armed interrupt mode),
+ * idle line, half and full transfer events publish the received data to the ring.
+ * Reception does not stop when the ring is full, the ISR keeps committing and only the
+ * consumer moves the tail: it skips the overwritten data in `io_rx_sync`.
+*/
+static uint8_t io_rx_buffer[HAL_IO_RX_BUFFER_LEN];
+static ring_t io_rx;
+static uint16_t io_rx_pos;
+static volatile uint8_t io_rx_started;
+static volatile uint32_t io_rx_overruns;
+/* Ring position the reception restarted at, data before it is skipped by the consumer */
+static volatile size_t io_rx_skip;
+
+/**
+ * Skip the data overwritten by the reception, consumer side
+ *
+ * The ring laps when the consumer falls behind (`head - tail` larger than the ring),
+ * only the newest `HAL_IO_RX_BUFFER_LEN` bytes are still in the buffer.
+*/
+static void io_rx_sync(void)
+{
+    size_t tail = atomic_load_explicit(&io_rx.tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&io_rx.head, memory_order_acquire);
+    size_t skip = io_rx_skip;
+    size_t next = tail;
+
+    /* Restart is visible only once its padding is committed */
+    if ((ptrdiff_t)(skip - next) > 0 && (ptrdiff_t)(head - skip) >= 0)
+        next = skip;
+    if (head - next > HAL_IO_RX_BUFFER_LEN)
+        next = head - HAL_IO_RX_BUFFER_LEN;
+    if (next != tail)
+        ring_consume(&io_rx, next - tail);
+}
+
+/**
+ * Swap the buffers and start sending the fill buffer if the port is idle
+ * @note Must be called with interrupts disabled
+*/
+static hal_status_t io_tx_start(void)
+{
+    uint8_t send = io_tx_fill;
+
+    if (io_tx_busy || io_tx_len[send] == 0)
+        return HAL_STATUS_OK;
+
+    io_tx_fill = send ^ 1;
+    io_tx_len[io_tx_fill] = 0;
+    io_tx_busy = 1;
+
+    if (IO_UART_TRANSMIT(IO_UART, io_tx_buffer[send], io_tx_len[send]) != HAL_OK) {
+        /* Buffers are already swapped, the data which was not sent is lost like after a failed transfer */
+        io_tx_dropped += io_tx_len[send];
+        io_tx_busy = 0;
+        return HAL_STATUS_ERROR;
+    }
+
+    return HAL_STATUS_OK;
+}
+
+/**
+ * Transmit complete or error of the IO UART, called from hal_uart.c
+ * @return 1 if `uart` is the IO port
+*/
+uint8_t io_uart_send_isr(uart_t uart, hal_status_t status)
+{
+    if (uart != IO_UART)
+        return 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    /* Data of the failed transfer is lost, counted as dropped */
+    if (status != HAL_STATUS_OK)
+        io_tx_dropped += io_tx_len[io_tx_fill ^ 1];
+    io_tx_busy = 0;
+    io_tx_start();
+    __set_PRIMASK(primask);
+
+    return 1;
+}
+#endif
+
 /**
  * Send `len` bytes of data starting from `buffer`
  * 
- * @note Blocking function
- * @note Never returns busy since all IO functions should be blocking
- * @retval `HAL_STATUS_OK` - message sent successfully
+ * @note When using UART data is copied to the transmit buffer and sent in background
+ * @note Blocks only while the transmit buffer is full, unless `HAL_IO_TX_DROP` is defined
+ * @retval `HAL_STATUS_OK` - message sent (or buffered) successfully
+ * @retval `HAL_STATUS_BUSY` - transmit buffer full, part of the message dropped
  * @retval `HAL_STATUS_ERROR` - error during communication
 */
 inline hal_status_t io_putdata(const uint8_t* buffer, uint16_t len)
@@ -32,21 +164,82 @@ inline hal_status_t io_putdata(const uint8_t* buffer, uint16_t len)
         /** @todo Fix this to return status */
         CDC_Transmit_FS(buffer, len);
     #elif defined(HAL_IO_USE_UART)
-        if (HAL_UART_Transmit(IO_UART, buffer, len, 1000) != HAL_OK) {
-            ret_status = HAL_STATUS_ERROR;
+        while (len > 0) {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+
+            uint8_t fill = io_tx_fill;
+            uint16_t n = HAL_IO_TX_BUFFER_LEN - io_tx_len[fill];
+            if (n > len)
+                n = len;
+            memcpy(&io_tx_buffer[fill][io_tx_len[fill]], buffer, n);
+            io_tx_len[fill] += n;
+            ret_status = io_tx_start();
+
+            __set_PRIMASK(primask);
+
+            if (ret_status != HAL_STATUS_OK)
+                break;
+            buffer += n;
+            len -= n;
+            /* Buffers may have been swapped, the new fill buffer has space */
+            if (n > 0)
+                continue;
+
+            /* Fill buffer is full, can not wait for the swap in ISR context or with interrupts disabled */
+            #ifndef HAL_IO_TX_DROP
+            if (__get_IPSR() == 0 && primask == 0) {
+                /* Transmit complete swaps in the empty buffer, no need to wait for it to be sent */
+                while (io_tx_busy && io_tx_len[io_tx_fill] == HAL_IO_TX_BUFFER_LEN) {}
+                continue;
+            }
+            #endif
+            io_tx_dropped += len;
+            ret_status = HAL_STATUS_BUSY;
+            break;
         }
     #endif
 
     return ret_status;
 }
 
+/**
+ * Wait until all buffered data is sent
+ * 
+ * @retval `HAL_STATUS_OK` - all data sent
+ * @retval `HAL_STATUS_BUSY` - called from ISR context while data is still being sent
+ * @retval `HAL_STATUS_ERROR` - error during communication
+*/
+inline hal_status_t io_flush(void)
+{
+    #if defined(HAL_IO_USE_UART)
+        for (;;) {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            hal_status_t status = io_tx_start();
+            uint8_t done = !io_tx_busy && io_tx_len[io_tx_fill] == 0;
+            __set_PRIMASK(primask);
+
+            if (status != HAL_STATUS_OK)
+                return HAL_STATUS_ERROR;
+            if (done)
+                break;
+            if (__get_IPSR() != 0 || primask != 0)
+                return HAL_STATUS_BUSY;
+        }
+    #endif
+
+    return HAL_STATUS_OK;
+}
+
 /**
  * Receive `len` bytes of data and store starting at `buffer`
  * 
- * @note Blocking function
+ * @note Blocking function, waits at most `HAL_IO_RX_TIMEOUT_MS`
  * @note Never returns busy since all IO functions should be blocking
  * @retval `HAL_STATUS_OK` - message sent successfully
- * @retval `HAL_STATUS_ERROR` - error during communication
+ * @retval `HAL_STATUS_ERROR` - error during communication, timeout or the received
+ * data is passed to a registered receive callback instead
 */
 inline hal_status_t io_getdata(uint8_t* buffer, uint16_t len)
 {
@@ -55,7 +248,21 @@ inline hal_status_t io_getdata(uint8_t* buffer, uint16_t len)
     #if defined(HAL_IO_USE_USB)
 
     #elif defined(HAL_IO_USE_UART)
-        if (HAL_UART_Receive(IO_UART, buffer, len, 1000) != HAL_OK) {
+        if (io_rx_started) {
+            /* Receive callback consumes the data, it never collects in the ring */
+            if (callback_assigned != NULL)
+                return HAL_STATUS_ERROR;
+
+            /* Receiving continuously, wait for the data in the ring */
+            uint32_t start = HAL_GetTick();
+            io_rx_sync();
+            while (ring_used(&io_rx) < len) {
+                if (HAL_GetTick() - start >= HAL_IO_RX_TIMEOUT_MS)
+                    return HAL_STATUS_ERROR;
+                io_rx_sync();
+            }
+            ring_read(&io_rx, buffer, len);
+        } else if (HAL_UART_Receive(IO_UART, buffer, len, 1000) != HAL_OK) {
             ret_status = HAL_STATUS_ERROR;
         }
     #endif
@@ -112,26 +319,151 @@ inline hal_status_t io_getchar(char* c)
 }
 
 
+#if defined(HAL_IO_USE_UART)
 /**
- * Callback for IO receive event
- */
-static void (*callback_assigned)(uint8_t*, uint16_t) = NULL;
+ * Start the reception at the current position of the ring
+ * @note With DMA the whole ring is received in circular mode, so the reception starts at the
+ * beginning of the buffer and unread data is dropped to realign the ring
+*/
+static hal_status_t io_rx_arm(void)
+{
+    #ifdef HAL_IO_USE_DMA
+        size_t head = atomic_load_explicit(&io_rx.head, memory_order_relaxed);
+        size_t used = head - atomic_load_explicit(&io_rx.tail, memory_order_acquire);
+        size_t pad = (HAL_IO_RX_BUFFER_LEN - (head & (HAL_IO_RX_BUFFER_LEN - 1))) & (HAL_IO_RX_BUFFER_LEN - 1);
+
+        /* Padding is not data, the consumer skips it together with the unread data */
+        io_rx_overruns += used < HAL_IO_RX_BUFFER_LEN ? used : HAL_IO_RX_BUFFER_LEN;
+        io_rx_skip = head + pad;
+        ring_commit(&io_rx, pad);
+        io_rx_pos = 0;
+
+        if (HAL_UARTEx_ReceiveToIdle_DMA(IO_UART, io_rx_buffer, HAL_IO_RX_BUFFER_LEN) != HAL_OK)
+            return HAL_STATUS_ERROR;
+    #else
+        /* Interrupt reception stops on every event, re-armed up to the end of the buffer */
+        if (HAL_UARTEx_ReceiveToIdle_IT(IO_UART, &io_rx_buffer[io_rx_pos], HAL_IO_RX_BUFFER_LEN - io_rx_pos) != HAL_OK)
+            return HAL_STATUS_ERROR;
+    #endif
+
+    return HAL_STATUS_OK;
+}
+
+/**
+ * Publish data received up to position `pos` of the buffer
+*/
+static void io_rx_event(uint16_t pos)
+{
+    uint16_t len = (pos - io_rx_pos) & (HAL_IO_RX_BUFFER_LEN - 1);
+    size_t used = ring_used(&io_rx);
+    size_t free = used < HAL_IO_RX_BUFFER_LEN ? HAL_IO_RX_BUFFER_LEN - used : 0;
+
+    /* Whole buffer received since the last event, `pos` is the end of the buffer */
+    if (len == 0 && pos != io_rx_pos)
+        len = HAL_IO_RX_BUFFER_LEN;
+
+    /* Oldest data was overwritten, counted here and skipped by the consumer */
+    if (len > free)
+        io_rx_overruns += len - free;
+    ring_commit(&io_rx, len);
+    io_rx_pos = pos & (HAL_IO_RX_BUFFER_LEN - 1);
+
+    /* With a callback the ISR is the consumer */
+    if (callback_assigned != NULL) {
+        io_rx_sync();
+        ring_span_t span[2];
+        size_t used = ring_read_spans(&io_rx, span);
+
+        for (uint8_t i = 0; i < 2; i++) {
+            if (span[i].len != 0)
+                callback_assigned(span[i].data, (uint16_t)span[i].len);
+        }
+        ring_consume(&io_rx, used);
+    }
+}
+
+/**
+ * Receive error of the IO UART, called from hal_uart.c
+ * @return 1 if `uart` is the IO port and the reception was restarted
+*/
+uint8_t io_uart_recv_isr(uart_t uart, hal_status_t status)
+{
+    UNUSED(status);
+
+    if (uart != IO_UART || !io_rx_started || uart->RxState != HAL_UART_STATE_READY)
+        return 0;
+
+    io_rx_arm();
+    return 1;
+}
 
-#if HAL_IO_USE_UART
-static uint8_t uart_recv_buffer[UART_RECV_BUFF_LEN];
 /* If STM32 register callbacks are enabled, use a custom function for ISR */
 #if (USE_HAL_UART_REGISTER_CALLBACKS == 1)
 
 #else
 void HAL_UARTEx_RxEventCallback(uart_t uart, uint16_t len)
 {
-    if (callback_assigned != NULL)
-        callback_assigned(uart_recv_buffer, len);
-    HAL_UARTEx_ReceiveToIdle_IT(IO_UART, uart_recv_buffer, UART_RECV_BUFF_LEN);
+    if (uart != IO_UART)
+        return;
+
+    #ifdef HAL_IO_USE_DMA
+        /* In circular mode `len` is the position in the buffer */
+        io_rx_event(len);
+    #else
+        io_rx_event(io_rx_pos + len);
+        io_rx_arm();
+    #endif
 }
 #endif
 #endif
 
+/**
+ * Start continuous receiving into the IO receive ring
+*/
+inline hal_status_t io_rx_start(void)
+{
+#ifdef HAL_IO_USE_UART
+    if (io_rx_started)
+        return HAL_STATUS_OK;
+
+    ring_init(&io_rx, io_rx_buffer, HAL_IO_RX_BUFFER_LEN);
+    io_rx_pos = 0;
+    if (io_rx_arm() != HAL_STATUS_OK)
+        return HAL_STATUS_ERROR;
+    io_rx_started = 1;
+
+    return HAL_STATUS_OK;
+#else
+    return HAL_STATUS_ERROR;
+#endif
+}
+
+/**
+ * Get the IO receive ring
+ * @note Skips the data overwritten since the last call, call before each read
+*/
+inline ring_t* io_rx_ring(void)
+{
+#ifdef HAL_IO_USE_UART
+    io_rx_sync();
+    return &io_rx;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * Number of received bytes lost because the receive ring was full
+*/
+inline uint32_t io_rx_get_overruns(void)
+{
+#ifdef HAL_IO_USE_UART
+    return io_rx_overruns;
+#else
+    return 0;
+#endif
+}
+
 /**
  * Register a callback for when data is received over IO port
  * @note Callback function is called from ISR context
@@ -143,11 +475,9 @@ inline hal_status_t io_register_receive_callback(void (*callback)(uint8_t* data,
     #if (USE_HAL_UART_REGISTER_CALLBACKS == 1)
     /** @todo Register a callback to the function above */
     #endif
-    if (callback_assigned == NULL) {
-        if (HAL_UARTEx_ReceiveToIdle_IT(IO_UART, uart_recv_buffer, UART_RECV_BUFF_LEN) != HAL_OK)
-            return HAL_STATUS_ERROR;
-    }
+    if (io_rx_start() != HAL_STATUS_OK)
+        return HAL_STATUS_ERROR;
 #endif
     callback_assigned = callback;
     return HAL_STATUS_OK;
-}
\ No newline at end of file
+}
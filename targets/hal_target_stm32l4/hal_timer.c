@@ -81,10 +81,95 @@ inline timer_count_t timer_get_count(timer_t timer)
 }
 
 #ifdef HAL_TIMER_USE_REGISTER_CALLBACKS
+/* TIM1 to TIM8, TIM15, TIM16 and TIM17 */
+#define TIMER_MAX_INSTANCES (11)
+#define TIMER_CB_SRC_COUNT  (TIMER_CB_SRC_PERIOD + 1)
 
+/**
+ * Callbacks of one timer instance
+*/
+typedef struct {
+    callback_t callbacks[TIMER_CB_SRC_COUNT];
+} timer_instance_t;
+
+static timer_instance_t timer_instances[TIMER_MAX_INSTANCES];
+
+/**
+ * State of the instance of the handle
+ * @return NULL if the instance is not known
+*/
+static timer_instance_t* timer_get_instance(timer_t timer)
+{
+    switch ((uintptr_t)timer->Instance) {
+    case TIM1_BASE:
+        return &timer_instances[0];
+    case TIM2_BASE:
+        return &timer_instances[1];
+#ifdef TIM3
+    case TIM3_BASE:
+        return &timer_instances[2];
+#endif
+#ifdef TIM4
+    case TIM4_BASE:
+        return &timer_instances[3];
+#endif
+#ifdef TIM5
+    case TIM5_BASE:
+        return &timer_instances[4];
+#endif
+    case TIM6_BASE:
+        return &timer_instances[5];
+#ifdef TIM7
+    case TIM7_BASE:
+        return &timer_instances[6];
+#endif
+#ifdef TIM8
+    case TIM8_BASE:
+        return &timer_instances[7];
+#endif
+    case TIM15_BASE:
+        return &timer_instances[8];
+    case TIM16_BASE:
+        return &timer_instances[9];
+#ifdef TIM17
+    case TIM17_BASE:
+        return &timer_instances[10];
+#endif
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * Register a callback for timer event
+ * @retval `HAL_STATUS_OK` callback registered successfully
+ * @retval `HAL_STATUS_ERROR` callback registration failed
+ * @note Implement in hal_timer.c
+ * @note Multiple registrations should override the last one
+*/
+inline hal_status_t timer_register_callback(timer_t timer, callback_t callback, timer_callback_src_t src)
+{
+    timer_instance_t* instance = timer_get_instance(timer);
+
+    if (instance == NULL || src >= TIMER_CB_SRC_COUNT) {
+        return HAL_STATUS_ERROR;
+    }
+
+    instance->callbacks[src] = callback;
+    return HAL_STATUS_OK;
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim)
+{
+    timer_instance_t* instance = timer_get_instance(htim);
+
+    if (instance != NULL && instance->callbacks[TIMER_CB_SRC_PERIOD] != NULL) {
+        instance->callbacks[TIMER_CB_SRC_PERIOD](HAL_STATUS_OK);
+    }
+}
 #else
-HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim)
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim)
 {
     timer_period_isr(htim);
 }
-#endif
\ No newline at end of file
+#endif
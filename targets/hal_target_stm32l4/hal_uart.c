@@ -6,7 +6,98 @@ typedef enum {
     UART_RECV
 } uart_op_t;
 
-static uart_op_t uart_it_started_op;
+/* USART1, USART2, USART3, UART4, UART5 and LPUART1 */
+#define UART_MAX_INSTANCES  (6)
+#define UART_CB_SRC_COUNT   (UART_CB_SRC_RECV_ERROR + 1)
+
+/**
+ * Interrupt mode state of one UART instance
+*/
+typedef struct {
+    /* Bit per `uart_op_t` of the operations in progress, sending and receiving can overlap */
+    volatile uint8_t started_ops;
+#ifdef HAL_UART_USE_REGISTER_CALLBACKS
+    callback_t callbacks[UART_CB_SRC_COUNT];
+#endif
+} uart_instance_t;
+
+static uart_instance_t uart_instances[UART_MAX_INSTANCES];
+
+/**
+ * State of the instance of the handle
+ * @return NULL if the instance is not known
+*/
+static uart_instance_t* uart_get_instance(uart_t uart)
+{
+    switch ((uintptr_t)uart->Instance) {
+    case USART1_BASE:
+        return &uart_instances[0];
+    case USART2_BASE:
+        return &uart_instances[1];
+#ifdef USART3
+    case USART3_BASE:
+        return &uart_instances[2];
+#endif
+#ifdef UART4
+    case UART4_BASE:
+        return &uart_instances[3];
+#endif
+#ifdef UART5
+    case UART5_BASE:
+        return &uart_instances[4];
+#endif
+    case LPUART1_BASE:
+        return &uart_instances[5];
+    default:
+        return NULL;
+    }
+}
+
+static void uart_set_started(uart_t uart, uart_op_t op, uint8_t started)
+{
+    uart_instance_t* instance = uart_get_instance(uart);
+
+    if (instance == NULL) {
+        return;
+    }
+
+    /* Operations of the two directions are started from different contexts */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (started) {
+        instance->started_ops |= 1 << op;
+    } else {
+        instance->started_ops &= ~(1 << op);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Route the end of an interrupt mode operation to the registered callback or the ISR
+*/
+static void uart_dispatch(uart_t uart, uart_op_t op, hal_status_t status)
+{
+#ifdef HAL_UART_USE_REGISTER_CALLBACKS
+    uart_instance_t* instance = uart_get_instance(uart);
+    uart_callback_src_t src;
+
+    if (op == UART_SEND) {
+        src = status == HAL_STATUS_OK ? UART_CB_SRC_SEND_COMPLETE : UART_CB_SRC_SEND_ERROR;
+    } else {
+        src = status == HAL_STATUS_OK ? UART_CB_SRC_RECV_COMPLETE : UART_CB_SRC_RECV_ERROR;
+    }
+
+    if (instance != NULL && instance->callbacks[src] != NULL) {
+        instance->callbacks[src](status);
+    }
+#else
+    if (op == UART_SEND) {
+        uart_send_isr(uart, status);
+    } else {
+        uart_recv_isr(uart, status);
+    }
+#endif
+}
 
 /**
  * Send <size> bytes via UART
@@ -69,14 +160,14 @@ inline hal_status_t uart_send_it(uart_t uart, uint8_t* data, uint16_t size, uint
 
     /** @todo Check if uart is busy and return HAL_STATUS_BUSY if true */
 
+    /* Set before starting, the error interrupt can come before the start returns */
+    uart_set_started(uart, UART_SEND, 1);
+
     if (HAL_UART_Transmit_IT(uart, data, size) != HAL_OK) {
+        uart_set_started(uart, UART_SEND, 0);
         ret_status = HAL_STATUS_ERROR;
     }
 
-    if (ret_status == HAL_STATUS_OK) {
-        uart_it_started_op = UART_SEND;
-    }
-
     return ret_status;
 }
 
@@ -96,17 +187,27 @@ inline hal_status_t uart_recv_it(uart_t uart, uint8_t* buff, uint16_t size, uint
 
     /** @todo Check if uart is busy and return HAL_STATUS_BUSY if true */
 
+    /* Set before starting, the error interrupt can come before the start returns */
+    uart_set_started(uart, UART_RECV, 1);
+
     if (HAL_UART_Receive_IT(uart, buff, size) != HAL_OK) {
+        uart_set_started(uart, UART_RECV, 0);
         ret_status = HAL_STATUS_ERROR;
     }
 
-    if (ret_status == HAL_STATUS_OK) {
-        uart_it_started_op = UART_RECV;
-    }
-
     return ret_status;
 }
 
+/**
+ * Returns number of bytes received so far by the last `uart_recv_it`
+ * @note Once the operation completes it stays <size> until the next start
+ * @note Implement in hal_uart.c
+ */
+inline uint16_t uart_recv_it_count(uart_t uart)
+{
+    return uart->RxXferSize - uart->RxXferCount;
+}
+
 /**
  * Returns whether UART receive buffer is empty
  */
@@ -133,7 +234,14 @@ inline uint8_t uart_get_rx_data(uart_t uart)
 */
 inline hal_status_t uart_register_callback(uart_t uart, callback_t callback, uart_callback_src_t src)
 {
-    #error "UART register callbacks not implemented"
+    uart_instance_t* instance = uart_get_instance(uart);
+
+    if (instance == NULL || src >= UART_CB_SRC_COUNT) {
+        return HAL_STATUS_ERROR;
+    }
+
+    instance->callbacks[src] = callback;
+    return HAL_STATUS_OK;
 }
 #else
 
@@ -146,23 +254,72 @@ __weak void uart_recv_isr(uart_t uart, hal_status_t status)
 {
 
 }
+#endif
+
+/**
+ * Transmit hook of the buffered IO port, implemented in hal_io.c
+ * @return 1 if `uart` is the IO port, then `uart_send_isr` is not called
+*/
+__weak uint8_t io_uart_send_isr(uart_t uart, hal_status_t status)
+{
+    UNUSED(uart);
+    UNUSED(status);
+
+    return 0;
+}
+
+/**
+ * Receive error hook of the IO port, implemented in hal_io.c
+ * @return 1 if `uart` is the IO port, then `uart_recv_isr` is not called
+*/
+__weak uint8_t io_uart_recv_isr(uart_t uart, hal_status_t status)
+{
+    UNUSED(uart);
+    UNUSED(status);
+
+    return 0;
+}
 
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart)
 {
-    uart_send_isr(huart, HAL_STATUS_OK);
+    if (io_uart_send_isr(huart, HAL_STATUS_OK))
+        return;
+
+    uart_set_started(huart, UART_SEND, 0);
+    uart_dispatch(huart, UART_SEND, HAL_STATUS_OK);
 }
 
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart)
 {
-    uart_recv_isr(huart, HAL_STATUS_OK);
+    uart_set_started(huart, UART_RECV, 0);
+    uart_dispatch(huart, UART_RECV, HAL_STATUS_OK);
 }
 
 void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart)
 {
-    if (uart_it_started_op == UART_SEND) {
-        uart_send_isr(huart, HAL_STATUS_ERROR);
+    /* Line errors are receive errors, only DMA errors can abort the IO port transmit */
+    if ((huart->ErrorCode & HAL_UART_ERROR_DMA) && io_uart_send_isr(huart, HAL_STATUS_ERROR))
+        return;
+    if (io_uart_recv_isr(huart, HAL_STATUS_ERROR))
+        return;
+
+    uart_instance_t* instance = uart_get_instance(huart);
+    if (instance == NULL)
+        return;
+
+    uint8_t started = instance->started_ops;
+    uart_op_t op;
+
+    /* Prefer the receive unless only the transmit is in progress or the DMA failed */
+    if ((started & (1 << UART_SEND)) && (!(started & (1 << UART_RECV)) || (huart->ErrorCode & HAL_UART_ERROR_DMA))) {
+        op = UART_SEND;
     } else {
-        uart_recv_isr(huart, HAL_STATUS_ERROR);
+        op = UART_RECV;
+    }
+
+    /* Non blocking line errors do not abort the transfer, it still completes later */
+    if ((op == UART_SEND ? huart->gState : huart->RxState) == HAL_UART_STATE_READY) {
+        uart_set_started(huart, op, 0);
     }
+    uart_dispatch(huart, op, HAL_STATUS_ERROR);
 }
-#endif
\ No newline at end of file
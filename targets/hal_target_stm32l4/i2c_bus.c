@@ -0,0 +1,128 @@
+#include "i2c_bus.h"
+
+/**
+ * Addresses are passed to the HAL shifted to the 8-bit form
+*/
+#define STM32_I2C_BUS_ADDR(addr)    ((uint16_t)((addr) << 1))
+
+static status_t stm32_i2c_bus_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    stm32_i2c_bus_t* bus = (stm32_i2c_bus_t*)context;
+
+    if (nbyte > UINT16_MAX)
+        return STATUS_ERROR;
+
+    return STATUS_FROM_BOOL(HAL_I2C_Master_Transmit(bus->handle, STM32_I2C_BUS_ADDR(addr), data,
+        (uint16_t)nbyte, bus->timeout_ms) == HAL_OK);
+}
+
+static status_t stm32_i2c_bus_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    stm32_i2c_bus_t* bus = (stm32_i2c_bus_t*)context;
+
+    if (nbyte > UINT16_MAX)
+        return STATUS_ERROR;
+
+    return STATUS_FROM_BOOL(HAL_I2C_Master_Receive(bus->handle, STM32_I2C_BUS_ADDR(addr), data,
+        (uint16_t)nbyte, bus->timeout_ms) == HAL_OK);
+}
+
+/**
+ * Transfer the segments as the frames of one sequential transaction, without a restart
+ * between them, and wait for each frame
+*/
+static status_t stm32_i2c_bus_seq(stm32_i2c_bus_t* bus, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt, uint8_t rx)
+{
+    size_t last = iovcnt;
+
+    /* Empty segments are skipped, the last one which is not ends the transaction */
+    for (size_t i = 0; i < iovcnt; i++) {
+        if (iov[i].nbyte > UINT16_MAX)
+            return STATUS_ERROR;
+        if (iov[i].nbyte != 0)
+            last = i;
+    }
+    if (last == iovcnt)
+        return rx ? stm32_i2c_bus_read(bus, addr, NULL, 0) : stm32_i2c_bus_write(bus, addr, NULL, 0);
+
+    uint32_t start = HAL_GetTick();
+    uint8_t first = 1;
+
+    for (size_t i = 0; i <= last; i++) {
+        if (iov[i].nbyte == 0)
+            continue;
+
+        uint32_t options;
+        if (first)
+            options = i == last ? I2C_FIRST_AND_LAST_FRAME : I2C_FIRST_AND_NEXT_FRAME;
+        else
+            options = i == last ? I2C_LAST_FRAME : I2C_NEXT_FRAME;
+        first = 0;
+
+        HAL_StatusTypeDef ret = rx
+            ? HAL_I2C_Master_Seq_Receive_IT(bus->handle, STM32_I2C_BUS_ADDR(addr), iov[i].data, (uint16_t)iov[i].nbyte, options)
+            : HAL_I2C_Master_Seq_Transmit_IT(bus->handle, STM32_I2C_BUS_ADDR(addr), iov[i].data, (uint16_t)iov[i].nbyte, options);
+        if (ret != HAL_OK)
+            return STATUS_ERROR;
+
+        while (HAL_I2C_GetState(bus->handle) != HAL_I2C_STATE_READY) {
+            if (HAL_GetTick() - start >= bus->timeout_ms) {
+                HAL_I2C_Master_Abort_IT(bus->handle, STM32_I2C_BUS_ADDR(addr));
+                return STATUS_ERROR;
+            }
+        }
+        if (bus->handle->ErrorCode != HAL_I2C_ERROR_NONE)
+            return STATUS_ERROR;
+    }
+
+    return STATUS_OK;
+}
+
+static status_t stm32_i2c_bus_writev(void* context, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    return stm32_i2c_bus_seq((stm32_i2c_bus_t*)context, addr, iov, iovcnt, 0);
+}
+
+static status_t stm32_i2c_bus_readv(void* context, uint8_t addr, const sdev_iovec_t* iov, size_t iovcnt)
+{
+    return stm32_i2c_bus_seq((stm32_i2c_bus_t*)context, addr, iov, iovcnt, 1);
+}
+
+/**
+ * Single trial, retries are up to the retry policy
+*/
+static status_t stm32_i2c_bus_dev_probe(void* context, uint8_t addr)
+{
+    stm32_i2c_bus_t* bus = (stm32_i2c_bus_t*)context;
+
+    return STATUS_FROM_BOOL(HAL_I2C_IsDeviceReady(bus->handle, STM32_I2C_BUS_ADDR(addr), 1, bus->timeout_ms) == HAL_OK);
+}
+
+static status_t stm32_i2c_bus_set_timeout(void* context, uint16_t timeout_ms)
+{
+    stm32_i2c_bus_t* bus = (stm32_i2c_bus_t*)context;
+
+    bus->timeout_ms = timeout_ms != 0 ? timeout_ms : STM32_I2C_BUS_TIMEOUT_MS;
+
+    return STATUS_OK;
+}
+
+i2c_ops_t stm32_i2c_ops = {
+    .write = &stm32_i2c_bus_write,
+    .read = &stm32_i2c_bus_read,
+    .dev_probe = &stm32_i2c_bus_dev_probe,
+    .set_timeout = &stm32_i2c_bus_set_timeout,
+    .writev = &stm32_i2c_bus_writev,
+    .readv = &stm32_i2c_bus_readv
+};
+
+status_t stm32_i2c_bus_init(stm32_i2c_bus_t* bus, I2C_HandleTypeDef* handle)
+{
+    if (handle == NULL)
+        return STATUS_ERROR;
+
+    bus->handle = handle;
+    bus->timeout_ms = STM32_I2C_BUS_TIMEOUT_MS;
+
+    return STATUS_OK;
+}
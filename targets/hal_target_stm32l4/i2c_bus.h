@@ -0,0 +1,54 @@
+#ifndef HAL_TARGET_STM32L4_I2C_BUS_H
+#define HAL_TARGET_STM32L4_I2C_BUS_H
+
+#include <stdint.h>
+#include "hal_target_stm32l4.h"
+#include "drivers/i2c.h"
+
+/**
+ * I2C driver bus (drivers/i2c.h) on an ST HAL handle
+ *
+ * Implements all `i2c_ops_t` handlers, the per attempt timeout of the retry policy is passed
+ * to the blocking HAL functions.
+ *
+ * Vectored transfers use the sequential interrupt functions of the HAL, one frame per segment
+ * in the same transaction, so the I2C event and error interrupts have to be enabled.
+ *
+ * @example
+ * static stm32_i2c_bus_t i2c1_bus;
+ * static i2c_t i2c_sensors;
+ *
+ * stm32_i2c_bus_init(&i2c1_bus, &hi2c1);
+ * i2c_open(&i2c_sensors, &stm32_i2c_ops, &i2c1_bus);
+ *
+ * @note Uses the ST HAL directly, `hal_i2c.h` can not be included together with drivers/i2c.h
+*/
+
+/**
+ * Timeout of each transaction until the retry policy sets one
+*/
+#ifndef STM32_I2C_BUS_TIMEOUT_MS
+#define STM32_I2C_BUS_TIMEOUT_MS    (100)
+#endif
+
+/**
+ * @note Members should only be used through API functions starting with stm32_i2c_bus_*
+*/
+typedef struct stm32_i2c_bus {
+    I2C_HandleTypeDef* handle;
+    uint16_t timeout_ms;
+} stm32_i2c_bus_t;
+
+/**
+ * Handlers of the bus, the context is the `stm32_i2c_bus_t`
+*/
+extern i2c_ops_t stm32_i2c_ops;
+
+/**
+ * Initialize a bus on an initialized HAL handle
+ *
+ * @note Requires static (persistent) allocation
+*/
+status_t stm32_i2c_bus_init(stm32_i2c_bus_t* bus, I2C_HandleTypeDef* handle);
+
+#endif
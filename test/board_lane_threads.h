@@ -0,0 +1,13 @@
+#ifndef TEST_BOARD_LANE_THREADS_H
+#define TEST_BOARD_LANE_THREADS_H
+
+/**
+ * Lane threads for the board test (see `BOARD_LANE_START` in drivers/board.h),
+ * included into every source file of the threads variant
+*/
+
+int board_test_lane_start(void* (*fn)(void*), void* lane);
+
+#define BOARD_LANE_START(fn, lane)  board_test_lane_start((fn), (lane))
+
+#endif
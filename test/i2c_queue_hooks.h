@@ -0,0 +1,14 @@
+#ifndef TEST_I2C_QUEUE_HOOKS_H
+#define TEST_I2C_QUEUE_HOOKS_H
+
+/**
+ * Queue hooks for the I2C queue test (see drivers/i2c_queue.h), included into every
+ * source file of the test: the test thread owns the queue and counts the waiting callers
+*/
+
+void i2c_queue_test_wait(void);
+
+#define I2C_QUEUE_DEDICATED_OWNER
+#define I2C_QUEUE_WAIT()    i2c_queue_test_wait()
+
+#endif
@@ -0,0 +1,504 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include "mock_stm32l4.h"
+
+/* Exception number of a peripheral interrupt */
+#define MOCK_IRQ_EXCEPTION      (16u)
+
+static pthread_mutex_t mock_core = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static _Thread_local uint32_t mock_primask;
+static _Thread_local uint32_t mock_ipsr;
+
+uint32_t __get_PRIMASK(void)
+{
+    return mock_primask;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    if (primask && !mock_primask)
+        pthread_mutex_lock(&mock_core);
+    else if (!primask && mock_primask)
+        pthread_mutex_unlock(&mock_core);
+
+    mock_primask = primask;
+}
+
+void __disable_irq(void)
+{
+    __set_PRIMASK(1);
+}
+
+void __enable_irq(void)
+{
+    __set_PRIMASK(0);
+}
+
+uint32_t __get_IPSR(void)
+{
+    return mock_ipsr;
+}
+
+void mock_irq_enter(void)
+{
+    pthread_mutex_lock(&mock_core);
+    mock_ipsr = MOCK_IRQ_EXCEPTION;
+}
+
+void mock_irq_exit(void)
+{
+    mock_ipsr = 0;
+    pthread_mutex_unlock(&mock_core);
+}
+
+uint32_t HAL_GetTick(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/* Like the HAL, the callbacks are overridden by the target */
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart)
+{
+    UNUSED(huart);
+}
+
+__weak void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart)
+{
+    UNUSED(huart);
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart)
+{
+    UNUSED(huart);
+}
+
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t size)
+{
+    UNUSED(huart);
+    UNUSED(size);
+}
+
+/**
+ * Append sent data to the capture buffer, data beyond its size is not kept
+*/
+static void mock_uart_capture(UART_HandleTypeDef* huart, const uint8_t* data, size_t len)
+{
+    size_t room = MOCK_UART_CAPTURE_LEN - huart->mock_tx_len;
+
+    if (len > room)
+        len = room;
+    memcpy(&huart->mock_tx[huart->mock_tx_len], data, len);
+    huart->mock_tx_len += len;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size, uint32_t timeout)
+{
+    UNUSED(timeout);
+
+    if (huart->gState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+
+    mock_uart_capture(huart, data, size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+    UNUSED(huart);
+    UNUSED(data);
+    UNUSED(size);
+    UNUSED(timeout);
+
+    /* Nothing arrives while the caller blocks */
+    return HAL_TIMEOUT;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size)
+{
+    if (huart->gState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    if (data == NULL || size == 0)
+        return HAL_ERROR;
+
+    huart->pTxBuffPtr = data;
+    huart->TxXferSize = size;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size)
+{
+    return HAL_UART_Transmit_IT(huart, data, size);
+}
+
+/**
+ * Start a reception of any mode
+*/
+static HAL_StatusTypeDef mock_uart_rx_start(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size,
+    uint8_t circular, uint8_t to_idle)
+{
+    if (huart->RxState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    if (data == NULL || size == 0)
+        return HAL_ERROR;
+
+    huart->pRxBuffPtr = data;
+    huart->RxXferSize = size;
+    huart->RxXferCount = size;
+    huart->mock_rx_circular = circular;
+    huart->mock_rx_to_idle = to_idle;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size)
+{
+    return mock_uart_rx_start(huart, data, size, 0, 0);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size)
+{
+    return mock_uart_rx_start(huart, data, size, 0, 1);
+}
+
+/**
+ * @note The DMA channel is assumed to be configured in circular mode
+*/
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size)
+{
+    return mock_uart_rx_start(huart, data, size, 1, 1);
+}
+
+HAL_UART_StateTypeDef HAL_UART_GetState(UART_HandleTypeDef* huart)
+{
+    UNUSED(huart);
+
+    /* Blocking calls complete immediately in the mock */
+    return HAL_UART_STATE_RESET;
+}
+
+uint8_t mock_uart_tx_complete(UART_HandleTypeDef* huart)
+{
+    uint8_t active;
+
+    mock_irq_enter();
+    active = huart->gState == HAL_UART_STATE_BUSY_TX;
+    if (active) {
+        mock_uart_capture(huart, huart->pTxBuffPtr, huart->TxXferSize);
+        huart->gState = HAL_UART_STATE_READY;
+        HAL_UART_TxCpltCallback(huart);
+    }
+    mock_irq_exit();
+
+    return active;
+}
+
+void mock_uart_tx_error(UART_HandleTypeDef* huart, uint32_t error)
+{
+    mock_irq_enter();
+    huart->ErrorCode = error;
+    huart->gState = HAL_UART_STATE_READY;
+    HAL_UART_ErrorCallback(huart);
+    mock_irq_exit();
+}
+
+void mock_uart_rx_error(UART_HandleTypeDef* huart, uint32_t error)
+{
+    mock_irq_enter();
+    huart->ErrorCode = error;
+    huart->RxState = HAL_UART_STATE_READY;
+    HAL_UART_ErrorCallback(huart);
+    mock_irq_exit();
+}
+
+size_t mock_uart_tx_take(UART_HandleTypeDef* huart, uint8_t* data, size_t len)
+{
+    mock_irq_enter();
+    if (len > huart->mock_tx_len)
+        len = huart->mock_tx_len;
+    memcpy(data, huart->mock_tx, len);
+    memmove(huart->mock_tx, &huart->mock_tx[len], huart->mock_tx_len - len);
+    huart->mock_tx_len -= len;
+    mock_irq_exit();
+
+    return len;
+}
+
+/**
+ * Store one received byte and signal the events it completes, like the HAL interrupt handler
+*/
+static void mock_uart_rx_byte(UART_HandleTypeDef* huart, uint8_t byte)
+{
+    if (huart->RxState != HAL_UART_STATE_BUSY_RX) {
+        huart->mock_rx_dropped++;
+        return;
+    }
+
+    uint16_t size = huart->RxXferSize;
+
+    huart->pRxBuffPtr[size - huart->RxXferCount] = byte;
+    huart->RxXferCount--;
+
+    if (huart->mock_rx_circular && huart->RxXferCount == size / 2) {
+        HAL_UARTEx_RxEventCallback(huart, size / 2);
+        return;
+    }
+    if (huart->RxXferCount != 0)
+        return;
+
+    if (huart->mock_rx_circular)
+        huart->RxXferCount = size;
+    else
+        huart->RxState = HAL_UART_STATE_READY;
+
+    if (huart->mock_rx_to_idle)
+        HAL_UARTEx_RxEventCallback(huart, size);
+    else
+        HAL_UART_RxCpltCallback(huart);
+}
+
+void mock_uart_rx(UART_HandleTypeDef* huart, const uint8_t* data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        mock_irq_enter();
+        mock_uart_rx_byte(huart, data[i]);
+        mock_irq_exit();
+    }
+}
+
+void mock_uart_rx_idle(UART_HandleTypeDef* huart)
+{
+    mock_irq_enter();
+
+    uint16_t received = huart->RxXferSize - huart->RxXferCount;
+
+    /* Like the HAL, an idle line right after a transfer event is not reported */
+    if (huart->RxState == HAL_UART_STATE_BUSY_RX && huart->mock_rx_to_idle
+        && received > 0 && received < huart->RxXferSize) {
+        if (!huart->mock_rx_circular)
+            huart->RxState = HAL_UART_STATE_READY;
+        HAL_UARTEx_RxEventCallback(huart, received);
+    }
+
+    mock_irq_exit();
+}
+
+/**
+ * Address the mock target device, a transaction of `size` bytes has to fit its storage
+*/
+static HAL_StatusTypeDef mock_i2c_address(I2C_HandleTypeDef* hi2c, uint16_t address, size_t size, uint32_t timeout)
+{
+    hi2c->mock_transactions++;
+    hi2c->mock_timeout = timeout;
+
+    if (hi2c->mock_busy > 0) {
+        hi2c->mock_busy--;
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        return HAL_ERROR;
+    }
+
+    if (hi2c->mock_ack_addr == 0 || address != hi2c->mock_ack_addr || size > MOCK_I2C_DATA_LEN) {
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        return HAL_ERROR;
+    }
+
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+    if (mock_i2c_address(hi2c, address, size, timeout) != HAL_OK)
+        return HAL_ERROR;
+
+    memcpy(hi2c->mock_data, data, size);
+    hi2c->mock_data_len = size;
+    hi2c->mock_busy = hi2c->mock_write_cycle;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+    if (mock_i2c_address(hi2c, address, size, timeout) != HAL_OK)
+        return HAL_ERROR;
+
+    memcpy(data, hi2c->mock_data, size);
+    return HAL_OK;
+}
+
+/**
+ * Frame of a sequential transfer, completes right away: a first frame starts a transaction
+ * and the next ones continue where the previous one stopped
+*/
+static HAL_StatusTypeDef mock_i2c_seq(I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t size, uint32_t options)
+{
+    if (hi2c->State != HAL_I2C_STATE_READY && hi2c->State != HAL_I2C_STATE_RESET)
+        return HAL_BUSY;
+
+    if (options == I2C_FIRST_FRAME || options == I2C_FIRST_AND_NEXT_FRAME || options == I2C_FIRST_AND_LAST_FRAME) {
+        if (mock_i2c_address(hi2c, address, size, 0) != HAL_OK)
+            return HAL_ERROR;
+        hi2c->mock_seq_pos = 0;
+    } else if (hi2c->mock_seq_pos + size > MOCK_I2C_DATA_LEN) {
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        return HAL_ERROR;
+    }
+
+    hi2c->State = HAL_I2C_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_IT(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t options)
+{
+    if (mock_i2c_seq(hi2c, address, size, options) != HAL_OK)
+        return HAL_ERROR;
+
+    memcpy(&hi2c->mock_data[hi2c->mock_seq_pos], data, size);
+    hi2c->mock_seq_pos += size;
+    hi2c->mock_data_len = hi2c->mock_seq_pos;
+    if (options == I2C_LAST_FRAME || options == I2C_FIRST_AND_LAST_FRAME)
+        hi2c->mock_busy = hi2c->mock_write_cycle;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Receive_IT(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t options)
+{
+    if (mock_i2c_seq(hi2c, address, size, options) != HAL_OK)
+        return HAL_ERROR;
+
+    memcpy(data, &hi2c->mock_data[hi2c->mock_seq_pos], size);
+    hi2c->mock_seq_pos += size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t address)
+{
+    UNUSED(address);
+
+    hi2c->State = HAL_I2C_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef* hi2c)
+{
+    return hi2c->State;
+}
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t address, uint32_t trials, uint32_t timeout)
+{
+    for (uint32_t i = 0; i < trials; i++) {
+        if (mock_i2c_address(hi2c, address, 0, timeout) == HAL_OK)
+            return HAL_OK;
+    }
+
+    return HAL_ERROR;
+}
+
+__weak void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    UNUSED(hadc);
+}
+
+__weak void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    UNUSED(hadc);
+}
+
+__weak void HAL_ADC_ErrorCallback(ADC_HandleTypeDef* hadc)
+{
+    UNUSED(hadc);
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* data, uint32_t length)
+{
+    if (hadc->mock_running)
+        return HAL_BUSY;
+    if (data == NULL || length == 0 || hadc->DMA_Handle == NULL)
+        return HAL_ERROR;
+
+    /* DMA is configured for half-word transfers */
+    hadc->mock_buffer = (uint16_t*)data;
+    hadc->mock_length = length;
+    hadc->mock_converted = 0;
+    hadc->ErrorCode = ADC_ERROR_NONE;
+    hadc->DMA_Handle->Instance->CNDTR = length;
+    hadc->mock_running = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef* hadc)
+{
+    hadc->mock_running = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef* hadc, ADC_ChannelConfTypeDef* config)
+{
+    if (hadc->mock_running)
+        return HAL_BUSY;
+    if (config->Rank == 0 || config->Rank > MOCK_ADC_RANKS)
+        return HAL_ERROR;
+
+    hadc->mock_channels[config->Rank - 1] = config->Channel;
+    if (config->Rank > hadc->mock_ranks)
+        hadc->mock_ranks = config->Rank;
+    return HAL_OK;
+}
+
+/**
+ * Transfer one sample and signal the events it completes, like the DMA and ADC interrupt handlers
+*/
+static void mock_adc_sample(ADC_HandleTypeDef* hadc, uint16_t sample)
+{
+    DMA_HandleTypeDef* hdma = hadc->DMA_Handle;
+    uint32_t length = hadc->mock_length;
+
+    hadc->mock_buffer[length - hdma->Instance->CNDTR] = sample;
+    hdma->Instance->CNDTR--;
+
+    hadc->mock_isr |= ADC_FLAG_EOC;
+    if (++hadc->mock_converted >= (hadc->mock_ranks != 0 ? hadc->mock_ranks : 1)) {
+        hadc->mock_converted = 0;
+        hadc->mock_isr |= ADC_FLAG_EOS;
+    }
+
+    if (hdma->Instance->CNDTR == length / 2) {
+        HAL_ADC_ConvHalfCpltCallback(hadc);
+        return;
+    }
+    if (hdma->Instance->CNDTR != 0)
+        return;
+
+    if (hdma->Init.Mode == DMA_CIRCULAR)
+        hdma->Instance->CNDTR = length;
+    else
+        hadc->mock_running = 0;
+
+    HAL_ADC_ConvCpltCallback(hadc);
+}
+
+void mock_adc_convert(ADC_HandleTypeDef* hadc, const uint16_t* samples, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        mock_irq_enter();
+        if (hadc->mock_running)
+            mock_adc_sample(hadc, samples[i]);
+        mock_irq_exit();
+    }
+}
+
+void mock_adc_overrun(ADC_HandleTypeDef* hadc)
+{
+    mock_irq_enter();
+    hadc->mock_isr |= ADC_FLAG_OVR;
+    hadc->ErrorCode |= ADC_ERROR_OVR;
+    HAL_ADC_ErrorCallback(hadc);
+    mock_irq_exit();
+}
@@ -0,0 +1,74 @@
+#ifndef MOCK_STM32L4_H
+#define MOCK_STM32L4_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32l4xx_hal.h"
+
+/**
+ * Hardware events of the STM32L4 HAL mock
+ *
+ * The core is simulated with a recursive lock: it is held while interrupts are disabled
+ * and while an interrupt handler runs, so an event injected from another thread behaves
+ * like an interrupt of a single core MCU.
+*/
+
+/**
+ * Enter interrupt context, waits while interrupts are disabled by another thread
+*/
+void mock_irq_enter(void);
+
+/**
+ * Leave interrupt context
+*/
+void mock_irq_exit(void);
+
+/**
+ * Finish the transmit in progress and call the transmit complete callback from interrupt context
+ *
+ * @return 1 if a transmit was in progress
+*/
+uint8_t mock_uart_tx_complete(UART_HandleTypeDef* huart);
+
+/**
+ * Abort the transmit in progress with `error` (`HAL_UART_ERROR_*`) and call the error callback
+*/
+void mock_uart_tx_error(UART_HandleTypeDef* huart, uint32_t error);
+
+/**
+ * Abort the reception in progress with `error` (`HAL_UART_ERROR_*`) and call the error callback
+*/
+void mock_uart_rx_error(UART_HandleTypeDef* huart, uint32_t error);
+
+/**
+ * Move up to `len` transmitted bytes out of the capture buffer
+ *
+ * @return Number of bytes copied
+*/
+size_t mock_uart_tx_take(UART_HandleTypeDef* huart, uint8_t* data, size_t len);
+
+/**
+ * Receive `len` bytes, the callbacks of the reception mode in progress are called
+ * from interrupt context (half and full transfer events in circular mode)
+*/
+void mock_uart_rx(UART_HandleTypeDef* huart, const uint8_t* data, size_t len);
+
+/**
+ * Idle line after received data, ends the reception to idle in progress
+*/
+void mock_uart_rx_idle(UART_HandleTypeDef* huart);
+
+/**
+ * Convert `count` samples into the DMA buffer, the half and full transfer callbacks are
+ * called from interrupt context and the end of sequence flag is set after each sequence
+ *
+ * @note Samples converted while no DMA conversion is running are lost
+*/
+void mock_adc_convert(ADC_HandleTypeDef* hadc, const uint16_t* samples, size_t count);
+
+/**
+ * Overrun, the error callback is called from interrupt context and the conversion continues
+*/
+void mock_adc_overrun(ADC_HandleTypeDef* hadc);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef MOCK_STM32L4XX_H
+#define MOCK_STM32L4XX_H
+
+/**
+ * Host mock of the STM32L4 device header and HAL
+ *
+ * Declares the part of the ST HAL used by targets/hal_target_stm32l4, so the target sources
+ * can be compiled and tested on the host. Peripheral handles keep the member names of the
+ * ST HAL, hardware events are injected through the functions in mock_stm32l4.h.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __weak                  __attribute__((weak))
+
+#ifndef UNUSED
+#define UNUSED(x)               ((void)(x))
+#endif
+
+typedef enum {
+    HAL_OK = 0x00,
+    HAL_ERROR = 0x01,
+    HAL_BUSY = 0x02,
+    HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+/* Peripheral base addresses, only compared against, never dereferenced */
+#define USART1_BASE             (0x40013800u)
+#define USART2_BASE             (0x40004400u)
+#define USART3_BASE             (0x40004800u)
+#define UART4_BASE              (0x40004C00u)
+#define UART5_BASE              (0x40005000u)
+#define LPUART1_BASE            (0x40008000u)
+
+#define I2C1_BASE               (0x40005400u)
+#define I2C2_BASE               (0x40005800u)
+#define I2C3_BASE               (0x40005C00u)
+
+#define ADC1_BASE               (0x50040000u)
+#define ADC2_BASE               (0x50040100u)
+#define ADC3_BASE               (0x50040200u)
+
+typedef struct {
+    volatile uint32_t ISR;
+} ADC_TypeDef;
+
+#define ADC1                    ((ADC_TypeDef*)ADC1_BASE)
+#define ADC2                    ((ADC_TypeDef*)ADC2_BASE)
+#define ADC3                    ((ADC_TypeDef*)ADC3_BASE)
+
+typedef struct {
+    volatile uint32_t ISR;
+} I2C_TypeDef;
+
+#define I2C1                    ((I2C_TypeDef*)I2C1_BASE)
+#define I2C2                    ((I2C_TypeDef*)I2C2_BASE)
+#define I2C3                    ((I2C_TypeDef*)I2C3_BASE)
+
+typedef struct {
+    volatile uint32_t CNDTR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    volatile uint32_t RDR;
+    volatile uint32_t TDR;
+} USART_TypeDef;
+
+#define USART1                  ((USART_TypeDef*)USART1_BASE)
+#define USART2                  ((USART_TypeDef*)USART2_BASE)
+#define USART3                  ((USART_TypeDef*)USART3_BASE)
+#define UART4                   ((USART_TypeDef*)UART4_BASE)
+#define UART5                   ((USART_TypeDef*)UART5_BASE)
+#define LPUART1                 ((USART_TypeDef*)LPUART1_BASE)
+
+/* Core registers, interrupts are simulated by mock_irq_enter and mock_irq_exit */
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_IPSR(void);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef MOCK_STM32L4XX_HAL_H
+#define MOCK_STM32L4XX_HAL_H
+
+#include "stm32l4xx.h"
+#include "stm32l4xx_hal_i2c.h"
+#include "stm32l4xx_hal_uart.h"
+#include "stm32l4xx_hal_dma.h"
+#include "stm32l4xx_hal_adc.h"
+
+/**
+ * Milliseconds of the host monotonic clock
+*/
+uint32_t HAL_GetTick(void);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef MOCK_STM32L4XX_HAL_ADC_H
+#define MOCK_STM32L4XX_HAL_ADC_H
+
+#include "stm32l4xx.h"
+#include "stm32l4xx_hal_dma.h"
+
+/* Ranks of a regular sequence */
+#define MOCK_ADC_RANKS          (16)
+
+#define ADC_FLAG_EOC            (0x04u)
+#define ADC_FLAG_EOS            (0x08u)
+#define ADC_FLAG_OVR            (0x10u)
+
+#define ADC_ERROR_NONE          (0x00u)
+#define ADC_ERROR_OVR           (0x02u)
+#define ADC_ERROR_DMA           (0x04u)
+
+#define ADC_SAMPLETIME_2CYCLES_5    (0x00u)
+
+typedef struct {
+    uint32_t Channel;
+    uint32_t Rank;
+    uint32_t SamplingTime;
+} ADC_ChannelConfTypeDef;
+
+typedef struct __ADC_HandleTypeDef {
+    ADC_TypeDef* Instance;
+    DMA_HandleTypeDef* DMA_Handle;
+    volatile uint32_t ErrorCode;
+    /* Mock state of the DMA conversion in progress */
+    uint16_t* mock_buffer;
+    uint32_t mock_length;
+    uint8_t mock_running;
+    /* Channel of each rank and the length of the sequence */
+    uint32_t mock_channels[MOCK_ADC_RANKS];
+    uint32_t mock_ranks;
+    /* Conversions of the sequence in progress */
+    uint32_t mock_converted;
+    /* Status register, `Instance` is only an address and is never dereferenced */
+    volatile uint32_t mock_isr;
+} ADC_HandleTypeDef;
+
+#define __HAL_ADC_GET_FLAG(hadc, flag)      (((hadc)->mock_isr & (flag)) == (flag))
+#define __HAL_ADC_CLEAR_FLAG(hadc, flag)    ((hadc)->mock_isr &= ~(uint32_t)(flag))
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* data, uint32_t length);
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef* hadc, ADC_ChannelConfTypeDef* config);
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc);
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc);
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef* hadc);
+
+#endif
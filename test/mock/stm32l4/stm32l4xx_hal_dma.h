@@ -0,0 +1,23 @@
+#ifndef MOCK_STM32L4XX_HAL_DMA_H
+#define MOCK_STM32L4XX_HAL_DMA_H
+
+#include "stm32l4xx.h"
+
+#define DMA_NORMAL              (0x00u)
+#define DMA_CIRCULAR            (0x20u)
+
+typedef struct {
+    uint32_t Mode;
+} DMA_InitTypeDef;
+
+/**
+ * @note `Instance` points to a channel owned by the test, its CNDTR is updated by the mock
+*/
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef* Instance;
+    DMA_InitTypeDef Init;
+} DMA_HandleTypeDef;
+
+#define __HAL_DMA_GET_COUNTER(hdma)     ((hdma)->Instance->CNDTR)
+
+#endif
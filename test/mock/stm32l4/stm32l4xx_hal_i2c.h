@@ -0,0 +1,54 @@
+#ifndef MOCK_STM32L4XX_HAL_I2C_H
+#define MOCK_STM32L4XX_HAL_I2C_H
+
+#include "stm32l4xx.h"
+
+/* Bytes the mock target device stores */
+#ifndef MOCK_I2C_DATA_LEN
+#define MOCK_I2C_DATA_LEN       (256)
+#endif
+
+#define HAL_I2C_ERROR_NONE      (0x00u)
+#define HAL_I2C_ERROR_AF        (0x04u)
+
+/* Options of the sequential transfers */
+#define I2C_FIRST_FRAME             (0x01u)
+#define I2C_FIRST_AND_NEXT_FRAME    (0x02u)
+#define I2C_NEXT_FRAME              (0x03u)
+#define I2C_FIRST_AND_LAST_FRAME    (0x04u)
+#define I2C_LAST_FRAME              (0x05u)
+
+typedef enum {
+    HAL_I2C_STATE_RESET = 0x00u,
+    HAL_I2C_STATE_READY = 0x20u,
+    HAL_I2C_STATE_BUSY_TX = 0x21u,
+    HAL_I2C_STATE_BUSY_RX = 0x22u
+} HAL_I2C_StateTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+    I2C_TypeDef* Instance;
+    volatile HAL_I2C_StateTypeDef State;
+    volatile uint32_t ErrorCode;
+    /* Mock target device, acknowledges its 8-bit address `mock_ack_addr` (0 for none) */
+    uint16_t mock_ack_addr;
+    uint8_t mock_data[MOCK_I2C_DATA_LEN];
+    size_t mock_data_len;
+    /* Address phases not acknowledged after each write, like an EEPROM write cycle */
+    uint32_t mock_write_cycle;
+    uint32_t mock_busy;
+    /* Bus transactions and the timeout of the last one */
+    uint32_t mock_transactions;
+    uint32_t mock_timeout;
+    /* Position of the next frame of a sequential transfer in `mock_data` */
+    size_t mock_seq_pos;
+} I2C_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_IT(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t options);
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Receive_IT(I2C_HandleTypeDef* hi2c, uint16_t address, uint8_t* data, uint16_t size, uint32_t options);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t address);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t address, uint32_t trials, uint32_t timeout);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef MOCK_STM32L4XX_HAL_TIM_H
+#define MOCK_STM32L4XX_HAL_TIM_H
+
+/* Not mocked, included by hal_target_stm32l4.h */
+#include "stm32l4xx.h"
+
+#endif
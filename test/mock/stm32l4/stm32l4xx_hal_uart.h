@@ -0,0 +1,63 @@
+#ifndef MOCK_STM32L4XX_HAL_UART_H
+#define MOCK_STM32L4XX_HAL_UART_H
+
+#include "stm32l4xx.h"
+
+#ifndef USE_HAL_UART_REGISTER_CALLBACKS
+#define USE_HAL_UART_REGISTER_CALLBACKS     (0)
+#endif
+
+/* Bytes of transmitted data kept by the mock for each handle */
+#ifndef MOCK_UART_CAPTURE_LEN
+#define MOCK_UART_CAPTURE_LEN   (4096)
+#endif
+
+typedef enum {
+    HAL_UART_STATE_RESET = 0x00,
+    HAL_UART_STATE_READY = 0x20,
+    HAL_UART_STATE_BUSY_TX = 0x21,
+    HAL_UART_STATE_BUSY_RX = 0x22
+} HAL_UART_StateTypeDef;
+
+#define HAL_UART_ERROR_NONE     (0x00u)
+#define HAL_UART_ERROR_ORE      (0x08u)
+#define HAL_UART_ERROR_DMA      (0x10u)
+
+#define UART_FLAG_RXNE          (0x20u)
+
+typedef struct __UART_HandleTypeDef {
+    USART_TypeDef* Instance;
+    const uint8_t* pTxBuffPtr;
+    uint16_t TxXferSize;
+    uint8_t* pRxBuffPtr;
+    uint16_t RxXferSize;
+    volatile uint16_t RxXferCount;
+    volatile HAL_UART_StateTypeDef gState;
+    volatile HAL_UART_StateTypeDef RxState;
+    volatile uint32_t ErrorCode;
+    /* Mock state of the reception mode started last */
+    uint8_t mock_rx_circular;
+    uint8_t mock_rx_to_idle;
+    /* Received bytes lost because no reception was in progress */
+    size_t mock_rx_dropped;
+    uint8_t mock_tx[MOCK_UART_CAPTURE_LEN];
+    size_t mock_tx_len;
+} UART_HandleTypeDef;
+
+#define __HAL_UART_GET_FLAG(huart, flag)    (0u)
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size);
+HAL_UART_StateTypeDef HAL_UART_GetState(UART_HandleTypeDef* huart);
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t size);
+
+#endif
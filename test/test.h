@@ -0,0 +1,25 @@
+#ifndef TEST_TEST_H
+#define TEST_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Minimal helpers for the host tests, a failed check exits with an error
+*/
+
+#define TEST_ASSERT(x)                                                          \
+    do {                                                                        \
+        if (!(x)) {                                                             \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            exit(1);                                                            \
+        }                                                                       \
+    } while (0)
+
+#define TEST_RUN(fn)                                                            \
+    do {                                                                        \
+        fn();                                                                   \
+        printf("%s passed\n", #fn);                                             \
+    } while (0)
+
+#endif
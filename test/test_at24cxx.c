@@ -0,0 +1,82 @@
+#include <string.h>
+#include "i2c_bus.h"
+#include "drivers/storage/at24cxx.h"
+#include "test.h"
+
+/**
+ * 24Cxx EEPROM driver (at24cxx.c) on the STM32L4 I2C bus and the I2C HAL mock
+*/
+
+static I2C_HandleTypeDef hi2c1 = {
+    .Instance = I2C1,
+    .mock_ack_addr = AT24CXX_I2C_ADDRESS << 1
+};
+
+static stm32_i2c_bus_t bus;
+static i2c_t i2c;
+static at24cxx_t eeprom;
+
+static void test_full_page_burst(void)
+{
+    uint8_t page[128];
+
+    for (size_t i = 0; i < sizeof(page); i++)
+        page[i] = (uint8_t)(i + 1);
+
+    /* Whole page of the largest part in one transaction with both address bytes */
+    TEST_ASSERT(at24cxx_open(&eeprom, &i2c, AT24CXX_I2C_ADDRESS, &at24c512) == STATUS_OK);
+    hi2c1.mock_transactions = 0;
+    TEST_ASSERT(at24cxx_write(&eeprom, 0x0100, page, sizeof(page)) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_transactions == 1 && hi2c1.mock_data_len == 2 + sizeof(page));
+    TEST_ASSERT(hi2c1.mock_data[0] == 0x01 && hi2c1.mock_data[1] == 0x00);
+    TEST_ASSERT(memcmp(&hi2c1.mock_data[2], page, sizeof(page)) == 0);
+
+    /* Burst crossing a page is split at the page, with a poll before the second one */
+    TEST_ASSERT(at24cxx_sync(&eeprom) == STATUS_OK);
+    hi2c1.mock_transactions = 0;
+    TEST_ASSERT(at24cxx_write(&eeprom, 0x0140, page, sizeof(page)) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_transactions == 3 && hi2c1.mock_data_len == 2 + 0x40);
+}
+
+static void test_poll_bypasses_retry(void)
+{
+    static const i2c_retry_policy_t policy = { .tries = 3, .fail_fast_after = 2 };
+    i2c_retry_stats_t stats;
+    uint8_t data[4] = { 1, 2, 3, 4 };
+
+    TEST_ASSERT(at24cxx_open(&eeprom, &i2c, AT24CXX_I2C_ADDRESS, &at24c64) == STATUS_OK);
+    TEST_ASSERT(i2c_set_retry_policy(&i2c, &policy) == STATUS_OK);
+
+    /* Write cycle lasts for 5 polls, each one is a single bus transaction */
+    hi2c1.mock_write_cycle = 5;
+    TEST_ASSERT(at24cxx_write(&eeprom, 0, data, sizeof(data)) == STATUS_OK);
+    hi2c1.mock_write_cycle = 0;
+    hi2c1.mock_transactions = 0;
+    TEST_ASSERT(at24cxx_sync(&eeprom) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_transactions == 6);
+
+    /* Polls are not counted as failed transactions of the bus */
+    i2c_get_retry_stats(&i2c, &stats);
+    TEST_ASSERT(stats.failures == 0 && stats.retries == 0 && stats.fail_fast == 0);
+
+    TEST_ASSERT(i2c_set_retry_policy(&i2c, NULL) == STATUS_OK);
+}
+
+static void test_reject_large_pages(void)
+{
+    static const at24cxx_model_t large = { .size = 131072, .page_size = 256, .addr_len = 2 };
+
+    TEST_ASSERT(at24cxx_open(&eeprom, &i2c, AT24CXX_I2C_ADDRESS, &large) == STATUS_ERROR);
+}
+
+int main(void)
+{
+    TEST_ASSERT(stm32_i2c_bus_init(&bus, &hi2c1) == STATUS_OK);
+    TEST_ASSERT(i2c_open(&i2c, &stm32_i2c_ops, &bus) == STATUS_OK);
+
+    TEST_RUN(test_full_page_burst);
+    TEST_RUN(test_poll_bypasses_retry);
+    TEST_RUN(test_reject_large_pages);
+
+    return 0;
+}
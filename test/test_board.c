@@ -0,0 +1,156 @@
+#include <string.h>
+#include <pthread.h>
+#include "drivers/board.h"
+#include "test.h"
+
+/**
+ * Board bring-up (board.c) on fake buses which log the probed devices
+ *
+ * @note Built once with the default coroutine lanes and once with `test/board_lane_threads.h`,
+ * which fails to start the first lane thread
+*/
+
+#define ADDR_ABSENT     (0x7f)
+#define PROBES_MAX      (16)
+
+static status_t fake_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte);
+static status_t fake_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte);
+static status_t fake_dev_probe(void* context, uint8_t addr);
+static status_t fake_ch_select(void* context, i2c_mux_ch_t ch);
+static status_t fake_mux_open(i2c_mux_t* mux, i2c_t* in_bus);
+
+static i2c_ops_t fake_ops = {
+    .write = fake_write,
+    .read = fake_read,
+    .dev_probe = fake_dev_probe
+};
+static i2c_mux_ops_t fake_mux_ops = { fake_ch_select };
+
+#define BOARD_BUSES(X)                                          \
+    X(bus_a, &fake_ops, "a")                                    \
+    X(bus_b, &fake_ops, "b")
+
+#define BOARD_MUXES(X)                                          \
+    X(mux_a, bus_a, &fake_mux_open)
+
+#define BOARD_MUX_CHANNELS(X)                                   \
+    X(bus_a0, mux_a, I2C_MUX_CH_0)                              \
+    X(bus_a1, mux_a, I2C_MUX_CH_1)
+
+#define BOARD_DEVICES(X)                                        \
+    X(dev_a1, bus_a1, 0x21, NULL, NULL)                         \
+    X(dev_a, bus_a, 0x10, NULL, NULL)                           \
+    X(dev_a0, bus_a0, 0x20, NULL, NULL)                         \
+    X(dev_b, bus_b, 0x10, NULL, NULL)                           \
+    X(dev_b_absent, bus_b, ADDR_ABSENT, NULL, NULL)
+
+BOARD_DEFINE(board, BOARD_BUSES, BOARD_MUXES, BOARD_MUX_CHANNELS, BOARD_DEVICES);
+
+/* Probes as bus name and address, in order */
+static pthread_mutex_t probes_lock = PTHREAD_MUTEX_INITIALIZER;
+static char probes[PROBES_MAX][8];
+static size_t n_probes;
+
+static status_t fake_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    UNUSED(context);
+    UNUSED(addr);
+    UNUSED(data);
+    UNUSED(nbyte);
+
+    return STATUS_OK;
+}
+
+static status_t fake_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    UNUSED(context);
+    UNUSED(addr);
+
+    memset(data, 0, nbyte);
+    return STATUS_OK;
+}
+
+static status_t fake_dev_probe(void* context, uint8_t addr)
+{
+    pthread_mutex_lock(&probes_lock);
+    TEST_ASSERT(n_probes < PROBES_MAX);
+    snprintf(probes[n_probes++], sizeof(probes[0]), "%s%02x", (const char*)context, addr);
+    pthread_mutex_unlock(&probes_lock);
+
+    return addr == ADDR_ABSENT ? STATUS_ERROR : STATUS_OK;
+}
+
+static status_t fake_ch_select(void* context, i2c_mux_ch_t ch)
+{
+    UNUSED(context);
+    UNUSED(ch);
+
+    return STATUS_OK;
+}
+
+static status_t fake_mux_open(i2c_mux_t* mux, i2c_t* in_bus)
+{
+    return i2c_mux_open(mux, in_bus, 2, &fake_mux_ops, NULL);
+}
+
+/* Required by the PC target header */
+int socket_write(socket_periph_t periph, uint8_t id, const void* data, size_t len)
+{
+    UNUSED(periph);
+    UNUSED(id);
+    UNUSED(data);
+
+    return (int)len;
+}
+
+/* Lanes have no delays, there is no timer wheel */
+void timer_period_isr(hal_timer_t timer)
+{
+    UNUSED(timer);
+}
+
+#ifdef BOARD_LANE_START
+static uint32_t lane_starts;
+
+int board_test_lane_start(void* (*fn)(void*), void* lane)
+{
+    pthread_t thread;
+
+    /* First lane runs in the calling context */
+    if (lane_starts++ == 0)
+        return -1;
+
+    if (pthread_create(&thread, NULL, fn, lane) != 0)
+        return -1;
+
+    return pthread_detach(thread);
+}
+#endif
+
+static void test_bring_up(void)
+{
+    TEST_ASSERT(board_init(&board) == STATUS_ERROR);
+
+    TEST_ASSERT(board_get_status(&board, &dev_a) == STATUS_OK);
+    TEST_ASSERT(board_get_status(&board, &dev_a0) == STATUS_OK);
+    TEST_ASSERT(board_get_status(&board, &dev_a1) == STATUS_OK);
+    TEST_ASSERT(board_get_status(&board, &dev_b) == STATUS_OK);
+    TEST_ASSERT(board_get_status(&board, &dev_b_absent) == STATUS_ERROR);
+    TEST_ASSERT(n_probes == 5);
+
+#ifdef BOARD_LANE_START
+    TEST_ASSERT(lane_starts == 2);
+#else
+    /* Lanes take turns device by device, each lane in channel order */
+    static const char* expected[] = { "a10", "b10", "a20", "b7f", "a21" };
+    for (size_t i = 0; i < n_probes; i++)
+        TEST_ASSERT(strcmp(probes[i], expected[i]) == 0);
+#endif
+}
+
+int main(void)
+{
+    TEST_RUN(test_bring_up);
+
+    return 0;
+}
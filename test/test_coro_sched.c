@@ -0,0 +1,158 @@
+#include "drivers/coro_sched.h"
+#include "test.h"
+
+/**
+ * Coroutine scheduler (coro_sched.c) on the PC target, without a timer wheel
+*/
+
+typedef struct {
+    coro_task_t task;
+    coro_completion_t done;
+    coro_task_t* peer;
+    uint32_t runs;
+    status_t status;
+} worker_t;
+
+static coro_sched_t sched;
+static worker_t a, b;
+
+/* Required by the PC target header */
+int socket_write(socket_periph_t periph, uint8_t id, const void* data, size_t len)
+{
+    UNUSED(periph);
+    UNUSED(id);
+    UNUSED(data);
+
+    return (int)len;
+}
+
+/* Delays are not used, there is no timer wheel */
+void timer_period_isr(hal_timer_t timer)
+{
+    UNUSED(timer);
+}
+
+static status_t start_failing(void)
+{
+    return STATUS_ERROR;
+}
+
+static coro_status_t delay_zero_run(coro_task_t* task)
+{
+    worker_t* w = CORO_TASK_ENTRY(task, worker_t, task);
+
+    CORO_BEGIN(&task->coro);
+    for (;;) {
+        w->runs++;
+        CORO_DELAY(task, 0);
+    }
+    CORO_END(&task->coro);
+}
+
+static coro_status_t failing_op_run(coro_task_t* task)
+{
+    worker_t* w = CORO_TASK_ENTRY(task, worker_t, task);
+
+    CORO_BEGIN(&task->coro);
+    for (;;) {
+        w->runs++;
+        CORO_AWAIT_OP(task, &w->done, start_failing());
+        w->status = coro_completion_status(&w->done);
+    }
+    CORO_END(&task->coro);
+}
+
+/**
+ * Wakes its peer on every run
+*/
+static coro_status_t ping_pong_run(coro_task_t* task)
+{
+    worker_t* w = CORO_TASK_ENTRY(task, worker_t, task);
+
+    w->runs++;
+    coro_task_wake(w->peer);
+
+    return CORO_WAITING;
+}
+
+static coro_status_t yield_run(coro_task_t* task)
+{
+    worker_t* w = CORO_TASK_ENTRY(task, worker_t, task);
+
+    CORO_BEGIN(&task->coro);
+    while (w->runs < 3) {
+        w->runs++;
+        CORO_YIELD(&task->coro);
+    }
+    CORO_END(&task->coro);
+}
+
+static void reset(void)
+{
+    a = (worker_t){ 0 };
+    b = (worker_t){ 0 };
+    TEST_ASSERT(coro_sched_init(&sched, NULL) == STATUS_OK);
+}
+
+static void test_delay_zero(void)
+{
+    reset();
+    TEST_ASSERT(coro_task_start(&sched, &a.task, delay_zero_run) == STATUS_OK);
+
+    /* Each poll runs the task once, the delay ends on the next poll */
+    for (uint32_t i = 1; i <= 5; i++) {
+        TEST_ASSERT(coro_sched_poll(&sched) == 1);
+        TEST_ASSERT(a.runs == i);
+    }
+}
+
+static void test_failing_op(void)
+{
+    reset();
+    TEST_ASSERT(coro_task_start(&sched, &a.task, failing_op_run) == STATUS_OK);
+
+    TEST_ASSERT(coro_sched_poll(&sched) == 1);
+    TEST_ASSERT(a.runs == 1 && a.status == STATUS_OK);
+    TEST_ASSERT(coro_sched_poll(&sched) == 1);
+    TEST_ASSERT(a.runs == 2 && a.status == STATUS_ERROR);
+}
+
+static void test_ping_pong(void)
+{
+    reset();
+    a.peer = &b.task;
+    b.peer = &a.task;
+    TEST_ASSERT(coro_task_start(&sched, &a.task, ping_pong_run) == STATUS_OK);
+    TEST_ASSERT(coro_task_start(&sched, &b.task, ping_pong_run) == STATUS_OK);
+
+    /* Both started, then the task woken by the other one waits for the next poll */
+    TEST_ASSERT(coro_sched_poll(&sched) == 2);
+    for (uint32_t i = 1; i <= 4; i++) {
+        TEST_ASSERT(coro_sched_poll(&sched) == 1);
+        TEST_ASSERT(a.runs + b.runs == 2 + i);
+    }
+}
+
+static void test_yield(void)
+{
+    reset();
+    TEST_ASSERT(coro_task_start(&sched, &a.task, yield_run) == STATUS_OK);
+
+    for (uint32_t i = 1; i <= 3; i++) {
+        TEST_ASSERT(coro_sched_poll(&sched) == 1);
+        TEST_ASSERT(a.runs == i && !coro_task_done(&a.task));
+    }
+    TEST_ASSERT(coro_sched_poll(&sched) == 1);
+    TEST_ASSERT(coro_task_done(&a.task));
+    TEST_ASSERT(coro_sched_poll(&sched) == 0);
+}
+
+int main(void)
+{
+    TEST_RUN(test_delay_zero);
+    TEST_RUN(test_failing_op);
+    TEST_RUN(test_ping_pong);
+    TEST_RUN(test_yield);
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <pthread.h>
+#include <sched.h>
+#include "common/event.h"
+#include "test.h"
+
+/**
+ * Event loop (common/event.c) with producer threads in place of ISRs
+*/
+
+#define PRODUCERS       (4)
+#define PRODUCER_EVENTS (20000u)
+/* Producers sharing each queue */
+#define PER_QUEUE       (2)
+#define ORDER_MAX       (64)
+
+static event_loop_t loop;
+
+/* Next event expected from each producer */
+static uint32_t next_seq[PRODUCERS];
+static atomic_uint producers_done;
+static uint32_t producer_drops[PRODUCERS];
+
+/* Dispatch order of the single thread tests */
+static uint32_t order[ORDER_MAX];
+static size_t n_order;
+
+static void producer_handler(void* arg, uint32_t data)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+
+    /* Each producer's events arrive once and in order */
+    TEST_ASSERT(id < PRODUCERS && data == next_seq[id]);
+    next_seq[id]++;
+}
+
+/**
+ * Posts its events in order to a queue shared with another producer, a post to a full
+ * queue is repeated
+*/
+static void* producer(void* arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t seq = 0; seq < PRODUCER_EVENTS; seq++) {
+        while (event_post(&loop, (uint8_t)(id / PER_QUEUE), producer_handler, arg, seq) != STATUS_OK) {
+            producer_drops[id]++;
+            sched_yield();
+        }
+    }
+
+    atomic_fetch_add(&producers_done, 1);
+    return NULL;
+}
+
+static void record_handler(void* arg, uint32_t data)
+{
+    UNUSED(arg);
+
+    TEST_ASSERT(n_order < ORDER_MAX);
+    order[n_order++] = data;
+}
+
+/**
+ * First low priority event posts a high priority one
+*/
+static void posting_handler(void* arg, uint32_t data)
+{
+    record_handler(arg, data);
+    if (data == 100)
+        TEST_ASSERT(event_post(&loop, 0, record_handler, NULL, 0) == STATUS_OK);
+}
+
+static void test_multi_producer(void)
+{
+    pthread_t threads[PRODUCERS];
+    event_stats_t stats;
+
+    TEST_ASSERT(event_loop_init(&loop) == STATUS_OK);
+    for (uint32_t i = 0; i < PRODUCERS; i++)
+        TEST_ASSERT(pthread_create(&threads[i], NULL, producer, (void*)(uintptr_t)i) == 0);
+
+    /* Producers may still be publishing when the last one is done, poll once more after */
+    while (atomic_load(&producers_done) != PRODUCERS) {
+        if (event_loop_poll(&loop) == 0)
+            sched_yield();
+    }
+    for (uint32_t i = 0; i < PRODUCERS; i++)
+        pthread_join(threads[i], NULL);
+    event_loop_poll(&loop);
+
+    for (uint32_t i = 0; i < PRODUCERS; i++)
+        TEST_ASSERT(next_seq[i] == PRODUCER_EVENTS);
+
+    for (uint32_t i = 0; i < PRODUCERS; i += PER_QUEUE) {
+        uint32_t drops = 0;
+
+        for (uint32_t j = i; j < i + PER_QUEUE; j++)
+            drops += producer_drops[j];
+
+        /* Full queue is counted once per failed post */
+        TEST_ASSERT(event_loop_get_stats(&loop, (uint8_t)(i / PER_QUEUE), &stats) == STATUS_OK);
+        TEST_ASSERT(stats.depth == 0 && stats.dispatched == PER_QUEUE * PRODUCER_EVENTS);
+        TEST_ASSERT(stats.dropped == drops);
+        TEST_ASSERT(stats.max_depth <= EVENT_QUEUE_LEN);
+    }
+}
+
+static void test_priority_batch(void)
+{
+    TEST_ASSERT(event_loop_init(&loop) == STATUS_OK);
+    n_order = 0;
+
+    /* Higher priority first, each queue in order */
+    TEST_ASSERT(event_post(&loop, 1, record_handler, NULL, 10) == STATUS_OK);
+    TEST_ASSERT(event_post(&loop, 2, record_handler, NULL, 20) == STATUS_OK);
+    TEST_ASSERT(event_post(&loop, 0, record_handler, NULL, 1) == STATUS_OK);
+    TEST_ASSERT(event_post(&loop, 1, record_handler, NULL, 11) == STATUS_OK);
+    TEST_ASSERT(event_post(&loop, 0, record_handler, NULL, 2) == STATUS_OK);
+    TEST_ASSERT(event_loop_poll(&loop) == 5);
+
+    static const uint32_t expected[] = { 1, 2, 10, 11, 20 };
+    for (size_t i = 0; i < 5; i++)
+        TEST_ASSERT(order[i] == expected[i]);
+
+    /* Higher priority event posted by a handler waits only for the rest of the batch */
+    n_order = 0;
+    for (uint32_t i = 0; i < 2 * EVENT_BATCH + 2; i++)
+        TEST_ASSERT(event_post(&loop, 1, posting_handler, NULL, 100 + i) == STATUS_OK);
+    TEST_ASSERT(event_loop_poll(&loop) == 2 * EVENT_BATCH + 3);
+
+    for (uint32_t i = 0; i < EVENT_BATCH; i++)
+        TEST_ASSERT(order[i] == 100 + i);
+    TEST_ASSERT(order[EVENT_BATCH] == 0);
+    for (uint32_t i = EVENT_BATCH; i < 2 * EVENT_BATCH + 2; i++)
+        TEST_ASSERT(order[i + 1] == 100 + i);
+
+    TEST_ASSERT(event_loop_poll(&loop) == 0);
+}
+
+static void test_drops(void)
+{
+    event_stats_t stats;
+
+    TEST_ASSERT(event_loop_init(&loop) == STATUS_OK);
+    n_order = 0;
+
+    TEST_ASSERT(event_post(&loop, EVENT_PRIORITIES, record_handler, NULL, 0) == STATUS_ERROR);
+    TEST_ASSERT(event_post(&loop, 0, NULL, NULL, 0) == STATUS_ERROR);
+
+    for (uint32_t i = 0; i < EVENT_QUEUE_LEN; i++)
+        TEST_ASSERT(event_post(&loop, 2, record_handler, NULL, i) == STATUS_OK);
+    for (uint32_t i = 0; i < 5; i++)
+        TEST_ASSERT(event_post(&loop, 2, record_handler, NULL, 0) == STATUS_ERROR);
+
+    /* Invalid posts are not counted, other priorities are not affected */
+    TEST_ASSERT(event_loop_get_stats(&loop, 2, &stats) == STATUS_OK);
+    TEST_ASSERT(stats.depth == EVENT_QUEUE_LEN && stats.max_depth == EVENT_QUEUE_LEN && stats.dropped == 5);
+    TEST_ASSERT(event_loop_get_stats(&loop, 0, &stats) == STATUS_OK);
+    TEST_ASSERT(stats.dropped == 0);
+    TEST_ASSERT(event_post(&loop, 1, record_handler, NULL, 0) == STATUS_OK);
+
+    /* Dropped events are not dispatched */
+    n_order = 0;
+    TEST_ASSERT(event_loop_poll(&loop) == EVENT_QUEUE_LEN + 1);
+    TEST_ASSERT(event_loop_get_stats(&loop, 2, &stats) == STATUS_OK);
+    TEST_ASSERT(stats.depth == 0 && stats.dispatched == EVENT_QUEUE_LEN);
+
+    event_loop_reset_stats(&loop);
+    TEST_ASSERT(event_loop_get_stats(&loop, 2, &stats) == STATUS_OK);
+    TEST_ASSERT(stats.max_depth == 0 && stats.dropped == 0 && stats.dispatched == 0);
+    TEST_ASSERT(event_loop_get_stats(&loop, EVENT_PRIORITIES, &stats) == STATUS_ERROR);
+}
+
+int main(void)
+{
+    TEST_RUN(test_multi_producer);
+    TEST_RUN(test_priority_batch);
+    TEST_RUN(test_drops);
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "drivers/i2c_queue.h"
+#include "test.h"
+
+/**
+ * Shared I2C queue (i2c_queue.c) on a fake bus which logs the transactions
+ *
+ * @note Built with `test/i2c_queue_hooks.h`, callers only wait and the test thread
+ * executes the queue, so the transactions of several callers can be queued first
+*/
+
+#define LOG_MAX         (16)
+#define PRIO_HIGH       (0)
+#define PRIO_LOW        (1)
+#define CHUNK           (4)
+
+typedef struct job {
+    i2c_t* bus;
+    char op;
+    uint8_t addr;
+    uint8_t data[16];
+    size_t nbyte;
+    status_t status;
+    pthread_t thread;
+} job_t;
+
+static status_t fake_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte);
+static status_t fake_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte);
+static status_t fake_dev_probe(void* context, uint8_t addr);
+
+static i2c_ops_t fake_ops = {
+    .write = fake_write,
+    .read = fake_read,
+    .dev_probe = fake_dev_probe
+};
+
+static i2c_t bus;
+static i2c_queue_t queue;
+static i2c_t low, high, low_chunked;
+static i2c_queue_chunked_t chunked;
+
+/* Transactions on the fake bus as operation, address and length, in order */
+static char bus_log[LOG_MAX][12];
+static size_t n_log;
+/* Fake devices continue reading where the previous read stopped */
+static uint8_t read_pos[128];
+/* Number of the read call which fails, 0 for none */
+static uint32_t fail_read;
+static uint32_t reads;
+/* Called by the fake bus after a read */
+static void (*on_read)(void);
+
+static atomic_uint waiting;
+static _Thread_local uint8_t counted;
+
+void i2c_queue_test_wait(void)
+{
+    if (!counted) {
+        counted = 1;
+        atomic_fetch_add(&waiting, 1);
+    }
+    sched_yield();
+}
+
+static void bus_log_add(char op, uint8_t addr, size_t nbyte)
+{
+    TEST_ASSERT(n_log < LOG_MAX);
+    snprintf(bus_log[n_log++], sizeof(bus_log[0]), "%c%02x:%u", op, addr, (unsigned)nbyte);
+}
+
+static status_t fake_write(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    UNUSED(context);
+    UNUSED(data);
+
+    bus_log_add('w', addr, nbyte);
+    return STATUS_OK;
+}
+
+static status_t fake_read(void* context, uint8_t addr, uint8_t* data, size_t nbyte)
+{
+    UNUSED(context);
+
+    bus_log_add('r', addr, nbyte);
+    for (size_t i = 0; i < nbyte; i++)
+        data[i] = read_pos[addr]++;
+
+    if (on_read != NULL)
+        on_read();
+
+    return ++reads == fail_read ? STATUS_ERROR : STATUS_OK;
+}
+
+static status_t fake_dev_probe(void* context, uint8_t addr)
+{
+    UNUSED(context);
+
+    bus_log_add('p', addr, 0);
+    return STATUS_OK;
+}
+
+static void* job_run(void* arg)
+{
+    job_t* job = (job_t*)arg;
+
+    if (job->op == 'w')
+        job->status = i2c_write(job->bus, job->addr, job->data, job->nbyte);
+    else if (job->op == 'r')
+        job->status = i2c_read(job->bus, job->addr, job->data, job->nbyte);
+    else
+        job->status = i2c_dev_probe(job->bus, job->addr);
+
+    return NULL;
+}
+
+/**
+ * Submit the job from a new thread and wait until it is queued
+*/
+static void job_start(job_t* job)
+{
+    unsigned int queued = atomic_load(&waiting) + 1;
+
+    TEST_ASSERT(pthread_create(&job->thread, NULL, job_run, job) == 0);
+    while (atomic_load(&waiting) != queued)
+        sched_yield();
+}
+
+static void expect_log(const char* const* expected, size_t count)
+{
+    TEST_ASSERT(n_log == count);
+    for (size_t i = 0; i < count; i++)
+        TEST_ASSERT(strcmp(bus_log[i], expected[i]) == 0);
+}
+
+static void reset(void)
+{
+    TEST_ASSERT(i2c_open(&bus, &fake_ops, NULL) == STATUS_OK);
+    TEST_ASSERT(i2c_queue_open(&queue, &bus) == STATUS_OK);
+    TEST_ASSERT(i2c_queue_bus_open_priority(&queue, &high, PRIO_HIGH) == STATUS_OK);
+    TEST_ASSERT(i2c_queue_bus_open_priority(&queue, &low, PRIO_LOW) == STATUS_OK);
+    TEST_ASSERT(i2c_queue_bus_open_chunked(&queue, &low_chunked, PRIO_LOW, &chunked, CHUNK) == STATUS_OK);
+
+    memset(read_pos, 0, sizeof(read_pos));
+    n_log = 0;
+    fail_read = 0;
+    reads = 0;
+    on_read = NULL;
+}
+
+static void test_class_order(void)
+{
+    static job_t read_low = { .bus = &low, .op = 'r', .addr = 0x10, .nbyte = 10 };
+    static job_t write_low = { .bus = &low, .op = 'w', .addr = 0x11, .nbyte = 2 };
+    static job_t probe_high = { .bus = &high, .op = 'p', .addr = 0x20 };
+    static const char* expected[] = { "p20:0", "r10:10", "w11:2" };
+
+    reset();
+    job_start(&read_low);
+    job_start(&write_low);
+    job_start(&probe_high);
+    TEST_ASSERT(i2c_queue_process(&queue) == STATUS_OK);
+
+    pthread_join(read_low.thread, NULL);
+    pthread_join(write_low.thread, NULL);
+    pthread_join(probe_high.thread, NULL);
+
+    /* Higher class first, then the lower one in order, a read of an unchunked bus is not split */
+    expect_log(expected, 3);
+    TEST_ASSERT(read_low.status == STATUS_OK && write_low.status == STATUS_OK && probe_high.status == STATUS_OK);
+}
+
+static job_t preempt_high = { .bus = &high, .op = 'p', .addr = 0x20 };
+
+/**
+ * High priority probe arrives while the first chunk is on the bus
+*/
+static void preempt_first_chunk(void)
+{
+    on_read = NULL;
+    job_start(&preempt_high);
+}
+
+static void test_chunk_preemption(void)
+{
+    static job_t read_chunked = { .bus = &low_chunked, .op = 'r', .addr = 0x30, .nbyte = 10 };
+    static const char* expected[] = { "r30:4", "p20:0", "r30:4", "r30:2" };
+    i2c_queue_stats_t stats;
+
+    reset();
+    on_read = preempt_first_chunk;
+    job_start(&read_chunked);
+    TEST_ASSERT(i2c_queue_process(&queue) == STATUS_OK);
+
+    pthread_join(read_chunked.thread, NULL);
+    pthread_join(preempt_high.thread, NULL);
+
+    /* Probe waits for one chunk instead of the whole read, the read continues after it */
+    expect_log(expected, 4);
+    TEST_ASSERT(read_chunked.status == STATUS_OK && preempt_high.status == STATUS_OK);
+    for (uint8_t i = 0; i < 10; i++)
+        TEST_ASSERT(read_chunked.data[i] == i);
+
+    TEST_ASSERT(i2c_queue_get_stats(&queue, PRIO_LOW, &stats) == STATUS_OK);
+    TEST_ASSERT(stats.transactions == 1 && stats.chunks == 3);
+}
+
+static void test_chunk_not_retried(void)
+{
+    static const i2c_retry_policy_t policy = { .tries = 3 };
+    static job_t read_chunked = { .bus = &low_chunked, .op = 'r', .addr = 0x30, .nbyte = 10 };
+    static job_t read_low = { .bus = &low, .op = 'r', .addr = 0x10, .nbyte = 10 };
+    static const char* expected_chunked[] = { "r30:4", "r30:4" };
+    static const char* expected_low[] = { "r10:10", "r10:10" };
+    i2c_retry_stats_t stats;
+
+    /* Second chunk fails, retrying it would read the bytes after it */
+    reset();
+    TEST_ASSERT(i2c_set_retry_policy(&bus, &policy) == STATUS_OK);
+    fail_read = 2;
+    job_start(&read_chunked);
+    TEST_ASSERT(i2c_queue_process(&queue) == STATUS_OK);
+    pthread_join(read_chunked.thread, NULL);
+
+    expect_log(expected_chunked, 2);
+    TEST_ASSERT(read_chunked.status == STATUS_ERROR);
+    i2c_get_retry_stats(&bus, &stats);
+    TEST_ASSERT(stats.retries == 0 && stats.failures == 1);
+
+    /* Whole reads keep the retry policy of the bus */
+    reset();
+    TEST_ASSERT(i2c_set_retry_policy(&bus, &policy) == STATUS_OK);
+    fail_read = 1;
+    job_start(&read_low);
+    TEST_ASSERT(i2c_queue_process(&queue) == STATUS_OK);
+    pthread_join(read_low.thread, NULL);
+
+    expect_log(expected_low, 2);
+    TEST_ASSERT(read_low.status == STATUS_OK);
+    i2c_get_retry_stats(&bus, &stats);
+    TEST_ASSERT(stats.retries == 1 && stats.failures == 0);
+}
+
+int main(void)
+{
+    TEST_RUN(test_class_order);
+    TEST_RUN(test_chunk_preemption);
+    TEST_RUN(test_chunk_not_retried);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "adc_capture.h"
+#include "test.h"
+
+/**
+ * ADC capture files of the PC target (adc_capture.c), recorded and played back
+ *
+ * @note Built with small blocks, `ADC_CAPTURE_BLOCK_LEN` is 4096 bytes (2048 samples)
+*/
+
+#define BLOCK_SAMPLES   (ADC_CAPTURE_BLOCK_LEN / sizeof(uint16_t))
+#define FILE_SAMPLES    (2 * BLOCK_SAMPLES)
+#define SAMPLE_RATE     (1000)
+#define PLAYED_LEN      (sizeof(played) / sizeof(played[0]))
+
+static char dir[] = "/tmp/test_adc_capture_XXXXXX";
+static char prefix[64];
+static const uint8_t channels[2] = { 3, 4 };
+
+static uint16_t samples[4 * FILE_SAMPLES];
+static uint16_t played[4 * FILE_SAMPLES];
+
+static adc_capture_config_t config(uint32_t max_files)
+{
+    adc_capture_config_t config = {
+        .path_prefix = prefix,
+        .channels = channels,
+        .n_channels = 2,
+        .sample_rate = SAMPLE_RATE,
+        .file_samples = FILE_SAMPLES,
+        .max_files = max_files
+    };
+
+    return config;
+}
+
+/**
+ * Record test samples `first` to `first` + `count` in chunks of `chunk`
+*/
+static void record(adc_capture_t* capture, size_t first, size_t count, size_t chunk)
+{
+    for (size_t i = 0; i < count; i += chunk)
+        TEST_ASSERT(adc_capture_write(capture, &samples[first + i], chunk < count - i ? chunk : count - i) == STATUS_OK);
+}
+
+static void test_rotate_and_play(void)
+{
+    adc_capture_t capture;
+    adc_capture_reader_t reader;
+    adc_capture_config_t cfg = config(0);
+    size_t count = 3 * FILE_SAMPLES + 100;
+
+    TEST_ASSERT(adc_capture_open(&capture, &cfg) == STATUS_OK);
+    record(&capture, 0, count, 1000);
+    TEST_ASSERT(adc_capture_close(&capture) == STATUS_OK);
+
+    /* Prepared file after the last one is removed */
+    char path[128];
+    snprintf(path, sizeof(path), "%s_0004.adc", prefix);
+    TEST_ASSERT(access(path, F_OK) != 0);
+
+    TEST_ASSERT(adc_capture_reader_open(&reader, prefix, 0) == STATUS_OK);
+    const adc_capture_header_t* header = adc_capture_reader_header(&reader);
+    TEST_ASSERT(header->file_index == 0 && header->n_channels == 2 && header->channels[1] == 4);
+    TEST_ASSERT(header->sample_rate == SAMPLE_RATE);
+    uint64_t start_ns = header->recording_start_ns;
+
+    TEST_ASSERT(adc_capture_read(&reader, played, FILE_SAMPLES + 10) == FILE_SAMPLES + 10);
+    header = adc_capture_reader_header(&reader);
+    TEST_ASSERT(header->file_index == 1 && header->first_sample == FILE_SAMPLES);
+    /* File starts after FILE_SAMPLES / 2 frames */
+    TEST_ASSERT(header->file_start_ns == start_ns + (uint64_t)FILE_SAMPLES / 2 * 1000000000ull / SAMPLE_RATE);
+
+    TEST_ASSERT(adc_capture_read(&reader, &played[FILE_SAMPLES + 10], PLAYED_LEN - FILE_SAMPLES - 10)
+        == count - FILE_SAMPLES - 10);
+    TEST_ASSERT(memcmp(played, samples, count * sizeof(uint16_t)) == 0);
+    TEST_ASSERT(adc_capture_read(&reader, played, 1) == 0);
+    TEST_ASSERT(adc_capture_reader_close(&reader) == STATUS_OK);
+}
+
+static void test_reuse_files(void)
+{
+    adc_capture_t capture;
+    adc_capture_reader_t reader;
+    adc_capture_config_t cfg = config(3);
+    size_t count = 4 * FILE_SAMPLES - 100;
+
+    TEST_ASSERT(adc_capture_open(&capture, &cfg) == STATUS_OK);
+    record(&capture, 0, count, 3000);
+    TEST_ASSERT(adc_capture_close(&capture) == STATUS_OK);
+
+    /* Files 0 and 1 are overwritten by 3 and by the prepared 4 removed at close, 2 is the oldest */
+    TEST_ASSERT(adc_capture_reader_open(&reader, prefix, 3) == STATUS_OK);
+    TEST_ASSERT(adc_capture_reader_header(&reader)->file_index == 2);
+    TEST_ASSERT(adc_capture_read(&reader, played, PLAYED_LEN) == count - 2 * FILE_SAMPLES);
+    TEST_ASSERT(memcmp(played, &samples[2 * FILE_SAMPLES], (count - 2 * FILE_SAMPLES) * sizeof(uint16_t)) == 0);
+    TEST_ASSERT(adc_capture_reader_close(&reader) == STATUS_OK);
+}
+
+static void test_play_while_recording(void)
+{
+    adc_capture_t capture;
+    adc_capture_reader_t reader;
+    adc_capture_config_t cfg = config(0);
+
+    TEST_ASSERT(adc_capture_open(&capture, &cfg) == STATUS_OK);
+    record(&capture, 0, BLOCK_SAMPLES + 10, 500);
+    TEST_ASSERT(adc_capture_reader_open(&reader, prefix, 0) == STATUS_OK);
+
+    /* Only completed blocks are played */
+    TEST_ASSERT(adc_capture_read(&reader, played, PLAYED_LEN) == BLOCK_SAMPLES);
+
+    /* Playback follows into the next file once the current one is full */
+    record(&capture, BLOCK_SAMPLES + 10, FILE_SAMPLES, 500);
+    TEST_ASSERT(adc_capture_read(&reader, &played[BLOCK_SAMPLES], PLAYED_LEN - BLOCK_SAMPLES) == FILE_SAMPLES);
+    TEST_ASSERT(adc_capture_reader_header(&reader)->file_index == 1);
+    TEST_ASSERT(memcmp(played, samples, (BLOCK_SAMPLES + FILE_SAMPLES) * sizeof(uint16_t)) == 0);
+
+    TEST_ASSERT(adc_capture_close(&capture) == STATUS_OK);
+    TEST_ASSERT(adc_capture_read(&reader, played, PLAYED_LEN) == 10);
+    TEST_ASSERT(adc_capture_reader_close(&reader) == STATUS_OK);
+}
+
+int main(void)
+{
+    char command[128];
+
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++)
+        samples[i] = (uint16_t)(i * 7 + 1);
+
+    TEST_ASSERT(mkdtemp(dir) != NULL);
+
+    snprintf(prefix, sizeof(prefix), "%s/all", dir);
+    TEST_RUN(test_rotate_and_play);
+    snprintf(prefix, sizeof(prefix), "%s/reuse", dir);
+    TEST_RUN(test_reuse_files);
+    snprintf(prefix, sizeof(prefix), "%s/live", dir);
+    TEST_RUN(test_play_while_recording);
+
+    snprintf(command, sizeof(command), "rm -r %s", dir);
+    TEST_ASSERT(system(command) == 0);
+
+    return 0;
+}
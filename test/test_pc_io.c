@@ -0,0 +1,170 @@
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "hal_io.h"
+#include "test.h"
+
+/**
+ * IO port of the PC target (hal_io.c) with stdin and stdout replaced by pipes
+*/
+
+#define TX_THREADS      (4)
+#define TX_MESSAGES     (50)
+/* Spans three output cells */
+#define TX_MESSAGE_LEN  (150)
+
+#define RX_LEN          (10000)
+/* Longest chunk the input thread passes to the callback */
+#define RX_CHUNK_MAX    (4096)
+
+static int input;
+
+static uint8_t rx_data[RX_LEN];
+static atomic_size_t rx_len;
+static atomic_size_t rx_longest;
+
+/* Required by the PC target header */
+int socket_write(socket_periph_t periph, uint8_t id, const void* data, size_t len)
+{
+    UNUSED(periph);
+    UNUSED(id);
+    UNUSED(data);
+
+    return (int)len;
+}
+
+/**
+ * Message `n` of thread `id`, every byte identifies the message
+*/
+static void tx_message(uint8_t* data, uint32_t id, uint32_t n)
+{
+    memset(data, (int)('A' + id), TX_MESSAGE_LEN);
+    data[0] = (uint8_t)n;
+}
+
+static void* tx_thread(void* arg)
+{
+    uint8_t data[TX_MESSAGE_LEN];
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t n = 0; n < TX_MESSAGES; n++) {
+        tx_message(data, id, n);
+        TEST_ASSERT(io_putdata(data, TX_MESSAGE_LEN) == HAL_STATUS_OK);
+    }
+
+    return NULL;
+}
+
+static void test_putdata_coalesced(void)
+{
+    static uint8_t output[TX_THREADS * TX_MESSAGES * TX_MESSAGE_LEN];
+    pthread_t threads[TX_THREADS];
+    uint32_t next[TX_THREADS] = { 0 };
+    int fd[2];
+
+    /* Whole output fits into the pipe, nothing reads it before the flush */
+    TEST_ASSERT(pipe(fd) == 0);
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    TEST_ASSERT(dup2(fd[1], STDOUT_FILENO) == STDOUT_FILENO);
+    close(fd[1]);
+
+    for (uint32_t i = 0; i < TX_THREADS; i++)
+        TEST_ASSERT(pthread_create(&threads[i], NULL, tx_thread, (void*)(uintptr_t)i) == 0);
+    for (uint32_t i = 0; i < TX_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    /* Flush returns only after the writer thread wrote everything */
+    TEST_ASSERT(io_flush() == HAL_STATUS_OK);
+    TEST_ASSERT(dup2(saved, STDOUT_FILENO) == STDOUT_FILENO);
+    close(saved);
+
+    size_t len = 0;
+    while (len < sizeof(output)) {
+        ssize_t n = read(fd[0], &output[len], sizeof(output) - len);
+        TEST_ASSERT(n > 0);
+        len += (size_t)n;
+    }
+    close(fd[0]);
+
+    /* Messages are never interleaved and each thread's messages keep their order */
+    for (size_t pos = 0; pos < len; pos += TX_MESSAGE_LEN) {
+        uint8_t expected[TX_MESSAGE_LEN];
+        uint32_t id = (uint32_t)(output[pos + 1] - 'A');
+
+        TEST_ASSERT(id < TX_THREADS);
+        tx_message(expected, id, next[id]++);
+        TEST_ASSERT(memcmp(&output[pos], expected, TX_MESSAGE_LEN) == 0);
+    }
+    for (uint32_t i = 0; i < TX_THREADS; i++)
+        TEST_ASSERT(next[i] == TX_MESSAGES);
+}
+
+static void rx_callback(uint8_t* data, uint16_t len)
+{
+    size_t pos = atomic_load(&rx_len);
+
+    if (len > atomic_load(&rx_longest))
+        atomic_store(&rx_longest, len);
+    if (pos + len <= RX_LEN)
+        memcpy(&rx_data[pos], data, len);
+    atomic_store(&rx_len, pos + len);
+}
+
+static void test_receive_callback_chunks(void)
+{
+    static uint8_t data[RX_LEN];
+
+    for (size_t i = 0; i < RX_LEN; i++)
+        data[i] = (uint8_t)(i * 7);
+
+    TEST_ASSERT(io_register_receive_callback(rx_callback) == HAL_STATUS_OK);
+    TEST_ASSERT(write(input, data, RX_LEN) == RX_LEN);
+
+    while (atomic_load(&rx_len) < RX_LEN)
+        usleep(1000);
+    TEST_ASSERT(io_register_receive_callback(NULL) == HAL_STATUS_OK);
+
+    /* Input larger than one read arrives in several chunks */
+    TEST_ASSERT(atomic_load(&rx_len) == RX_LEN);
+    TEST_ASSERT(atomic_load(&rx_longest) <= RX_CHUNK_MAX);
+    TEST_ASSERT(memcmp(rx_data, data, RX_LEN) == 0);
+
+    /* The ring is not used while the callback is registered */
+    TEST_ASSERT(ring_used(io_rx_ring()) == 0);
+}
+
+static void test_getdata_eof(void)
+{
+    uint8_t data[4];
+
+    TEST_ASSERT(io_rx_start() == HAL_STATUS_OK);
+    TEST_ASSERT(write(input, "abc", 3) == 3);
+    close(input);
+
+    TEST_ASSERT(io_getdata(data, 3) == HAL_STATUS_OK);
+    TEST_ASSERT(memcmp(data, "abc", 3) == 0);
+
+    /* Input thread reached the end of stdin, waiting would never end */
+    TEST_ASSERT(io_getdata(data, 1) == HAL_STATUS_ERROR);
+}
+
+int main(void)
+{
+    int fd[2];
+
+    TEST_ASSERT(pipe(fd) == 0);
+    TEST_ASSERT(dup2(fd[0], STDIN_FILENO) == STDIN_FILENO);
+    close(fd[0]);
+    input = fd[1];
+
+    /* A hang is a failure */
+    alarm(10);
+
+    TEST_RUN(test_putdata_coalesced);
+    TEST_RUN(test_receive_callback_chunks);
+    TEST_RUN(test_getdata_eof);
+
+    return 0;
+}
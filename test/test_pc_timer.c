@@ -0,0 +1,91 @@
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal_timer.h"
+#include "test.h"
+
+/**
+ * Timer of the PC target (hal_timer.c) against the host clock, with generous bounds
+*/
+
+#define FREQUENCY       (1000000u)
+#define LONG_PERIOD     (400000u)
+#define SHORT_PERIOD    (10000u)
+#define NS_PER_US       (1000ull)
+
+static hal_target_pc_timer_t timer = { .frequency = FREQUENCY };
+static atomic_uint expirations;
+static atomic_ullong first_expiry_ns;
+
+/* Required by the PC target header */
+int socket_write(socket_periph_t periph, uint8_t id, const void* data, size_t len)
+{
+    UNUSED(periph);
+    UNUSED(id);
+    UNUSED(data);
+
+    return (int)len;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void timer_period_isr(hal_timer_t t)
+{
+    TEST_ASSERT(t == &timer);
+
+    if (atomic_fetch_add(&expirations, 1) == 0)
+        atomic_store(&first_expiry_ns, now_ns());
+}
+
+static void test_period_change(void)
+{
+    TEST_ASSERT(timer_set_period(&timer, LONG_PERIOD) == HAL_STATUS_OK);
+    TEST_ASSERT(timer_clear(&timer) == HAL_STATUS_OK);
+    uint64_t start = now_ns();
+    TEST_ASSERT(timer_start(&timer) == HAL_STATUS_OK);
+
+    /* Shorter period while the clock thread waits for the long one */
+    usleep(SHORT_PERIOD / 4);
+    TEST_ASSERT(atomic_load(&expirations) == 0);
+    TEST_ASSERT(timer_set_period(&timer, SHORT_PERIOD) == HAL_STATUS_OK);
+
+    /* Counted from the start, not after the long period */
+    while (atomic_load(&expirations) == 0)
+        TEST_ASSERT(now_ns() - start < LONG_PERIOD * NS_PER_US / 2);
+    TEST_ASSERT(atomic_load(&first_expiry_ns) - start >= SHORT_PERIOD * NS_PER_US);
+}
+
+static void test_stop(void)
+{
+    TEST_ASSERT(timer_stop(&timer) == HAL_STATUS_OK);
+    timer_count_t count = timer_get_count(&timer);
+    unsigned int stopped = atomic_load(&expirations);
+
+    /* No expiry and no counting while stopped */
+    usleep(3 * SHORT_PERIOD);
+    TEST_ASSERT(atomic_load(&expirations) == stopped);
+    TEST_ASSERT(timer_get_count(&timer) == count && count < SHORT_PERIOD);
+
+    /* Continues from the stopped count */
+    TEST_ASSERT(timer_start(&timer) == HAL_STATUS_OK);
+    usleep(3 * SHORT_PERIOD);
+    TEST_ASSERT(atomic_load(&expirations) > stopped);
+    TEST_ASSERT(timer_stop(&timer) == HAL_STATUS_OK);
+}
+
+int main(void)
+{
+    /* A hang is a failure */
+    alarm(10);
+
+    TEST_RUN(test_period_change);
+    TEST_RUN(test_stop);
+
+    return 0;
+}
@@ -0,0 +1,250 @@
+#include <string.h>
+#include "hal_adc.h"
+#include "drivers/adc_stream.h"
+#include "mock_stm32l4.h"
+#include "test.h"
+
+/**
+ * ADC port of the STM32L4 target (hal_adc.c) on the ADC and DMA HAL mock,
+ * read through the circular stream driver
+ *
+ * @note Built once with `HAL_ADC_USE_REGISTER_CALLBACKS` and once with the ISR functions
+*/
+
+#define BUFFER_LEN      (8)
+
+static DMA_Channel_TypeDef dma_channel;
+
+static DMA_HandleTypeDef hdma = {
+    .Instance = &dma_channel,
+    .Init.Mode = DMA_CIRCULAR
+};
+
+static ADC_HandleTypeDef hadc1 = {
+    .Instance = ADC1,
+    .DMA_Handle = &hdma
+};
+
+static uint16_t buffer[BUFFER_LEN];
+static adc_stream_t stream;
+
+/* Samples passed to the half buffer callback */
+static const uint16_t* filled;
+static size_t filled_count;
+static uint32_t filled_calls;
+
+static void stream_callback(void* arg, const uint16_t* samples, size_t count)
+{
+    UNUSED(arg);
+
+    filled = samples;
+    filled_count = count;
+    filled_calls++;
+}
+
+#ifdef HAL_ADC_USE_REGISTER_CALLBACKS
+static void half_callback(hal_status_t status)
+{
+    TEST_ASSERT(status == HAL_STATUS_OK);
+    adc_stream_half_isr(&stream);
+}
+
+static void filled_callback(hal_status_t status)
+{
+    TEST_ASSERT(status == HAL_STATUS_OK);
+    adc_stream_full_isr(&stream);
+}
+
+static void error_callback(hal_status_t status)
+{
+    TEST_ASSERT(status == HAL_STATUS_ERROR);
+    adc_stream_error_isr(&stream);
+}
+#else
+void adc_dma_buffer_half_isr(adc_t adc)
+{
+    TEST_ASSERT(adc == &hadc1);
+    adc_stream_half_isr(&stream);
+}
+
+void adc_dma_buffer_filled_isr(adc_t adc)
+{
+    TEST_ASSERT(adc == &hadc1);
+    adc_stream_full_isr(&stream);
+}
+
+void adc_error_isr(adc_t adc)
+{
+    TEST_ASSERT(adc == &hadc1);
+    adc_stream_error_isr(&stream);
+}
+#endif
+
+/**
+ * Convert `count` samples numbered from `first`
+*/
+static void convert(uint16_t first, size_t count)
+{
+    uint16_t samples[4 * BUFFER_LEN];
+
+    TEST_ASSERT(count <= sizeof(samples) / sizeof(samples[0]));
+    for (size_t i = 0; i < count; i++)
+        samples[i] = (uint16_t)(first + i);
+    mock_adc_convert(&hadc1, samples, count);
+}
+
+/**
+ * Check that the next readable span holds `count` samples numbered from `first` and release it
+*/
+static void expect_span(uint16_t first, size_t count)
+{
+    const uint16_t* samples;
+
+    TEST_ASSERT(adc_stream_read_span(&stream, &samples) == count);
+    for (size_t i = 0; i < count; i++)
+        TEST_ASSERT(samples[i] == first + i);
+    TEST_ASSERT(adc_stream_release(&stream, count) == STATUS_OK);
+}
+
+static void start(void)
+{
+    TEST_ASSERT(adc_stream_open(&stream, &hadc1, buffer, BUFFER_LEN) == STATUS_OK);
+    TEST_ASSERT(adc_stream_set_callback(&stream, stream_callback, NULL) == STATUS_OK);
+    TEST_ASSERT(adc_stream_start(&stream) == STATUS_OK);
+    filled_calls = 0;
+}
+
+static void stop(void)
+{
+    TEST_ASSERT(adc_stream_stop(&stream) == STATUS_OK);
+}
+
+static void test_circular(void)
+{
+    start();
+
+    convert(0, 3);
+    TEST_ASSERT(adc_dma_get_counter(&hadc1) == 3);
+    TEST_ASSERT(filled_calls == 0);
+
+    /* Half and full transfer events pass each half in turn */
+    convert(3, 1);
+    TEST_ASSERT(filled_calls == 1 && filled == &buffer[0] && filled_count == BUFFER_LEN / 2);
+    convert(4, 4);
+    TEST_ASSERT(filled_calls == 2 && filled == &buffer[BUFFER_LEN / 2] && filled_count == BUFFER_LEN / 2);
+
+    /* DMA counter is reloaded, the write position starts the next lap */
+    TEST_ASSERT(adc_dma_get_counter(&hadc1) == 0);
+    convert(8, 2);
+    TEST_ASSERT(adc_dma_get_counter(&hadc1) == 2);
+    TEST_ASSERT(buffer[0] == 8 && buffer[1] == 9 && buffer[2] == 2);
+
+    stop();
+}
+
+static void test_read_position(void)
+{
+    const uint16_t* samples;
+
+    start();
+
+    /* Samples are readable before their half is complete */
+    convert(0, 3);
+    expect_span(0, 3);
+    TEST_ASSERT(adc_stream_read_span(&stream, &samples) == 0);
+
+    /* Span ends at the end of the buffer, the rest follows from its start */
+    convert(3, 7);
+    expect_span(3, 5);
+    expect_span(8, 2);
+
+    TEST_ASSERT(adc_stream_get_lost(&stream) == 0);
+    stop();
+}
+
+static void test_lapped(void)
+{
+    const uint16_t* samples;
+
+    start();
+
+    /* DMA laps the reader, only the last half is kept */
+    convert(0, BUFFER_LEN + 3);
+    expect_span(BUFFER_LEN + 3 - BUFFER_LEN / 2, 1);
+    expect_span(BUFFER_LEN, 3);
+    TEST_ASSERT(adc_stream_get_lost(&stream) == 3 + BUFFER_LEN / 2);
+
+    /* Samples overwritten while in use are reported on release */
+    convert(BUFFER_LEN + 3, 2);
+    TEST_ASSERT(adc_stream_read_span(&stream, &samples) == 2);
+    convert(BUFFER_LEN + 5, BUFFER_LEN);
+    TEST_ASSERT(adc_stream_release(&stream, 2) == STATUS_ERROR);
+
+    stop();
+}
+
+static void test_overrun(void)
+{
+    start();
+
+    convert(0, 2);
+    mock_adc_overrun(&hadc1);
+    TEST_ASSERT(hadc1.ErrorCode & ADC_ERROR_OVR);
+    TEST_ASSERT(adc_stream_get_errors(&stream) == 1);
+
+    /* Conversion continues in circular mode */
+    convert(2, 2);
+    TEST_ASSERT(filled_calls == 1);
+    expect_span(0, 4);
+
+    stop();
+}
+
+static void test_eos_flag(void)
+{
+    uint8_t channels[2] = { 5, 6 };
+
+    TEST_ASSERT(adc_set_channels(&hadc1, channels, 2) == HAL_STATUS_OK);
+    TEST_ASSERT(hadc1.mock_ranks == 2 && hadc1.mock_channels[0] == 5 && hadc1.mock_channels[1] == 6);
+
+    start();
+    adc_clear_eos_flag(&hadc1);
+    convert(0, 1);
+    TEST_ASSERT(!adc_read_eos_flag(&hadc1));
+    convert(1, 1);
+    TEST_ASSERT(adc_read_eos_flag(&hadc1));
+    adc_clear_eos_flag(&hadc1);
+    TEST_ASSERT(!adc_read_eos_flag(&hadc1));
+    stop();
+}
+
+static void test_unknown_instance(void)
+{
+    ADC_HandleTypeDef unknown = { .Instance = (ADC_TypeDef*)0x1000u, .DMA_Handle = &hdma };
+
+    TEST_ASSERT(adc_start_dma(&unknown, (uint8_t*)buffer, BUFFER_LEN) == HAL_STATUS_ERROR);
+    TEST_ASSERT(adc_dma_get_counter(&unknown) == 0);
+#ifdef HAL_ADC_USE_REGISTER_CALLBACKS
+    TEST_ASSERT(adc_register_callback(&unknown, half_callback, ADC_CB_SRC_DMA_BUFFER_HALF) == HAL_STATUS_ERROR);
+    /* End of sequence is never reported in DMA mode */
+    TEST_ASSERT(adc_register_callback(&hadc1, half_callback, ADC_CB_SRC_EOS) == HAL_STATUS_ERROR);
+#endif
+}
+
+int main(void)
+{
+#ifdef HAL_ADC_USE_REGISTER_CALLBACKS
+    TEST_ASSERT(adc_register_callback(&hadc1, half_callback, ADC_CB_SRC_DMA_BUFFER_HALF) == HAL_STATUS_OK);
+    TEST_ASSERT(adc_register_callback(&hadc1, filled_callback, ADC_CB_SRC_DMA_BUFFER_FILLED) == HAL_STATUS_OK);
+    TEST_ASSERT(adc_register_callback(&hadc1, error_callback, ADC_CB_SRC_ERROR) == HAL_STATUS_OK);
+#endif
+
+    TEST_RUN(test_circular);
+    TEST_RUN(test_read_position);
+    TEST_RUN(test_lapped);
+    TEST_RUN(test_overrun);
+    TEST_RUN(test_eos_flag);
+    TEST_RUN(test_unknown_instance);
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <string.h>
+#include "i2c_bus.h"
+#include "test.h"
+
+/**
+ * I2C driver bus of the STM32L4 target (i2c_bus.c) on the I2C HAL mock,
+ * with the retry policy of the driver
+*/
+
+#define DEVICE_ADDR     (0x50)
+#define ABSENT_ADDR     (0x51)
+
+static I2C_HandleTypeDef hi2c1 = {
+    .Instance = I2C1,
+    .mock_ack_addr = DEVICE_ADDR << 1
+};
+
+static stm32_i2c_bus_t bus;
+static i2c_t i2c;
+
+static void test_transfer(void)
+{
+    uint8_t data[3] = { 1, 2, 3 };
+    uint8_t read[3];
+
+    TEST_ASSERT(i2c_write(&i2c, DEVICE_ADDR, data, sizeof(data)) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_data_len == 3 && hi2c1.mock_timeout == STM32_I2C_BUS_TIMEOUT_MS);
+    TEST_ASSERT(i2c_read(&i2c, DEVICE_ADDR, read, sizeof(read)) == STATUS_OK);
+    TEST_ASSERT(memcmp(read, data, sizeof(data)) == 0);
+
+    TEST_ASSERT(i2c_dev_probe(&i2c, DEVICE_ADDR) == STATUS_OK);
+    TEST_ASSERT(i2c_dev_probe(&i2c, ABSENT_ADDR) == STATUS_ERROR);
+    TEST_ASSERT(i2c_write(&i2c, ABSENT_ADDR, data, sizeof(data)) == STATUS_ERROR);
+}
+
+static void test_policy_timeout(void)
+{
+    static const i2c_retry_policy_t policy = { .tries = 3, .timeout_ms = 7 };
+
+    TEST_ASSERT(i2c_set_retry_policy(&i2c, &policy) == STATUS_OK);
+
+    /* Each attempt gets the timeout of the policy */
+    hi2c1.mock_transactions = 0;
+    TEST_ASSERT(i2c_dev_probe(&i2c, ABSENT_ADDR) == STATUS_ERROR);
+    TEST_ASSERT(hi2c1.mock_transactions == 3 && hi2c1.mock_timeout == 7);
+
+    /* Without a policy the driver default is back */
+    TEST_ASSERT(i2c_set_retry_policy(&i2c, NULL) == STATUS_OK);
+    TEST_ASSERT(i2c_dev_probe(&i2c, DEVICE_ADDR) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_timeout == STM32_I2C_BUS_TIMEOUT_MS);
+}
+
+static void test_device_timeout(void)
+{
+    static const i2c_retry_policy_t bus_policy = { .tries = 1, .timeout_ms = 7 };
+    static const i2c_retry_policy_t device_policy = { .tries = 1, .timeout_ms = 9 };
+    static i2c_sdev_context_t context;
+    uint8_t data = 0;
+    sdev_t device;
+
+    TEST_ASSERT(i2c_sdev_open(&i2c, &device, &context, DEVICE_ADDR) == STATUS_OK);
+    TEST_ASSERT(i2c_sdev_set_retry_policy(&context, &device_policy) == STATUS_OK);
+
+    /* Timeout of the device only applies to the device */
+    TEST_ASSERT(sdev_write(&device, &data, 1) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_timeout == 9);
+    TEST_ASSERT(i2c_write(&i2c, DEVICE_ADDR, &data, 1) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_timeout == STM32_I2C_BUS_TIMEOUT_MS);
+
+    TEST_ASSERT(i2c_set_retry_policy(&i2c, &bus_policy) == STATUS_OK);
+    TEST_ASSERT(sdev_write(&device, &data, 1) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_timeout == 9);
+    TEST_ASSERT(i2c_write(&i2c, DEVICE_ADDR, &data, 1) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_timeout == 7);
+
+    TEST_ASSERT(i2c_set_retry_policy(&i2c, NULL) == STATUS_OK);
+    TEST_ASSERT(i2c_sdev_set_retry_policy(&context, NULL) == STATUS_OK);
+    TEST_ASSERT(i2c_write(&i2c, DEVICE_ADDR, &data, 1) == STATUS_OK);
+}
+
+static void test_backoff_requires_hook(void)
+{
+    static const i2c_retry_policy_t policy = { .tries = 3, .backoff_us = 100, .backoff_max_us = 1000 };
+    static i2c_sdev_context_t context;
+    sdev_t device;
+
+    /* `I2C_RETRY_BACKOFF` is not defined, retries could not wait */
+    TEST_ASSERT(i2c_set_retry_policy(&i2c, &policy) == STATUS_ERROR);
+    TEST_ASSERT(i2c_sdev_open(&i2c, &device, &context, DEVICE_ADDR) == STATUS_OK);
+    TEST_ASSERT(i2c_sdev_set_retry_policy(&context, &policy) == STATUS_ERROR);
+}
+
+static void test_quarantine_reprobe(void)
+{
+    static const i2c_health_policy_t policy = {
+        .error_rate_degraded = I2C_HEALTH_ERROR_RATE(5),
+        .error_rate_quarantine = I2C_HEALTH_ERROR_RATE(10),
+        .reprobe_interval = 4
+    };
+    static i2c_sdev_context_t context;
+    i2c_health_stats_t health;
+    sdev_t device;
+    uint8_t data = 0;
+
+    TEST_ASSERT(i2c_sdev_open(&i2c, &device, &context, DEVICE_ADDR) == STATUS_OK);
+    i2c_sdev_set_health_policy(&context, &policy);
+
+    /* Device stops responding and is quarantined */
+    hi2c1.mock_ack_addr = 0;
+    while (i2c_sdev_get_health(&context, &health), health.state != I2C_HEALTH_QUARANTINED)
+        TEST_ASSERT(sdev_write(&device, &data, 1) == STATUS_ERROR);
+
+    /* Without `I2C_HEALTH_TIMESTAMP` the re-probe interval counts operations */
+    hi2c1.mock_ack_addr = DEVICE_ADDR << 1;
+    hi2c1.mock_transactions = 0;
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT(sdev_write(&device, &data, 1) == STATUS_ERROR);
+    TEST_ASSERT(hi2c1.mock_transactions == 0);
+
+    /* Fourth operation re-probes, the device is released and the write goes through */
+    TEST_ASSERT(sdev_write(&device, &data, 1) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_transactions == 2);
+    i2c_sdev_get_health(&context, &health);
+    TEST_ASSERT(health.state != I2C_HEALTH_QUARANTINED && health.rejected == 3 && health.latency == 0);
+}
+
+static void test_sdev_vectored(void)
+{
+    static i2c_sdev_context_t context;
+    static uint8_t payload[100];
+    uint8_t reg[2] = { 0x01, 0x40 };
+    uint8_t head[2], body[98];
+    i2c_retry_stats_t stats;
+    sdev_t device;
+
+    for (size_t i = 0; i < sizeof(payload); i++)
+        payload[i] = (uint8_t)(i + 3);
+
+    TEST_ASSERT(i2c_sdev_open(&i2c, &device, &context, DEVICE_ADDR) == STATUS_OK);
+
+    /* Longer than the emulation buffer, still a single transaction */
+    sdev_iovec_t write_iov[] = { { reg, sizeof(reg) }, { NULL, 0 }, { payload, sizeof(payload) } };
+    hi2c1.mock_transactions = 0;
+    TEST_ASSERT(sdev_writev(&device, write_iov, 3) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_transactions == 1 && hi2c1.mock_data_len == sizeof(reg) + sizeof(payload));
+    TEST_ASSERT(memcmp(hi2c1.mock_data, reg, sizeof(reg)) == 0);
+    TEST_ASSERT(memcmp(&hi2c1.mock_data[2], payload, sizeof(payload)) == 0);
+
+    sdev_iovec_t read_iov[] = { { head, sizeof(head) }, { body, sizeof(body) } };
+    hi2c1.mock_transactions = 0;
+    TEST_ASSERT(sdev_readv(&device, read_iov, 2) == STATUS_OK);
+    TEST_ASSERT(hi2c1.mock_transactions == 1);
+    TEST_ASSERT(memcmp(head, reg, sizeof(reg)) == 0 && memcmp(body, payload, sizeof(body)) == 0);
+
+    /* Counted by the retry policy of the device like the other transfers */
+    i2c_sdev_get_retry_stats(&context, &stats);
+    TEST_ASSERT(stats.transactions == 2 && stats.failures == 0);
+
+    hi2c1.mock_ack_addr = 0;
+    TEST_ASSERT(sdev_writev(&device, write_iov, 3) == STATUS_ERROR);
+    hi2c1.mock_ack_addr = DEVICE_ADDR << 1;
+}
+
+int main(void)
+{
+    TEST_ASSERT(stm32_i2c_bus_init(&bus, &hi2c1) == STATUS_OK);
+    TEST_ASSERT(i2c_open(&i2c, &stm32_i2c_ops, &bus) == STATUS_OK);
+
+    TEST_RUN(test_transfer);
+    TEST_RUN(test_policy_timeout);
+    TEST_RUN(test_device_timeout);
+    TEST_RUN(test_backoff_requires_hook);
+    TEST_RUN(test_quarantine_reprobe);
+    TEST_RUN(test_sdev_vectored);
+
+    return 0;
+}
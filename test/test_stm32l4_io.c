@@ -0,0 +1,277 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include "hal_io.h"
+#include "hal_uart.h"
+#include "mock_stm32l4.h"
+#include "test.h"
+
+/* Same defaults as hal_io.c, the build sets them for both */
+#ifndef HAL_IO_TX_BUFFER_LEN
+#define HAL_IO_TX_BUFFER_LEN        (256)
+#endif
+
+#ifndef HAL_IO_RX_BUFFER_LEN
+#define HAL_IO_RX_BUFFER_LEN        (512)
+#endif
+
+#ifndef HAL_IO_RX_TIMEOUT_MS
+#define HAL_IO_RX_TIMEOUT_MS        (1000)
+#endif
+
+/**
+ * Buffered IO port of the STM32L4 target (hal_io.c) on the UART HAL mock
+ *
+ * @note Built once with `HAL_IO_USE_DMA` (circular reception) and once without
+ * (re-armed interrupt reception)
+*/
+
+static UART_HandleTypeDef huart2 = {
+    .Instance = USART2,
+    .gState = HAL_UART_STATE_READY,
+    .RxState = HAL_UART_STATE_READY
+};
+
+HAL_SET_RESOURCE(uart_t, IO_UART, &huart2);
+
+/* Test data, long enough for the transmit buffers and the receive ring */
+static uint8_t pattern[3 * HAL_IO_TX_BUFFER_LEN + HAL_IO_RX_BUFFER_LEN];
+
+/**
+ * Complete transmits until the port is idle
+*/
+static void drain(void)
+{
+    while (mock_uart_tx_complete(&huart2)) {}
+}
+
+/**
+ * Check that the next `len` transmitted bytes are `data`
+*/
+static void expect_sent(const uint8_t* data, size_t len)
+{
+    static uint8_t sent[sizeof(pattern)];
+
+    TEST_ASSERT(mock_uart_tx_take(&huart2, sent, len) == len);
+    TEST_ASSERT(memcmp(sent, data, len) == 0);
+}
+
+static void test_tx_double_buffer(void)
+{
+    TEST_ASSERT(io_putdata(pattern, 10) == HAL_STATUS_OK);
+    TEST_ASSERT(huart2.gState == HAL_UART_STATE_BUSY_TX && huart2.TxXferSize == 10);
+
+    /* Appended to the fill buffer while the first chunk is sent, then sent in one transmit */
+    TEST_ASSERT(io_putdata(pattern + 10, 20) == HAL_STATUS_OK);
+    TEST_ASSERT(io_putdata(pattern + 30, 5) == HAL_STATUS_OK);
+    TEST_ASSERT(mock_uart_tx_complete(&huart2));
+    TEST_ASSERT(huart2.gState == HAL_UART_STATE_BUSY_TX && huart2.TxXferSize == 25);
+
+    drain();
+    expect_sent(pattern, 35);
+    TEST_ASSERT(io_flush() == HAL_STATUS_OK);
+}
+
+static volatile int writer_done;
+
+static void* writer(void* arg)
+{
+    UNUSED(arg);
+
+    TEST_ASSERT(io_putdata(pattern, 2 * HAL_IO_TX_BUFFER_LEN + HAL_IO_TX_BUFFER_LEN / 2) == HAL_STATUS_OK);
+    writer_done = 1;
+    return NULL;
+}
+
+static void test_tx_waits_for_space(void)
+{
+    pthread_t thread;
+
+    /* One buffer is sent and the other one filled, the writer waits with the rest */
+    writer_done = 0;
+    pthread_create(&thread, NULL, writer, NULL);
+    usleep(20000);
+    TEST_ASSERT(!writer_done);
+
+    /* A single completion frees the fill buffer, the writer must not wait for the second one */
+    TEST_ASSERT(mock_uart_tx_complete(&huart2));
+    for (int i = 0; i < 100 && !writer_done; i++)
+        usleep(10000);
+    TEST_ASSERT(writer_done);
+    TEST_ASSERT(huart2.gState == HAL_UART_STATE_BUSY_TX);
+
+    pthread_join(thread, NULL);
+    drain();
+    expect_sent(pattern, 2 * HAL_IO_TX_BUFFER_LEN + HAL_IO_TX_BUFFER_LEN / 2);
+}
+
+static void test_tx_drop_in_isr(void)
+{
+    hal_status_t status;
+
+    /* Can not wait for space in interrupt context, the rest is dropped */
+    mock_irq_enter();
+    status = io_putdata(pattern, 3 * HAL_IO_TX_BUFFER_LEN);
+    mock_irq_exit();
+
+    TEST_ASSERT(status == HAL_STATUS_BUSY);
+    drain();
+    expect_sent(pattern, 2 * HAL_IO_TX_BUFFER_LEN);
+    TEST_ASSERT(huart2.mock_tx_len == 0);
+}
+
+static void test_tx_error(void)
+{
+    /* Failed transfer is dropped, the port keeps sending the next buffer */
+    TEST_ASSERT(io_putdata(pattern, 8) == HAL_STATUS_OK);
+    TEST_ASSERT(io_putdata(pattern + 8, 8) == HAL_STATUS_OK);
+    mock_uart_tx_error(&huart2, HAL_UART_ERROR_DMA);
+    TEST_ASSERT(huart2.gState == HAL_UART_STATE_BUSY_TX);
+    drain();
+    expect_sent(pattern + 8, 8);
+}
+
+static void test_tx_start_failure(void)
+{
+    /* UART taken by someone else, the swapped buffer can not be sent and is dropped */
+    huart2.gState = HAL_UART_STATE_BUSY_TX;
+    TEST_ASSERT(io_putdata(pattern, 8) == HAL_STATUS_ERROR);
+    huart2.gState = HAL_UART_STATE_READY;
+
+    /* Next write is sent alone, the dropped data is not sent again */
+    TEST_ASSERT(io_putdata(pattern + 8, 8) == HAL_STATUS_OK);
+    drain();
+    expect_sent(pattern + 8, 8);
+    TEST_ASSERT(huart2.mock_tx_len == 0);
+}
+
+static void test_rx_whole_buffer(void)
+{
+    ring_t* rx = io_rx_ring();
+    static uint8_t received[HAL_IO_RX_BUFFER_LEN];
+
+    /* Reception armed at the start of the buffer and filling all of it is one full span */
+    TEST_ASSERT(io_rx_start() == HAL_STATUS_OK);
+    mock_uart_rx(&huart2, pattern, HAL_IO_RX_BUFFER_LEN);
+    TEST_ASSERT(ring_used(rx) == HAL_IO_RX_BUFFER_LEN);
+    TEST_ASSERT(io_rx_get_overruns() == 0);
+    TEST_ASSERT(ring_read(rx, received, sizeof(received)) == HAL_IO_RX_BUFFER_LEN);
+    TEST_ASSERT(memcmp(received, pattern, HAL_IO_RX_BUFFER_LEN) == 0);
+    TEST_ASSERT(huart2.mock_rx_dropped == 0);
+}
+
+static void test_rx_lines(void)
+{
+    ring_t* rx = io_rx_ring();
+    ring_span_t span[2];
+
+    mock_uart_rx(&huart2, (const uint8_t*)"set 1\nge", 8);
+    mock_uart_rx_idle(&huart2);
+    TEST_ASSERT(ring_get_line(rx, '\n', span) == 6);
+    TEST_ASSERT(span[0].len + span[1].len == 6);
+    ring_consume(rx, 6);
+
+    /* Unfinished line stays in the ring until the rest arrives */
+    TEST_ASSERT(ring_get_line(rx, '\n', span) == 0);
+    mock_uart_rx(&huart2, (const uint8_t*)"t\n", 2);
+    mock_uart_rx_idle(&huart2);
+    TEST_ASSERT(ring_get_line(rx, '\n', span) == 4);
+    ring_consume(rx, 4);
+}
+
+static uint16_t callback_len;
+
+static void receive_callback(uint8_t* data, uint16_t len)
+{
+    UNUSED(data);
+
+    callback_len += len;
+}
+
+static void test_getdata(void)
+{
+    uint8_t data[4];
+
+    mock_uart_rx(&huart2, (const uint8_t*)"abcd", 4);
+    mock_uart_rx_idle(&huart2);
+    TEST_ASSERT(io_getdata(data, 4) == HAL_STATUS_OK);
+    TEST_ASSERT(memcmp(data, "abcd", 4) == 0);
+
+    /* Times out without data */
+    uint32_t start = HAL_GetTick();
+    TEST_ASSERT(io_getdata(data, 1) == HAL_STATUS_ERROR);
+    TEST_ASSERT(HAL_GetTick() - start >= HAL_IO_RX_TIMEOUT_MS);
+
+    /* Data goes to the callback, waiting for it in the ring would never end */
+    TEST_ASSERT(io_register_receive_callback(receive_callback) == HAL_STATUS_OK);
+    mock_uart_rx(&huart2, (const uint8_t*)"xy", 2);
+    mock_uart_rx_idle(&huart2);
+    TEST_ASSERT(callback_len == 2);
+    TEST_ASSERT(io_getdata(data, 1) == HAL_STATUS_ERROR);
+    TEST_ASSERT(io_register_receive_callback(NULL) == HAL_STATUS_OK);
+}
+
+static void test_rx_overrun(void)
+{
+    static uint8_t received[HAL_IO_RX_BUFFER_LEN];
+    uint32_t overruns = io_rx_get_overruns();
+
+    /* Consumer falls behind, the ISR counts the overwritten bytes without moving the tail */
+    mock_uart_rx(&huart2, pattern, HAL_IO_RX_BUFFER_LEN + 100);
+    mock_uart_rx_idle(&huart2);
+    TEST_ASSERT(io_rx_get_overruns() - overruns == 100);
+
+    /* Consumer skips the overwritten bytes, the newest ones are left */
+    ring_t* rx = io_rx_ring();
+    TEST_ASSERT(ring_used(rx) == HAL_IO_RX_BUFFER_LEN);
+    TEST_ASSERT(ring_read(rx, received, sizeof(received)) == HAL_IO_RX_BUFFER_LEN);
+    TEST_ASSERT(memcmp(received, pattern + 100, HAL_IO_RX_BUFFER_LEN) == 0);
+}
+
+static void test_rx_error_restart(void)
+{
+    uint8_t data[8];
+
+    mock_uart_rx(&huart2, (const uint8_t*)"lost", 4);
+    mock_uart_rx_idle(&huart2);
+    uint32_t overruns = io_rx_get_overruns();
+
+    /* Reception is restarted from the error callback */
+    mock_uart_rx_error(&huart2, HAL_UART_ERROR_ORE);
+    TEST_ASSERT(huart2.RxState == HAL_UART_STATE_BUSY_RX);
+    mock_uart_rx(&huart2, (const uint8_t*)"ok", 2);
+    mock_uart_rx_idle(&huart2);
+
+#ifdef HAL_IO_USE_DMA
+    /* Circular reception restarts at the start of the buffer, unread data is skipped */
+    TEST_ASSERT(io_rx_get_overruns() - overruns == 4);
+    TEST_ASSERT(io_getdata(data, 2) == HAL_STATUS_OK);
+    TEST_ASSERT(memcmp(data, "ok", 2) == 0);
+#else
+    /* Interrupt reception continues at the same position */
+    TEST_ASSERT(io_rx_get_overruns() == overruns);
+    TEST_ASSERT(io_getdata(data, 6) == HAL_STATUS_OK);
+    TEST_ASSERT(memcmp(data, "lostok", 6) == 0);
+#endif
+    TEST_ASSERT(ring_used(io_rx_ring()) == 0);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(pattern); i++)
+        pattern[i] = (uint8_t)(i * 7 + 1);
+
+    TEST_RUN(test_tx_double_buffer);
+    TEST_RUN(test_tx_waits_for_space);
+    TEST_RUN(test_tx_drop_in_isr);
+    TEST_RUN(test_tx_error);
+    TEST_RUN(test_tx_start_failure);
+    TEST_RUN(test_rx_whole_buffer);
+    TEST_RUN(test_rx_lines);
+    TEST_RUN(test_getdata);
+    TEST_RUN(test_rx_overrun);
+    TEST_RUN(test_rx_error_restart);
+
+    return 0;
+}
@@ -0,0 +1,280 @@
+#include "drivers/swtimer.h"
+#include "test.h"
+
+/**
+ * Software timer wheel (swtimer.c) on a fake hardware timer of the PC target
+ *
+ * The test calls `swtimer_wheel_isr` itself, in tickless mode after setting the count
+ * the wheel reads, so every tick is deterministic.
+*/
+
+#define RECORD_MAX      (8)
+#define TICK_COUNTS     (10)
+
+typedef struct record {
+    swtimer_t timer;
+    /* Ticks at which the callback ran */
+    uint32_t times[RECORD_MAX];
+    uint32_t n;
+    /* Run from the callback, can stop and start timers */
+    void (*action)(struct record* record);
+    struct record* peer;
+} record_t;
+
+static hal_target_pc_timer_t hw_timer;
+static swtimer_wheel_t wheel;
+static timer_count_t fake_count;
+
+/* Required by the PC target header */
+int socket_write(socket_periph_t periph, uint8_t id, const void* data, size_t len)
+{
+    UNUSED(periph);
+    UNUSED(id);
+    UNUSED(data);
+
+    return (int)len;
+}
+
+/* Fake hardware timer, the period is only stored and the count is set by the test */
+hal_status_t timer_set_period(hal_timer_t timer, timer_count_t period)
+{
+    timer->period = period;
+    return HAL_STATUS_OK;
+}
+
+hal_status_t timer_start(hal_timer_t timer)
+{
+    timer->running = 1;
+    return HAL_STATUS_OK;
+}
+
+hal_status_t timer_clear(hal_timer_t timer)
+{
+    UNUSED(timer);
+
+    fake_count = 0;
+    return HAL_STATUS_OK;
+}
+
+timer_count_t timer_get_count(hal_timer_t timer)
+{
+    UNUSED(timer);
+
+    return fake_count;
+}
+
+static void record_callback(void* arg)
+{
+    record_t* record = (record_t*)arg;
+
+    TEST_ASSERT(record->n < RECORD_MAX);
+    record->times[record->n++] = swtimer_wheel_now(&wheel);
+
+    if (record->action != NULL)
+        record->action(record);
+}
+
+static void record_init(record_t* record)
+{
+    *record = (record_t){ 0 };
+    TEST_ASSERT(swtimer_init(&record->timer, record_callback, record) == STATUS_OK);
+}
+
+/**
+ * Open the wheel with its current tick at `now`
+*/
+static void wheel_open(uint8_t tickless, uint32_t now)
+{
+    TEST_ASSERT(swtimer_wheel_open(&wheel, &hw_timer, TICK_COUNTS, tickless) == STATUS_OK);
+    wheel.now = now;
+}
+
+static void tick(uint32_t ticks)
+{
+    for (uint32_t i = 0; i < ticks; i++)
+        swtimer_wheel_isr(&wheel);
+}
+
+/**
+ * Hardware timer reached the programmed period in tickless mode
+*/
+static void tickless_isr(void)
+{
+    TEST_ASSERT(hw_timer.period == wheel.programmed * TICK_COUNTS);
+    fake_count = 0;
+    swtimer_wheel_isr(&wheel);
+}
+
+static void test_level_boundaries(void)
+{
+    /* Last and first tick of each level */
+    static const uint32_t delays[] = { 1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145 };
+    static record_t records[sizeof(delays) / sizeof(delays[0])];
+    const size_t count = sizeof(delays) / sizeof(delays[0]);
+
+    wheel_open(0, 0);
+    for (size_t i = 0; i < count; i++) {
+        record_init(&records[i]);
+        TEST_ASSERT(swtimer_start(&wheel, &records[i].timer, delays[i], 0) == STATUS_OK);
+    }
+
+    tick(delays[count - 1] + 100);
+
+    /* Each timer expires exactly once and neither early nor late */
+    for (size_t i = 0; i < count; i++)
+        TEST_ASSERT(records[i].n == 1 && records[i].times[0] == delays[i]);
+}
+
+static void test_wrap(void)
+{
+    static const uint32_t delays[] = { 50, 100, 101, 200, 5000, 300000 };
+    static record_t records[sizeof(delays) / sizeof(delays[0])];
+    const size_t count = sizeof(delays) / sizeof(delays[0]);
+    const uint32_t start = UINT32_MAX - 100;
+
+    /* Tick counter wraps after 101 ticks */
+    wheel_open(0, start);
+    for (size_t i = 0; i < count; i++) {
+        record_init(&records[i]);
+        TEST_ASSERT(swtimer_start(&wheel, &records[i].timer, delays[i], 0) == STATUS_OK);
+    }
+
+    tick(delays[count - 1] + 100);
+
+    for (size_t i = 0; i < count; i++)
+        TEST_ASSERT(records[i].n == 1 && records[i].times[0] == start + delays[i]);
+}
+
+static void test_periodic_phase(void)
+{
+    static record_t short_period, long_period;
+
+    /* Period of the second one is longer than a level 0 round */
+    wheel_open(0, 0);
+    record_init(&short_period);
+    record_init(&long_period);
+    TEST_ASSERT(swtimer_start(&wheel, &short_period.timer, 3, 7) == STATUS_OK);
+    TEST_ASSERT(swtimer_start(&wheel, &long_period.timer, 70, 70) == STATUS_OK);
+
+    tick(7 * (RECORD_MAX - 1) + 3);
+    TEST_ASSERT(swtimer_stop(&wheel, &short_period.timer) == STATUS_OK);
+    tick(70 * RECORD_MAX - wheel.now);
+    TEST_ASSERT(swtimer_stop(&wheel, &long_period.timer) == STATUS_OK);
+
+    TEST_ASSERT(short_period.n == RECORD_MAX && long_period.n == RECORD_MAX);
+    for (uint32_t i = 0; i < RECORD_MAX; i++) {
+        TEST_ASSERT(short_period.times[i] == 3 + 7 * i);
+        TEST_ASSERT(long_period.times[i] == 70 * (i + 1));
+    }
+}
+
+/**
+ * Run tickless ISRs until the callback of `record` ran `n` times
+*/
+static void tickless_until(record_t* record, uint32_t n)
+{
+    for (uint32_t isr = 0; record->n < n; isr++) {
+        /* Only expirations and reached higher level slots enter the ISR */
+        TEST_ASSERT(isr < SWTIMER_LEVELS + 1);
+        tickless_isr();
+    }
+}
+
+static void test_tickless(void)
+{
+    static record_t periodic, early;
+
+    wheel_open(1, 0);
+    record_init(&periodic);
+    record_init(&early);
+
+    /* Period is longer than a level 0 round, the ISR also runs when its slot is reached */
+    TEST_ASSERT(swtimer_start(&wheel, &periodic.timer, 100, 100) == STATUS_OK);
+    for (uint32_t i = 1; i <= 3; i++) {
+        tickless_until(&periodic, i);
+        TEST_ASSERT(periodic.times[i - 1] == 100 * i);
+    }
+
+    /* Ticks counted by the hardware since the last ISR are added to the delay */
+    fake_count = 3 * TICK_COUNTS + 5;
+    TEST_ASSERT(swtimer_start(&wheel, &early.timer, 5, 0) == STATUS_OK);
+    TEST_ASSERT(wheel.programmed == 8);
+    tickless_isr();
+    TEST_ASSERT(early.n == 1 && early.times[0] == 308);
+
+    /* Periodic timer keeps its phase after the early ISR */
+    tickless_until(&periodic, 4);
+    TEST_ASSERT(periodic.times[3] == 400);
+}
+
+static void stop_after_three(record_t* record)
+{
+    if (record->n == 3)
+        TEST_ASSERT(swtimer_stop(&wheel, &record->timer) == STATUS_OK);
+}
+
+static void restart_one_shot(record_t* record)
+{
+    if (record->n < 3)
+        TEST_ASSERT(swtimer_start(&wheel, &record->timer, 7, 0) == STATUS_OK);
+}
+
+static void restart_period(record_t* record)
+{
+    if (record->n == 1)
+        TEST_ASSERT(swtimer_start(&wheel, &record->timer, 25, 25) == STATUS_OK);
+}
+
+static void stop_peer(record_t* record)
+{
+    TEST_ASSERT(swtimer_stop(&wheel, &record->peer->timer) == STATUS_OK);
+}
+
+static void test_callback_stop_restart(void)
+{
+    static record_t stopped, one_shot, restarted, first, second;
+
+    wheel_open(0, 0);
+    record_init(&stopped);
+    record_init(&one_shot);
+    record_init(&restarted);
+    record_init(&first);
+    record_init(&second);
+
+    stopped.action = stop_after_three;
+    one_shot.action = restart_one_shot;
+    restarted.action = restart_period;
+    /* Expire in the same tick, the one running first stops the other */
+    first.action = stop_peer;
+    first.peer = &second;
+    second.action = stop_peer;
+    second.peer = &first;
+
+    TEST_ASSERT(swtimer_start(&wheel, &stopped.timer, 10, 10) == STATUS_OK);
+    TEST_ASSERT(swtimer_start(&wheel, &one_shot.timer, 5, 0) == STATUS_OK);
+    TEST_ASSERT(swtimer_start(&wheel, &restarted.timer, 10, 10) == STATUS_OK);
+    TEST_ASSERT(swtimer_start(&wheel, &first.timer, 50, 0) == STATUS_OK);
+    TEST_ASSERT(swtimer_start(&wheel, &second.timer, 50, 0) == STATUS_OK);
+
+    tick(70);
+    TEST_ASSERT(swtimer_stop(&wheel, &restarted.timer) == STATUS_OK);
+    tick(100);
+
+    TEST_ASSERT(stopped.n == 3 && stopped.times[0] == 10 && stopped.times[2] == 30);
+    TEST_ASSERT(one_shot.n == 3 && one_shot.times[1] == 12 && one_shot.times[2] == 19);
+    TEST_ASSERT(restarted.n == 3 && restarted.times[0] == 10 && restarted.times[1] == 35
+        && restarted.times[2] == 60);
+    TEST_ASSERT(first.n + second.n == 1);
+    TEST_ASSERT(!stopped.timer.active && !one_shot.timer.active && !first.timer.active && !second.timer.active);
+}
+
+int main(void)
+{
+    TEST_RUN(test_level_boundaries);
+    TEST_RUN(test_wrap);
+    TEST_RUN(test_periodic_phase);
+    TEST_RUN(test_tickless);
+    TEST_RUN(test_callback_stop_restart);
+
+    return 0;
+}
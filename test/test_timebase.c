@@ -0,0 +1,202 @@
+#include "drivers/timebase.h"
+#include "test.h"
+
+/**
+ * Timebase (timebase.c) on a fake hardware timer of the PC target
+ *
+ * Built with `test/timebase_hooks.h`, the test sets the count and the pending period
+ * flag the timebase reads and calls `timebase_isr` itself.
+*/
+
+#define PERIOD      (1000)
+#define COUNTS_MAX  (4)
+
+static hal_target_pc_timer_t hw_timer;
+static timebase_t timebase;
+
+/* Counts returned by the next reads, the last one repeats */
+static timer_count_t counts[COUNTS_MAX];
+static uint32_t n_counts;
+static uint32_t reads;
+static uint8_t pending;
+/* Called by the fake timer on the first count read, as if the ISR ran during the read */
+static void (*on_read)(void);
+
+/* Required by the PC target header */
+int socket_write(socket_periph_t periph, uint8_t id, const void* data, size_t len)
+{
+    UNUSED(periph);
+    UNUSED(id);
+    UNUSED(data);
+
+    return (int)len;
+}
+
+hal_status_t timer_set_period(hal_timer_t timer, timer_count_t period)
+{
+    timer->period = period;
+    return HAL_STATUS_OK;
+}
+
+hal_status_t timer_start(hal_timer_t timer)
+{
+    timer->running = 1;
+    return HAL_STATUS_OK;
+}
+
+hal_status_t timer_clear(hal_timer_t timer)
+{
+    UNUSED(timer);
+    return HAL_STATUS_OK;
+}
+
+timer_count_t timer_get_count(hal_timer_t timer)
+{
+    UNUSED(timer);
+
+    if (reads == 0 && on_read != NULL)
+        on_read();
+
+    timer_count_t count = counts[reads < n_counts ? reads : n_counts - 1];
+    reads++;
+    return count;
+}
+
+uint8_t timebase_test_pending(void)
+{
+    return pending;
+}
+
+/**
+ * Next reads of the count return `first`, then `second`
+*/
+static void set_counts(timer_count_t first, timer_count_t second)
+{
+    counts[0] = first;
+    counts[1] = second;
+    n_counts = 2;
+    reads = 0;
+}
+
+static void set_count(timer_count_t count)
+{
+    set_counts(count, count);
+}
+
+static void period_isr(void)
+{
+    pending = 0;
+    timebase_isr(&timebase);
+}
+
+static void reset(uint32_t frequency, timer_count_t period)
+{
+    pending = 0;
+    on_read = NULL;
+    set_count(0);
+    TEST_ASSERT(timebase_open(&timebase, &hw_timer, frequency, period) == STATUS_OK);
+    TEST_ASSERT(hw_timer.period == period && hw_timer.running);
+}
+
+static void test_wrap(void)
+{
+    reset(1000000, PERIOD);
+
+    set_count(500);
+    TEST_ASSERT(timebase_now(&timebase) == 500);
+
+    /* Each period ISR extends the count by one period */
+    for (uint64_t i = 1; i <= 5; i++) {
+        period_isr();
+        set_count(7);
+        TEST_ASSERT(timebase_now(&timebase) == i * PERIOD + 7);
+    }
+
+    /* Full counter range extends past 32 bits */
+    reset(1000000, 0);
+    for (uint32_t i = 0; i < 3; i++)
+        period_isr();
+    set_count(9);
+    TEST_ASSERT(timebase_now(&timebase) == 3 * (1ull << 32) + 9);
+}
+
+static void test_pending(void)
+{
+    reset(1000000, PERIOD);
+
+    /* Count wrapped, the ISR did not run yet */
+    pending = 1;
+    set_count(3);
+    TEST_ASSERT(timebase_now(&timebase) == PERIOD + 3);
+
+    /* Count read before the wrap, the flag after it: the count is read again */
+    set_counts(PERIOD - 1, 2);
+    TEST_ASSERT(timebase_now(&timebase) == PERIOD + 2);
+    TEST_ASSERT(reads == 2);
+
+    /* Same time once the ISR ran */
+    period_isr();
+    set_count(4);
+    TEST_ASSERT(timebase_now(&timebase) == PERIOD + 4);
+}
+
+static void test_isr_during_read(void)
+{
+    reset(1000000, PERIOD);
+    period_isr();
+
+    /* Base read before the ISR, count after it: the read is retried with the new base */
+    on_read = period_isr;
+    set_count(5);
+    TEST_ASSERT(timebase_now(&timebase) == 2 * PERIOD + 5);
+    TEST_ASSERT(reads == 2);
+}
+
+/**
+ * `actual` differs from `expected` by at most `tolerance`
+*/
+static int near(uint64_t actual, uint64_t expected, uint64_t tolerance)
+{
+    return actual >= expected ? actual - expected <= tolerance : expected - actual <= tolerance;
+}
+
+static void test_conversions(void)
+{
+    /* Whole number of ns per tick */
+    reset(1000000, 0);
+    TEST_ASSERT(near(timebase_ticks_to_us(&timebase, 123456789), 123456789, 1));
+    TEST_ASSERT(near(timebase_ticks_to_ns(&timebase, 123456789), 123456789000ull, 1));
+    TEST_ASSERT(near(timebase_us_to_ticks(&timebase, 123456789), 123456789, 1));
+
+    /* 80 MHz, 12.5 ns per tick */
+    reset(80000000, 0);
+    TEST_ASSERT(near(timebase_ticks_to_ns(&timebase, 80), 1000, 1));
+    TEST_ASSERT(near(timebase_ticks_to_us(&timebase, 80000000), 1000000, 1));
+    TEST_ASSERT(near(timebase_us_to_ticks(&timebase, 1000), 80000, 1));
+
+    /* 32768 Hz, a day of ticks stays within a microsecond */
+    reset(32768, 0);
+    TEST_ASSERT(near(timebase_ticks_to_us(&timebase, 32768ull * 86400), 86400000000ull, 1));
+    TEST_ASSERT(near(timebase_ticks_to_ns(&timebase, 32768), 1000000000ull, 1));
+    TEST_ASSERT(near(timebase_us_to_ticks(&timebase, 1000000), 32768, 1));
+
+    /* Now in time units follows the ticks */
+    reset(1000000, PERIOD);
+    period_isr();
+    set_count(250);
+    TEST_ASSERT(timebase_now_us(&timebase) == PERIOD + 250);
+    set_count(250);
+    TEST_ASSERT(near(timebase_now_ns(&timebase), (PERIOD + 250) * 1000ull, 1));
+
+    TEST_ASSERT(timebase_open(&timebase, &hw_timer, 0, PERIOD) == STATUS_ERROR);
+}
+
+int main(void)
+{
+    TEST_RUN(test_wrap);
+    TEST_RUN(test_pending);
+    TEST_RUN(test_isr_during_read);
+    TEST_RUN(test_conversions);
+
+    return 0;
+}
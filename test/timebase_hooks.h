@@ -0,0 +1,15 @@
+#ifndef TEST_TIMEBASE_HOOKS_H
+#define TEST_TIMEBASE_HOOKS_H
+
+#include <stdint.h>
+
+/**
+ * Pending period flag for the timebase test (see drivers/timebase.h), included into every
+ * source file of the test: the flag of the fake timer is set by the test
+*/
+
+uint8_t timebase_test_pending(void);
+
+#define TIMEBASE_PERIOD_PENDING(timer)  timebase_test_pending()
+
+#endif
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Decoder for the deferred binary log (common/log.h)
+
+Reads the `log_fmt` section from the firmware ELF file and rebuilds the text of the
+records read from a file, a serial device or stdin.
+
+usage: log_decode.py firmware.elf [input]
+"""
+
+import re
+import struct
+import sys
+
+LOG_ID_DROPPED = 0
+SHT_NOBITS = 8
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcp%])")
+
+
+def read_section(path, name):
+    """Return the contents of section `name` from an ELF file"""
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("not an ELF file")
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3a)
+        entry = endian + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2e)
+        entry = endian + "IIIIIIIIII"
+
+    sections = [struct.unpack_from(entry, elf, shoff + i * shentsize) for i in range(shnum)]
+    strtab = sections[shstrndx]
+    for sh in sections:
+        sh_name = elf[strtab[4] + sh[0]:elf.index(b"\0", strtab[4] + sh[0])].decode()
+        if sh_name == name:
+            if sh[1] == SHT_NOBITS:
+                raise ValueError("section %s has no contents in the ELF file (NOLOAD)" % name)
+            return elf[sh[4]:sh[4] + sh[5]]
+
+    raise ValueError("section %s not found" % name)
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            raise ValueError("invalid frame")
+        out += frame[i + 1:i + code]
+        i += code
+        if code != 0xff and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def varints(data):
+    value = shift = 0
+    for byte in data:
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if not byte & 0x80:
+            yield value
+            value = shift = 0
+    if shift:
+        raise ValueError("truncated varint")
+
+
+def format_record(fmt, args):
+    """Apply printf style `fmt` to 32-bit integer arguments"""
+    args = iter(args)
+
+    def convert(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if width == "*":
+            width = str(next(args))
+        value = next(args)
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+        elif conv == "c":
+            value = chr(value & 0xff)
+        elif conv == "p":
+            conv, flags = "x", (flags or "") + "#"
+        spec = "%" + (flags or "") + (width or "") + ("." + precision if precision else "")
+        return (spec + {"u": "d", "i": "d"}.get(conv, conv)) % value
+
+    try:
+        return CONVERSION.sub(convert, fmt)
+    except StopIteration:
+        return fmt + " <missing arguments>"
+
+
+def decode(formats, stream, out):
+    buffer = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        if chunk != b"\0":
+            buffer += chunk
+            continue
+
+        frame, buffer = bytes(buffer), bytearray()
+        if not frame:
+            continue
+        try:
+            fields = list(varints(cobs_decode(frame)))
+            id, timestamp, args = fields[0], fields[1], fields[2:]
+        except (ValueError, IndexError):
+            out.write("<corrupted record>\n")
+            continue
+
+        if id == LOG_ID_DROPPED:
+            text = "<%u records dropped>\n" % args[0]
+        elif id - 1 < len(formats):
+            offset = id - 1
+            text = format_record(formats[offset:formats.index(b"\0", offset)].decode(errors="replace"), args)
+        else:
+            text = "<unknown format %u>\n" % id
+
+        out.write("[%10u] %s" % (timestamp, text))
+        out.flush()
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+
+    formats = read_section(sys.argv[1], "log_fmt")
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "rb", buffering=0) as stream:
+            decode(formats, stream, sys.stdout)
+    else:
+        decode(formats, sys.stdin.buffer, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())